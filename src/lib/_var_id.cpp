@@ -1,10 +1,24 @@
 #include "../metaSMT/impl/_var_id.hpp"
 
 #include <atomic>
-#define var_id_type std::atomic_uint
+
+namespace {
+  /**
+   * ids are handed out to each thread in blocks, so concurrent contexts only
+   * touch the shared counter once per block instead of once per variable.
+   **/
+  unsigned const var_id_block_size = 1024u;
+  std::atomic_uint next_var_id_block(0u);
+}  // namespace
 
 unsigned metaSMT::impl::new_var_id() {
-  static var_id_type _id(0u);
-  ++_id;
-  return _id;
+  thread_local unsigned next = 0u;
+  thread_local unsigned end = 0u;
+  if (next == end) {
+    next = next_var_id_block.fetch_add(var_id_block_size, std::memory_order_relaxed);
+    end = next + var_id_block_size;
+    // 0 is reserved as invalid id
+    if (next == 0u) ++next;
+  }
+  return next++;
 }
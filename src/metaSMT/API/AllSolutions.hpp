@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief native enumeration of all solutions
+   *
+   * Takes the projection variables, a std::function<void()> and the
+   * maximal number of solutions. Calls the function once per assignment
+   * of the projection variables that extends to a solution, read_value()
+   * returns that assignment, and returns the number of calls. The
+   * pending assumptions hold for every solution and are consumed.
+   * Backends with this command are used by for_each_solution(), see
+   * support/all_solutions.hpp.
+   *
+   * For bit-blasting contexts the projection variables are the bits of
+   * the bit-vectors and the predicates.
+   *
+   * \ingroup API
+   * \defgroup AllSolutions AllSolutions
+   * @{
+   */
+  struct for_each_solution_cmd {
+    typedef std::uint64_t result_type;
+  };
+  /**@}*/
+}  // namespace metaSMT
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "../Features.hpp"
 
 namespace metaSMT {
@@ -7,6 +9,17 @@ namespace metaSMT {
     typedef void result_type;
   };
 
+  /**
+   * \brief removes and returns the pending assumptions
+   *
+   * Expr is the result_type of the context. Used by for_each_solution()
+   * to assume them for every solution.
+   */
+  template <typename Expr>
+  struct pending_assumptions_cmd {
+    typedef std::vector<Expr> result_type;
+  };
+
   /**
    * \brief Assumption API, one-time Assertions
    *
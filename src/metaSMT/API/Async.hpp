@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+
+#include "../Features.hpp"
+#include "../tribool.hpp"
+#include "Budget.hpp"
+#include "Interrupt.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief handle to a solve_limited() call running in the background
+   *
+   * Returned by async_solve(). The context must not be used while the
+   * call is running. Destroying the handle waits for the call to finish,
+   * use cancel() to abort it first.
+   */
+  template <typename Context_>
+  class solve_future {
+   public:
+    solve_future(Context_ &ctx, std::future<tribool> &&result) : ctx_(&ctx), result_(std::move(result)) {}
+
+    /// wait for the result, rethrows exceptions of the solver
+    tribool get() { return result_.get(); }
+
+    bool valid() const { return result_.valid(); }
+
+    void wait() const { result_.wait(); }
+
+    template <typename Rep, typename Period>
+    std::future_status wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+      return result_.wait_for(timeout);
+    }
+
+    /**
+     * \brief abort the running call and wait until the solver returned
+     *
+     * The result of a cancelled call is indeterminate unless the solver
+     * finished before. Contexts without the Interrupt API run to
+     * completion.
+     */
+    void cancel() {
+      if (!result_.valid()) return;
+      if constexpr (features::supports<Context_, interrupt_cmd>::value) {
+        // repeat, an interrupt before the search started is lost
+        do {
+          interrupt(*ctx_);
+        } while (result_.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready);
+      } else {
+        result_.wait();
+      }
+    }
+
+   private:
+    Context_ *ctx_;
+    std::future<tribool> result_;
+  };
+
+  /**
+   * \brief Async API, solve in a background thread
+   *
+   *
+   * \code
+   *  DirectSolver_Context< solver::Z3_Backend > ctx;
+   *
+   *  budget b;
+   *  b.timeout = std::chrono::seconds(2);
+   *  solve_future< DirectSolver_Context< solver::Z3_Backend > > f = async_solve(ctx, b);
+   *  if (f.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+   *    f.cancel();
+   *  }
+   *  tribool r = f.get();
+   * \endcode
+   *
+   * \ingroup API
+   * \defgroup Async Async
+   * @{
+   */
+
+  /**
+   * \brief start solve_limited(ctx, b) in a background thread
+   *
+   * \param ctx The metaSMT Context, must outlive the returned handle
+   * \param b The limits for this call
+   * \returns the handle to wait for or cancel the call
+   */
+  template <typename Context_>
+  solve_future<Context_> async_solve(Context_ &ctx, budget const &b = budget()) {
+    return solve_future<Context_>(ctx, std::async(std::launch::async, [&ctx, b] { return solve_limited(ctx, b); }));
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "../Features.hpp"
+#include "../tribool.hpp"
+#include "Interrupt.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief resource limits for a single solve_limited() call
+   *
+   * A value of zero means unlimited. Backends map the limits onto their
+   * native mechanisms and ignore limits they cannot express.
+   */
+  struct budget {
+    budget() : timeout(0), conflicts(0), propagations(0) {}
+
+    /// wall-clock limit
+    std::chrono::milliseconds timeout;
+    /// conflict limit of the search
+    uint64_t conflicts;
+    /// propagation limit of the search
+    uint64_t propagations;
+  };
+
+  struct solve_limited_cmd {
+    typedef tribool result_type;
+  };
+
+  namespace detail {
+    /**
+     * \brief wall-clock deadline polled from solver termination callbacks
+     */
+    class deadline {
+     public:
+      deadline() : active_(false) {}
+
+      void start(std::chrono::milliseconds timeout) {
+        active_ = timeout.count() > 0;
+        at_ = std::chrono::steady_clock::now() + timeout;
+      }
+
+      void clear() { active_ = false; }
+
+      bool expired() const { return active_ && std::chrono::steady_clock::now() >= at_; }
+
+     private:
+      bool active_;
+      std::chrono::steady_clock::time_point at_;
+    };
+
+    /**
+     * \brief calls a function once the timeout elapsed, unless destroyed before
+     *
+     * Used for solvers without a termination callback, the function is
+     * expected to interrupt the running search. It is repeated every few
+     * milliseconds until the watchdog is destroyed, so an interrupt that
+     * arrives before the search started is not lost.
+     */
+    class watchdog {
+     public:
+      watchdog(std::chrono::milliseconds timeout, std::function<void()> on_timeout) : done_(false) {
+        if (timeout.count() > 0) {
+          thread_ = std::thread([this, timeout, on_timeout] {
+            std::unique_lock<std::mutex> lock(mutex_);
+            std::chrono::milliseconds wait = timeout;
+            while (!cv_.wait_for(lock, wait, [this] { return done_; })) {
+              on_timeout();
+              wait = std::chrono::milliseconds(10);
+            }
+          });
+        }
+      }
+
+      ~watchdog() {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          done_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+          thread_.join();
+        }
+      }
+
+     private:
+      std::mutex mutex_;
+      std::condition_variable cv_;
+      bool done_;
+      std::thread thread_;
+
+      watchdog(watchdog const &);
+      watchdog &operator=(watchdog const &);
+    };
+  }  // namespace detail
+
+  /**
+   * \brief Budget API, solve with resource limits
+   *
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< SAT_Clause< solver::MiniSAT > > > ctx;
+   *
+   *  budget b;
+   *  b.timeout = std::chrono::milliseconds(500);
+   *  b.conflicts = 100000;
+   *  tribool r = solve_limited(ctx, b);
+   *  if (indeterminate(r)) {
+   *    // budget exhausted or interrupted
+   *  }
+   * \endcode
+   *
+   * The result is true for satisfiable, false for unsatisfiable and
+   * indeterminate when the budget was exhausted, the search was
+   * interrupted or the solver gave up. Assumptions are consumed as with
+   * solve().
+   *
+   * Contexts without native support fall back to solve(). If they
+   * support the Interrupt API, the timeout is enforced with a watchdog
+   * thread, the other limits are ignored. solve() cannot report an
+   * interrupt, so only the timeout of the fallback is indeterminate. All
+   * backends with the Interrupt API support solve_limited natively and
+   * also report an interrupt from another thread as indeterminate.
+   *
+   * \ingroup API
+   * \defgroup Budget Budget
+   * @{
+   */
+
+  /**
+   * \brief solve with resource limits
+   *
+   * \param ctx The metaSMT Context
+   * \param b The limits for this call
+   * \returns true (sat), false (unsat) or indeterminate (unknown)
+   */
+  template <typename Context_>
+  tribool solve_limited(Context_ &ctx, budget const &b) {
+    if constexpr (features::supports<Context_, solve_limited_cmd>::value) {
+      return ctx.command(solve_limited_cmd(), b);
+    } else if constexpr (features::supports<Context_, interrupt_cmd>::value) {
+      std::atomic<bool> timed_out(false);
+      bool r;
+      {
+        detail::watchdog w(b.timeout, [&ctx, &timed_out] {
+          timed_out = true;
+          interrupt(ctx);
+        });
+        r = ctx.solve();
+      }
+      if (timed_out) return indeterminate;
+      return r;
+    } else {
+      return ctx.solve();
+    }
+  }
+  /**@}*/
+}  // namespace metaSMT
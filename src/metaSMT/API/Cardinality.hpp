@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  namespace features {
+    struct cardinality_api;
+  }  // namespace features
+
+  /**
+   * \brief native cardinality and pseudo-Boolean constraints
+   *
+   * Contexts that support features::cardinality_api build these
+   * constraints with their own propagators instead of a Boolean encoding:
+   *
+   * \code
+   *  // ps[0] + ... + ps[n-1] <= k
+   *  ctx.command(cardinality_cmd(), cardtags::le_tag(), ps, k);
+   *  // ws[0] * ps[0] + ... + ws[n-1] * ps[n-1] >= k
+   *  ctx.command(pseudo_boolean_cmd(), cardtags::ge_tag(), ps, ws, k);
+   * \endcode
+   *
+   * ps is a std::vector of result_type, the tags are the ones of
+   * tags/Cardinality.hpp, the weights and the bound of pseudo_boolean_cmd
+   * are int64_t, but must fit into int. Both return the result_type of the
+   * context.
+   *
+   * The cardinality and pseudo-Boolean evaluators use the commands by
+   * default when available, i.e. with the encoding "native".
+   *
+   * \ingroup API
+   * \defgroup Cardinality Cardinality
+   * @{
+   */
+  struct cardinality_cmd {};
+
+  struct pseudo_boolean_cmd {};
+  /**@}*/
+}  // namespace metaSMT
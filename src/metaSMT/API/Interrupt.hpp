@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  struct interrupt_cmd {
+    typedef void result_type;
+  };
+
+  /**
+   * \brief Interrupt API, abort a running solve() from another thread
+   *
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< SAT_Clause< solver::MiniSAT > > > ctx;
+   *
+   *  std::thread t([&ctx] { solve(ctx); });
+   *  interrupt(ctx);
+   *  t.join();
+   * \endcode
+   *
+   * An interrupted solve() returns without a definitive answer, its result
+   * must be ignored. Each solve() call starts uninterrupted, an interrupt
+   * that arrives before the solver starts searching is lost.
+   *
+   * Check features::supports<Context, interrupt_cmd> before use, contexts
+   * without native support do not provide the command.
+   *
+   * \ingroup API
+   * \defgroup Interrupt Interrupt
+   * @{
+   */
+
+  /**
+   * \brief interrupt the solve() call currently running in ctx
+   *
+   * \param ctx The metaSMT Context
+   */
+  template <typename Context_>
+  void interrupt(Context_& ctx) {
+    ctx.command(interrupt_cmd());
+  }
+  /**@}*/
+}  // namespace metaSMT
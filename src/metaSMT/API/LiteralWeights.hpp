@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  struct literal_weight_cmd {
+    typedef void result_type;
+  };
+
+  /**
+   * \brief Literal weights API, weighted model counting and biased sampling
+   *
+   * Every variable has a weight for true and one for false, both 1 by
+   * default. The weight of a solution is the product of the weights of its
+   * literals. Contexts supporting literal_weight_cmd sample each solution
+   * with a probability proportional to its weight and count_solutions()
+   * returns the sum of the weights.
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< CUDD_Distributed > > ctx;
+   *  bitvector x = new_bitvector(8);
+   *
+   *  // unconstrained bits of x are 1 with probability 0.9
+   *  set_bias(ctx, x, 0.9);
+   *  // the lowest bit weighs 3 : 1
+   *  set_literal_weight(ctx, extract(0, 0, x), 3, 1);
+   * \endcode
+   *
+   * The expressions must be variables or bits of bit-vector variables,
+   * for a bit-vector the weights apply to every bit.
+   *
+   * \ingroup API
+   * \defgroup LiteralWeights LiteralWeights
+   * @{
+   */
+
+  /**
+   * \brief set the weights of the literals of var
+   *
+   * \param ctx The metaSMT Context, must support literal_weight_cmd
+   * \param var The variable
+   * \param w_true The weight of var, must not be negative
+   * \param w_false The weight of not var, must not be negative
+   */
+  template <typename Context_, typename Expr>
+  void set_literal_weight(Context_ &ctx, Expr const &var, double w_true, double w_false) {
+    ctx.command(literal_weight_cmd(), ctx(var), w_true, w_false);
+  }
+
+  /**
+   * \brief var is true with probability p where it is not constrained
+   */
+  template <typename Context_, typename Expr>
+  void set_bias(Context_ &ctx, Expr const &var, double p) {
+    set_literal_weight(ctx, var, p, 1 - p);
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief number of solutions of the current assertions and assumptions
+   *
+   * All variables known to the solver count, including those the
+   * assertions do not mention.
+   */
+  struct solution_count {
+    /// log2 of the number of solutions, -infinity if there is none
+    double log2;
+    /// the exact number in decimal, empty unless counted exactly
+    std::string exact;
+  };
+
+  struct count_solutions_cmd {
+    typedef solution_count result_type;
+  };
+
+  /**
+   * \brief Model counting API
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< CUDD_Distributed > > ctx;
+   *  set_option(ctx, "counting", "exact");
+   *
+   *  assertion(ctx, ...);
+   *  solution_count c = count_solutions(ctx);
+   *  std::cout << c.exact << " solutions" << std::endl;
+   * \endcode
+   *
+   * The option "counting" selects the arithmetic: "log_space" (default)
+   * counts with doubles in log-space and never overflows, "exact" counts
+   * with arbitrary precision. Assumptions are consumed as with solve().
+   *
+   * \ingroup API
+   * \defgroup ModelCount ModelCount
+   * @{
+   */
+
+  /**
+   * \brief count the solutions
+   *
+   * \param ctx The metaSMT Context, must support count_solutions_cmd
+   * \returns the number of solutions
+   */
+  template <typename Context_>
+  solution_count count_solutions(Context_ &ctx) {
+    return ctx.command(count_solutions_cmd());
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief native optimization commands
+   *
+   * Backends with a built-in optimizer support these commands, see
+   * support/optimize.hpp for minimize(), maximize() and maxsat(), which
+   * forward to them when available.
+   *
+   * minimize_cmd / maximize_cmd take an unsigned bit-vector objective and
+   * solve() the current assertions and assumptions such that the model
+   * read with read_value() is optimal.
+   *
+   * maxsat_cmd takes soft Boolean constraints and their weights and
+   * solve()s such that the sum of the weights of the violated soft
+   * constraints is minimal.
+   *
+   * All return whether the assertions are satisfiable.
+   *
+   * \ingroup API
+   * \defgroup Optimize Optimize
+   * @{
+   */
+  struct minimize_cmd {
+    typedef bool result_type;
+  };
+
+  struct maximize_cmd {
+    typedef bool result_type;
+  };
+
+  struct maxsat_cmd {
+    typedef bool result_type;
+  };
+  /**@}*/
+}  // namespace metaSMT
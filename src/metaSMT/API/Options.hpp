@@ -5,6 +5,13 @@
 #include "../Features.hpp"
 
 namespace metaSMT {
+  namespace option {
+    struct Typed;
+
+    template <typename T, T Typed::*Member>
+    struct key;
+  }  // namespace option
+
   struct setup_option_map_cmd {
     typedef void result_type;
   };
@@ -25,6 +32,12 @@ namespace metaSMT {
     return ctx.command(get_option_cmd(), key, default_value);
   }
 
+  /// typed options, see support/Options.hpp
+  template <typename Context_, typename T, T option::Typed::*Member>
+  T get_option(Context_ &ctx, option::key<T, Member> const &key) {
+    return ctx.command(get_option_cmd(), key);
+  }
+
   template <typename Context_>
   void set_option(Context_ &ctx, std::string const &key, std::string const &value) {
     ctx.command(set_option_cmd(), key, value);
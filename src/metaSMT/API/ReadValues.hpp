@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "../Features.hpp"
+#include "../result_wrapper.hpp"
+
+namespace metaSMT {
+  struct read_values_cmd {
+    typedef std::vector<result_wrapper> result_type;
+  };
+
+  /**
+   * \brief ReadValues API, bulk retrieval of the model
+   *
+   * \code
+   *  DirectSolver_Context< solver::Z3_Backend > ctx;
+   *  ...
+   *  if (solve(ctx)) {
+   *    std::vector<result_wrapper> values = read_values(ctx, vars);
+   *  }
+   * \endcode
+   *
+   * Backends supporting read_values_cmd fetch the model once for all
+   * variables, otherwise read_value() is called per variable.
+   *
+   * \ingroup API
+   * \defgroup ReadValues ReadValues
+   * @{
+   */
+
+  /**
+   * \brief the values of vars in the model of the last solve()
+   *
+   * \param ctx The metaSMT Context
+   * \param vars The expressions to read, as for read_value()
+   * \returns one result_wrapper per element of vars
+   */
+  template <typename Context_>
+  std::vector<result_wrapper> read_values(Context_ &ctx, std::vector<typename Context_::result_type> const &vars) {
+    if constexpr (features::supports<Context_, read_values_cmd>::value) {
+      return ctx.command(read_values_cmd(), vars);
+    } else {
+      std::vector<result_wrapper> values;
+      values.reserve(vars.size());
+      for (typename Context_::result_type const &v : vars) {
+        values.push_back(read_value(ctx, v));
+      }
+      return values;
+    }
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief packed bit-matrix of samples
+   *
+   * Row r is the r-th sample, column i the value of the solver variable
+   * with index i in it. Each row occupies words() 64-bit words, bits past
+   * columns() are zero.
+   */
+  class sample_matrix {
+   public:
+    sample_matrix() : rows_(0), columns_(0), words_(0) {}
+
+    void resize(unsigned rows, unsigned columns) {
+      rows_ = rows;
+      columns_ = columns;
+      words_ = (columns + 63) / 64;
+      data_.assign(std::size_t(rows_) * words_, 0);
+    }
+
+    unsigned rows() const { return rows_; }
+
+    unsigned columns() const { return columns_; }
+
+    unsigned words() const { return words_; }
+
+    bool get(unsigned row, unsigned column) const { return (this->row(row)[column / 64] >> (column % 64)) & 1; }
+
+    std::uint64_t *row(unsigned r) { return data_.data() + std::size_t(r) * words_; }
+
+    std::uint64_t const *row(unsigned r) const { return data_.data() + std::size_t(r) * words_; }
+
+   private:
+    unsigned rows_;
+    unsigned columns_;
+    unsigned words_;
+    std::vector<std::uint64_t> data_;
+  };
+
+  struct sample_cmd {
+    typedef bool result_type;
+  };
+
+  /**
+   * \brief Sample API, draw many uniformly distributed solutions at once
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< CUDD_Distributed > > ctx;
+   *  assertion(ctx, ...);
+   *
+   *  // into a bit-matrix, with 4 threads
+   *  sample_matrix m;
+   *  sample(ctx, 1000000, m, 4);
+   *
+   *  // or one after the other as the current solution
+   *  sample(ctx, 1000, [&] { unsigned v = read_value(ctx, x); });
+   * \endcode
+   *
+   * The weights are computed once for all samples. With several threads
+   * each thread draws its rows from an own random number stream seeded by
+   * the context. Assumptions are consumed as with solve().
+   *
+   * \ingroup API
+   * \defgroup Sample Sample
+   * @{
+   */
+
+  /**
+   * \brief draw n samples into a bit-matrix
+   *
+   * \param ctx The metaSMT Context, must support sample_cmd
+   * \param n The number of samples
+   * \param out Resized to n rows and one column per solver variable
+   * \param threads The number of threads drawing the samples
+   * \returns false if there is no solution, out has no rows then
+   */
+  template <typename Context_>
+  bool sample(Context_ &ctx, unsigned n, sample_matrix &out, unsigned threads = 1) {
+    return ctx.command(sample_cmd(), n, out, threads);
+  }
+
+  /**
+   * \brief draw n samples, calling f with each one as the current solution
+   *
+   * read_value() inside f returns the values of the sample.
+   *
+   * \returns false if there is no solution, f is not called then
+   */
+  template <typename Context_>
+  bool sample(Context_ &ctx, unsigned n, std::function<void()> const &f) {
+    return ctx.command(sample_cmd(), n, f);
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <typeindex>
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief the slot of a type in the per-context storage
+   *
+   * The slot is empty until support_cache() fills it.
+   */
+  struct support_cache_cmd {
+    typedef std::shared_ptr<void> &result_type;
+  };
+
+  /**
+   * \brief SupportCache API, state of the support code kept by a context
+   *
+   * \code
+   *  DirectSolver_Context< solver::Z3_Backend > ctx;
+   *
+   *  Cache *c = support_cache<Cache>(ctx);
+   *  if (c) {
+   *    // the same object for every call on ctx
+   *  }
+   * \endcode
+   *
+   * \ingroup API
+   * \defgroup SupportCache SupportCache
+   * @{
+   */
+
+  /**
+   * \brief the object of type T kept by ctx
+   *
+   * Contexts supporting support_cache_cmd create one default constructed T
+   * on the first call and keep it until they are destroyed.
+   *
+   * \param ctx The metaSMT Context
+   * \returns the object, or 0 if ctx does not support support_cache_cmd
+   */
+  template <typename T, typename Context_>
+  T *support_cache(Context_ &ctx) {
+    if constexpr (features::supports<Context_, support_cache_cmd>::value) {
+      std::shared_ptr<void> &slot = ctx.command(support_cache_cmd(), std::type_index(typeid(T)));
+      if (!slot) slot = std::make_shared<T>();
+      return static_cast<T *>(slot.get());
+    } else {
+      return 0;
+    }
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  struct get_unsat_core_cmd {
+    typedef std::vector<unsigned> result_type;
+  };
+
+  /**
+   * \brief UnsatCore API, failed assumptions of the last solve()
+   *
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< SAT_Clause< solver::MiniSAT > > > ctx;
+   *
+   *  assumption(ctx, a); // index 0
+   *  assumption(ctx, b); // index 1
+   *  assumption(ctx, c); // index 2
+   *  if (!solve(ctx)) {
+   *    std::vector<unsigned> core = get_unsat_core(ctx); // e.g. {0, 2}
+   *  }
+   * \endcode
+   *
+   * The core holds the indices of the assumptions, in the order they were
+   * added for the last solve(), that are sufficient for unsatisfiability.
+   * It is not necessarily minimal. An empty core after an unsatisfiable
+   * solve() means the assertions alone are unsatisfiable; after a
+   * satisfiable or unknown solve() the core is always empty.
+   *
+   * Check features::supports<Context, get_unsat_core_cmd> before use.
+   *
+   * \ingroup API
+   * \defgroup UnsatCore UnsatCore
+   * @{
+   */
+
+  /**
+   * \brief indices of the failed assumptions of the last solve()
+   *
+   * \param ctx The metaSMT Context
+   * \returns the sorted assumption indices
+   */
+  template <typename Context_>
+  std::vector<unsigned> get_unsat_core(Context_& ctx) {
+    return ctx.command(get_unsat_core_cmd());
+  }
+  /**@}*/
+}  // namespace metaSMT
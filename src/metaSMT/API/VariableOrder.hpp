@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../Features.hpp"
+
+namespace metaSMT {
+  /**
+   * \brief hint that the i-th elements of two vectors are combined bit by bit
+   *
+   * Issued by BitBlast for the operands of additions, multiplications and
+   * comparisons, for backends whose size depends on the variable order.
+   */
+  struct order_hint_cmd {
+    typedef void result_type;
+  };
+
+  struct reorder_cmd {
+    typedef void result_type;
+  };
+
+  /**
+   * \brief Variable order API
+   *
+   * Backends based on decision diagrams support reorder_cmd, the option
+   * "cudd.order" selects the static ordering of the CUDD backends:
+   *
+   *  - "creation" (default) keeps the variables in creation order,
+   *  - "interleave" interleaves the bits of bit-vectors as soon as they
+   *    are added, subtracted, multiplied or compared,
+   *  - "force" collects these relations as a hypergraph and reorders the
+   *    variables with the FORCE heuristic when reorder() is called.
+   *
+   * The option "cudd.reordering" selects the dynamic reordering method:
+   * "sift" (default), "sift_converge", "symm_sift", "group_sift",
+   * "window" or "none".
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< CUDD_Context > > ctx;
+   *  set_option(ctx, "cudd.order", "force");
+   *  set_option(ctx, "cudd.reordering", "none");
+   *
+   *  bitvector a = new_bitvector(32), b = new_bitvector(32);
+   *  predicate p = bvult(a, b);
+   *  reorder(ctx);
+   * \endcode
+   *
+   * \ingroup API
+   * \defgroup VariableOrder VariableOrder
+   * @{
+   */
+
+  /**
+   * \brief reorder the variables now
+   *
+   * Applies the FORCE order with "cudd.order" = "force", otherwise runs
+   * the reordering method of "cudd.reordering" once.
+   */
+  template <typename Context_>
+  void reorder(Context_ &ctx) {
+    ctx.command(reorder_cmd());
+  }
+  /**@}*/
+}  // namespace metaSMT
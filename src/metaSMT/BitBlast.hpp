@@ -2,11 +2,22 @@
 
 #include <any>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <tuple>
 #include <variant>
-
+#include <vector>
+
+#include "API/AllSolutions.hpp"
+#include "API/Cardinality.hpp"
+#include "API/LiteralWeights.hpp"
+#include "API/Optimize.hpp"
+#include "API/Options.hpp"
+#include "API/ReadValues.hpp"
+#include "API/VariableOrder.hpp"
 #include "Features.hpp"
 #include "result_wrapper.hpp"
+#include "support/Options.hpp"
 #include "tags/QF_BV.hpp"
 
 namespace metaSMT {
@@ -49,7 +60,8 @@ namespace metaSMT {
       // printf("bitvec\n");
       bv_result ret(var.width);
       for (unsigned i = 0; i < var.width; ++i) {
-        ret[i] = _solver(predtags::var_tag(), arg);
+        // fresh ids, backends that name their variables by id must not merge the bits
+        ret[i] = _solver(logic::new_variable(), arg);
       }
       return ret;
     }
@@ -154,6 +166,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -182,6 +195,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -210,6 +224,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -240,6 +255,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -269,6 +285,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -300,6 +317,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -331,6 +349,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -362,6 +381,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
       assert(a.size() > 0);
 
       typename bv_result::reverse_iterator ai, bi, end;
@@ -392,6 +412,7 @@ namespace metaSMT {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
       assert(a.size() == b.size());
+      order_hint(a, b);
 
       bv_result ret(a.size());
 
@@ -415,6 +436,11 @@ namespace metaSMT {
     result_type operator()(bvtags::bvmul_tag, result_type arg1, result_type arg2) {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
+      order_hint(a, b);
+      if (multiplier_ == option::bv_multiplier::wallace) {
+        return wallace(a, b);
+      }
+
       result_type ret = bv_result(a.size(), _solver(predtags::false_tag(), std::any()));
       result_type tmp1;
 
@@ -438,7 +464,7 @@ namespace metaSMT {
       return (*this)(bvtags::bvadd_tag(), tmp2, tmp1);
     }
 
-    result_type operator()(bvtags::bvudiv_tag, result_type arg1, result_type arg2) { return uDivRem(arg1, arg2, true); }
+    result_type operator()(bvtags::bvudiv_tag, result_type arg1, result_type arg2) { return divide(arg1, arg2, true); }
 
     result_type operator()(bvtags::bvsdiv_tag, result_type arg1, result_type arg2) { return sDivRem(arg1, arg2, true); }
 
@@ -565,10 +591,11 @@ namespace metaSMT {
     }
 
     result_type operator()(bvtags::bvurem_tag, result_type arg1, result_type arg2) {
-      return uDivRem(arg1, arg2, false);
+      return divide(arg1, arg2, false);
     }
 
     result_type operator()(bvtags::bvsub_tag, result_type arg1, result_type arg2) {
+      order_hint(std::get<bv_result>(arg1), std::get<bv_result>(arg2));
       result_type tmp((*this)(bvtags::bvneg_tag(), arg2));
 
       return (*this)(bvtags::bvadd_tag(), arg1, tmp);
@@ -608,6 +635,7 @@ namespace metaSMT {
         // printf("read arg2\n");
         bv_result b = std::get<bv_result>(arg2);
         assert(a.size() == b.size());
+        order_hint(a, b);
         ret = _solver(predtags::true_tag(), std::any());
         for (unsigned i = 0; i < a.size(); ++i) {
           result_base cur = _solver(eq, a[i], b[i]);
@@ -634,6 +662,7 @@ namespace metaSMT {
         // printf("read arg2\n");
         bv_result b = std::get<bv_result>(arg2);
         assert(a.size() == b.size());
+        order_hint(a, b);
         ret = _solver(predtags::false_tag(), std::any());
         for (unsigned i = 0; i < a.size(); ++i) {
           result_base cur = _solver(neq, a[i], b[i]);
@@ -857,14 +886,117 @@ namespace metaSMT {
       }
     }
 
+    /// selects multiplier and divider, the predicate solver gets the options as well
+    void command(setup_option_map_cmd const&, Options const& opt) {
+      multiplier_ = opt.get(option::multiplier());
+      divider_ = opt.get(option::divider());
+      if constexpr (features::supports<PredicateSolver, setup_option_map_cmd>::value) {
+        _solver.command(setup_option_map_cmd(), opt);
+      }
+    }
+
+    /// the weights apply to every bit of a bit-vector
+    void command(literal_weight_cmd const& cmd, result_type e, double w_true, double w_false) {
+      if (bv_result const* bits = std::get_if<bv_result>(&e)) {
+        for (result_base const& b : *bits) _solver.command(cmd, b, w_true, w_false);
+      } else {
+        _solver.command(cmd, std::get<result_base>(e), w_true, w_false);
+      }
+    }
+
+    /// projects onto the bits of the bit-vectors
+    std::uint64_t command(for_each_solution_cmd const& cmd, std::vector<result_type> const& vars,
+                          std::function<void()> const& f, std::uint64_t limit) {
+      bv_result bits;
+      for (result_type const& v : vars) {
+        if (bv_result const* b = std::get_if<bv_result>(&v)) {
+          bits.insert(bits.end(), b->begin(), b->end());
+        } else {
+          bits.push_back(std::get<result_base>(v));
+        }
+      }
+      return _solver.command(cmd, bits, f, limit);
+    }
+
+    /// reads the bits of all variables in one read_values_cmd of the predicate solver, if supported
+    std::vector<result_wrapper> command(read_values_cmd const& cmd, std::vector<result_type> const& vars) {
+      std::vector<result_wrapper> values;
+      values.reserve(vars.size());
+      if constexpr (features::supports<PredicateSolver, read_values_cmd>::value) {
+        std::vector<result_base> bits;
+        for (result_type const& v : vars) {
+          if (bv_result const* b = std::get_if<bv_result>(&v)) {
+            bits.insert(bits.end(), b->begin(), b->end());
+          } else {
+            bits.push_back(std::get<result_base>(v));
+          }
+        }
+        std::vector<result_wrapper> const bit_values = _solver.command(cmd, bits);
+        std::vector<result_wrapper>::const_iterator it = bit_values.begin();
+        for (result_type const& v : vars) {
+          if (bv_result const* b = std::get_if<bv_result>(&v)) {
+            std::vector<tribool> ret(b->size());
+            for (tribool& t : ret) t = *it++;
+            values.push_back(result_wrapper(ret));
+          } else {
+            values.push_back(*it++);
+          }
+        }
+      } else {
+        for (result_type const& v : vars) values.push_back(read_value(v));
+      }
+      return values;
+    }
+
+    /// native cardinality constraints of the predicate solver, see API/Cardinality.hpp
+    template <typename Tag>
+    result_type command(cardinality_cmd const& cmd, Tag const& tag, std::vector<result_type> const& ps, unsigned k) {
+      return _solver.command(cmd, tag, predicates(ps), k);
+    }
+
+    template <typename Tag>
+    result_type command(pseudo_boolean_cmd const& cmd, Tag const& tag, std::vector<result_type> const& ps,
+                        std::vector<int64_t> const& weights, int64_t k) {
+      return _solver.command(cmd, tag, predicates(ps), weights, k);
+    }
+
+    /// native MaxSAT of the predicate solver, see API/Optimize.hpp
+    bool command(maxsat_cmd const& cmd, std::vector<result_type> const& soft, std::vector<uint64_t> const& weights) {
+      return _solver.command(cmd, predicates(soft), weights);
+    }
+
     /* pseudo command */
     void command(BitBlast<PredicateSolver> const&){};
+    template <typename Command>
+    typename Command::result_type command(Command const& cmd) {
+      return _solver.command(cmd);
+    }
     template <typename Command, typename Expr>
-    void command(Command const& cmd, Expr& expr) {
-      _solver.command(cmd, expr);
+    typename Command::result_type command(Command const& cmd, Expr& expr) {
+      return _solver.command(cmd, expr);
+    }
+    template <typename Command, typename Expr1, typename Expr2, typename... Exprs>
+    typename Command::result_type command(Command const& cmd, Expr1& e1, Expr2& e2, Exprs&... es) {
+      return _solver.command(cmd, e1, e2, es...);
     }
 
    private:
+    std::vector<result_base> predicates(std::vector<result_type> const& ps) {
+      std::vector<result_base> ret;
+      ret.reserve(ps.size());
+      for (result_type const& p : ps) {
+        ret.push_back(std::get<result_base>(p));
+      }
+      return ret;
+    }
+
+    /// corresponding bits of a and b are combined, see API/VariableOrder.hpp
+    void order_hint(bv_result const& a, bv_result const& b) {
+      if constexpr (features::supports<PredicateSolver, order_hint_cmd>::value) {
+        _solver.command(order_hint_cmd(), a, b);
+      }
+    }
+
     result_type sDivRem(result_type arg1, result_type arg2, bool value) {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
@@ -879,14 +1011,115 @@ namespace metaSMT {
       result_type aneg = (*this)(ite, a.back(), (*this)(neg, arg1), arg1);
       result_type bneg = (*this)(ite, b.back(), (*this)(neg, arg2), arg2);
 
-      result_type test = uDivRem(aneg, bneg, value);
+      result_type test = divide(aneg, bneg, value);
 
-      test = (*this)(ite, _solver(xor_, a.back(), b.back()), (*this)(neg, test), test);
+      // the quotient is negative for different signs, the remainder takes the sign of the dividend
+      result_base negate = value ? _solver(xor_, a.back(), b.back()) : a.back();
+      test = (*this)(ite, negate, (*this)(neg, test), test);
 
       return test;
     }
 
    private:
+    /// both dividers give all ones for division by zero and the dividend as remainder
+    result_type divide(result_type arg1, result_type arg2, bool quotient) {
+      if (divider_ == option::bv_divider::restoring) {
+        return restoring(arg1, arg2, quotient);
+      }
+      result_type ret = uDivRem(arg1, arg2, quotient);
+      if (!quotient) {
+        return ret;
+      }
+      unsigned const n = std::get<bv_result>(arg2).size();
+      result_type by_zero =
+          (*this)(predtags::equal_tag(), arg2, bv_result(n, _solver(predtags::false_tag(), std::any())));
+      return (*this)(predtags::ite_tag(), by_zero, bv_result(n, _solver(predtags::true_tag(), std::any())), ret);
+    }
+
+    /**
+     * Restoring array divider: one trial subtraction per bit on an n+1 bit
+     * remainder, from the most significant bit of the dividend. Division
+     * by zero gives all ones and the dividend as remainder.
+     **/
+    result_type restoring(result_type arg1, result_type arg2, bool quotient) {
+      bv_result a = std::get<bv_result>(arg1);
+      bv_result b = std::get<bv_result>(arg2);
+      unsigned const n = a.size();
+
+      result_base zero = _solver(predtags::false_tag(), std::any());
+      bv_result divisor = b;
+      divisor.push_back(zero);
+
+      bv_result q(n, zero);
+      bv_result rem(n + 1, zero);
+      for (unsigned i = n; i-- > 0;) {
+        bv_result shifted(n + 1);
+        shifted[0] = a[i];
+        std::copy(rem.begin(), rem.end() - 1, shifted.begin() + 1);
+
+        result_type ge = (*this)(bvtags::bvuge_tag(), shifted, divisor);
+        q[i] = std::get<result_base>(ge);
+        rem = std::get<bv_result>((*this)(predtags::ite_tag(), ge, (*this)(bvtags::bvsub_tag(), shifted, divisor),
+                                          shifted));
+      }
+
+      if (quotient) {
+        return q;
+      }
+      rem.pop_back();
+      return rem;
+    }
+
+    /**
+     * Wallace tree multiplier: the partial products are reduced column-wise
+     * by full adders until each column has at most two bits, which are
+     * summed by one ripple carry adder. Carries beyond the width are
+     * dropped.
+     **/
+    result_type wallace(bv_result const& a, bv_result const& b) {
+      unsigned const n = a.size();
+      result_base zero = _solver(predtags::false_tag(), std::any());
+
+      std::vector<bv_result> columns(n);
+      for (unsigned i = 0; i < n; ++i) {
+        for (unsigned j = 0; i + j < n; ++j) {
+          columns[i + j].push_back(_solver(predtags::and_tag(), a[j], b[i]));
+        }
+      }
+
+      bool reduced = false;
+      while (!reduced) {
+        std::vector<bv_result> next(n);
+        for (unsigned k = 0; k < n; ++k) {
+          bv_result const& column = columns[k];
+          std::size_t i = 0;
+          for (; i + 3 <= column.size(); i += 3) {
+            result_base xy = _solver(predtags::xor_tag(), column[i], column[i + 1]);
+            next[k].push_back(_solver(predtags::xor_tag(), xy, column[i + 2]));
+            if (k + 1 < n) {
+              result_base and1 = _solver(predtags::and_tag(), column[i], column[i + 1]);
+              result_base and2 = _solver(predtags::and_tag(), column[i + 2], xy);
+              next[k + 1].push_back(_solver(predtags::or_tag(), and1, and2));
+            }
+          }
+          next[k].insert(next[k].end(), column.begin() + i, column.end());
+        }
+        columns.swap(next);
+
+        reduced = true;
+        for (bv_result const& column : columns) {
+          reduced = reduced && column.size() <= 2;
+        }
+      }
+
+      bv_result x(n, zero), y(n, zero);
+      for (unsigned k = 0; k < n; ++k) {
+        if (columns[k].size() > 0) x[k] = columns[k][0];
+        if (columns[k].size() > 1) y[k] = columns[k][1];
+      }
+      return (*this)(bvtags::bvadd_tag(), x, y);
+    }
+
     result_type uDivRem(result_type arg1, result_type arg2, bool value) {
       bv_result a = std::get<bv_result>(arg1);
       bv_result b = std::get<bv_result>(arg2);
@@ -991,6 +1224,8 @@ namespace metaSMT {
 
    private:
     PredicateSolver _solver;
+    option::bv_multiplier multiplier_ = option::bv_multiplier::shift_add;
+    option::bv_divider divider_ = option::bv_divider::shift_subtract;
   };
 
   namespace features {
@@ -998,6 +1233,19 @@ namespace metaSMT {
     template <typename Context>
     struct supports<BitBlast<Context>, features::addclause_api> : std::true_type {};
 
+    template <typename Context>
+    struct supports<BitBlast<Context>, setup_option_map_cmd> : std::true_type {};
+
+    template <typename Context>
+    struct supports<BitBlast<Context>, read_values_cmd> : std::true_type {};
+
+    /* the objectives are bit-blasted, the predicate solver cannot optimize them */
+    template <typename Context>
+    struct supports<BitBlast<Context>, minimize_cmd> : std::false_type {};
+
+    template <typename Context>
+    struct supports<BitBlast<Context>, maximize_cmd> : std::false_type {};
+
     /* Forward all other supported operations */
     template <typename Context, typename Feature>
     struct supports<BitBlast<Context>, Feature> : supports<Context, Feature>::type {};
@@ -2,12 +2,19 @@
 
 #include <any>
 #include <cassert>
+#include <memory>
+#include <type_traits>
+#include <typeindex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "API/Assertion.hpp"
 #include "API/Assumption.hpp"
 #include "API/Evaluator.hpp"
+#include "API/Interrupt.hpp"
 #include "API/Options.hpp"
+#include "API/SupportCache.hpp"
 #include "Features.hpp"
 #include "result_wrapper.hpp"
 #include "support/Options.hpp"
@@ -17,23 +24,31 @@
 #include "tags/QF_UF.hpp"
 
 namespace metaSMT {
+  namespace detail {
+    /// commands handled by DirectSolver_Context itself
+    template <typename Cmd>
+    struct direct_solver_command
+        : std::disjunction<std::is_same<Cmd, assertion_cmd>, std::is_same<Cmd, assumption_cmd>,
+                           std::is_same<Cmd, set_option_cmd>, std::is_same<Cmd, get_option_cmd>,
+                           std::is_same<Cmd, interrupt_cmd>, std::is_same<Cmd, support_cache_cmd> > {};
+
+    template <typename Expr>
+    struct direct_solver_command<pending_assumptions_cmd<Expr> > : std::true_type {};
+  }  // namespace detail
+
   /**
    * @brief direct Solver integration
    *
    *  DirectSolver_Context takes a SolverType and directly feeds all commands
    *  to it. Variable expressions are cached and only evaluated once.
+   *  Assumptions are kept until the next solve() or solver command.
    **/
   template <typename SolverContext>
   struct DirectSolver_Context : public SolverContext {
     DirectSolver_Context() = default;
-    // DirectSolver_Context() {
-    //   typedef typename mpl::if_<
-    //       /* if   = */ typename features::supports<SolverContext, setup_option_map_cmd>::type,
-    //       /* then = */ option::SetupOptionMapCommand, /* else = */ option::NOPCommand>::type Command;
-    //   Command::template action(static_cast<SolverContext &>(*this), opt);
-    // }
 
-    DirectSolver_Context(Options const &opt) : opt(opt) {}
+    /// passes the options to solvers that support setup_option_map_cmd
+    DirectSolver_Context(Options const &opt) : opt(opt) { setup_options(); }
 
     /// The returned expression type is the result_type of the SolverContext
     typedef typename SolverContext::result_type result_type;
@@ -212,15 +227,19 @@ namespace metaSMT {
 
     void command(assertion_cmd const &, result_type e) { SolverContext::assertion(e); }
 
-    void command(assumption_cmd const &, result_type e) { SolverContext::assumption(e); }
+    void command(assumption_cmd const &, result_type e) { assumptions_.push_back(e); }
 
-    // void command(set_option_cmd const &, std::string const &key, std::string const &value) {
-    //   opt.set(key, value);
-    //   typedef typename mpl::if_<
-    //       /* if   = */ typename features::supports<SolverContext, set_option_cmd>::type,
-    //       /* then = */ option::SetOptionCommand, /* else = */ option::NOPCommand>::type Command;
-    //   Command::template action(static_cast<SolverContext &>(*this), opt, key, value);
-    // }
+    std::vector<result_type> command(pending_assumptions_cmd<result_type> const &) {
+      std::vector<result_type> ret;
+      ret.swap(assumptions_);
+      return ret;
+    }
+
+    /// sets the option and passes the updated options to the solver
+    void command(set_option_cmd const &, std::string const &key, std::string const &value) {
+      opt.set(key, value);
+      setup_options();
+    }
 
     std::string command(get_option_cmd const &, std::string const &key) { return opt.get(key); }
 
@@ -228,12 +247,52 @@ namespace metaSMT {
       return opt.get(key, default_value);
     }
 
-    using SolverContext::command;
+    template <typename T, T option::Typed::*Member>
+    T command(get_option_cmd const &, option::key<T, Member> const &key) {
+      return opt.get(key);
+    }
+
+    std::shared_ptr<void> &command(support_cache_cmd const &, std::type_index const &type) {
+      return support_cache_[type];
+    }
+
+    /// called from other threads during solve(), leaves the assumptions alone
+    void command(interrupt_cmd const &cmd) { SolverContext::command(cmd); }
+
+    /// the other commands go to the solver, after the pending assumptions
+    template <typename Cmd, typename... Args>
+    auto command(Cmd const &cmd, Args &&... args) -> typename std::enable_if<
+        !detail::direct_solver_command<Cmd>::value,
+        decltype(std::declval<SolverContext &>().command(cmd, std::forward<Args>(args)...))>::type {
+      pass_assumptions();
+      return SolverContext::command(cmd, std::forward<Args>(args)...);
+    }
+
+    bool solve() {
+      pass_assumptions();
+      return SolverContext::solve();
+    }
 
    private:
+    void pass_assumptions() {
+      for (result_type const &e : assumptions_) {
+        SolverContext::assumption(e);
+      }
+      assumptions_.clear();
+    }
+
+    void setup_options() {
+      typedef typename std::conditional<features::supports<SolverContext, setup_option_map_cmd>::value,
+                                        option::SetupOptionMapCommand, option::NOPCommand>::type Command;
+      Command::action(static_cast<SolverContext &>(*this), opt);
+    }
+
     typedef typename std::unordered_map<unsigned, result_type> VariableLookupT;
     VariableLookupT _variables;
     Options opt;
+    std::vector<result_type> assumptions_;
+    /// destroyed before the solver, the objects may hold expressions
+    std::unordered_map<std::type_index, std::shared_ptr<void> > support_cache_;
 
     // disable copying DirectSolvers;
     DirectSolver_Context(DirectSolver_Context const &);
@@ -250,11 +309,18 @@ namespace metaSMT {
     template <typename Context>
     struct supports<DirectSolver_Context<Context>, assumption_cmd> : std::true_type {};
 
+    template <typename Context, typename Expr>
+    struct supports<DirectSolver_Context<Context>, pending_assumptions_cmd<Expr> >
+        : std::is_same<Expr, typename DirectSolver_Context<Context>::result_type> {};
+
     template <typename Context>
     struct supports<DirectSolver_Context<Context>, get_option_cmd> : std::true_type {};
 
     template <typename Context>
     struct supports<DirectSolver_Context<Context>, set_option_cmd> : std::true_type {};
+
+    template <typename Context>
+    struct supports<DirectSolver_Context<Context>, support_cache_cmd> : std::true_type {};
   }  // namespace features
 
   template <typename SolverType>
@@ -0,0 +1,458 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "API/Budget.hpp"
+#include "API/Interrupt.hpp"
+#include "API/SupportCache.hpp"
+#include "API/UnsatCore.hpp"
+#include "DirectSolver_Context.hpp"
+
+namespace metaSMT {
+  namespace detail {
+    template <typename T>
+    Options const &portfolio_options(Options const &opt) {
+      return opt;
+    }
+  }  // namespace detail
+
+  /**
+   * @brief race several solvers on the same problem
+   *
+   *  Portfolio_Context holds one DirectSolver_Context per SolverContext and
+   *  replicates every expression, assertion and assumption to all of them.
+   *  An expression of the portfolio is the tuple of the member expressions.
+   *
+   *  solve() runs all members concurrently, one worker thread per member.
+   *  The first member that returns a definite answer decides the result,
+   *  all other members are interrupted if they support the Interrupt API.
+   *  The interrupt is repeated until they returned, so solve() does not
+   *  return before the interruptible members stopped. read_value() reads
+   *  from the winning member. solve_limited() passes the budget to every
+   *  member and is indeterminate if no member answered within it.
+   *
+   *  Members that cannot be interrupted keep running in the background
+   *  after solve() returned. The next operation that modifies the portfolio
+   *  waits for them to finish.
+   *
+   * \code
+   *  Portfolio_Context< Z3_Backend, BitBlast< SAT_Clause< solver::MiniSAT > > > ctx;
+   *
+   *  logic::QF_BV::tag::var_tag x = logic::QF_BV::new_bitvector(8);
+   *  assertion(ctx, ctx(bvtags::bvult_tag(), x, ctx(bvtags::bvuint_tag(), 4, 8)));
+   *  solve(ctx) == true;
+   *  read_value(ctx, ctx(x));
+   * \endcode
+   **/
+  template <typename... SolverContexts>
+  class Portfolio_Context {
+    static_assert(sizeof...(SolverContexts) > 0, "Portfolio_Context requires at least one member");
+
+    typedef std::tuple<DirectSolver_Context<SolverContexts>...> Members;
+
+   public:
+    /// The returned expression type is the tuple of the member result_types
+    typedef std::tuple<typename DirectSolver_Context<SolverContexts>::result_type...> result_type;
+
+    static constexpr std::size_t size = sizeof...(SolverContexts);
+
+    Portfolio_Context() : Portfolio_Context(Options()) {}
+
+    Portfolio_Context(Options const &opt)
+        : members_(detail::portfolio_options<SolverContexts>(opt)...),
+          opt_(opt),
+          stop_(false),
+          generation_(0),
+          running_(0),
+          winner_(no_winner),
+          result_(false),
+          budget_() {
+      busy_.fill(false);
+      start_workers(std::index_sequence_for<SolverContexts...>());
+    }
+
+    ~Portfolio_Context() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      stop_losers(no_winner);
+      job_cv_.notify_all();
+      for (std::thread &t : workers_) {
+        t.join();
+      }
+    }
+
+    template <typename Tag>
+    typename std::enable_if<Evaluator<Tag>::value, result_type>::type operator()(Tag const &t) {
+      return Evaluator<Tag>::eval(*this, t);
+    }
+
+    result_type operator()(result_type const &r) { return r; }
+
+    /// evaluate the expression in every member
+    template <typename... Args>
+    result_type operator()(Args const &... args) {
+      wait_idle();
+      return eval(std::index_sequence_for<SolverContexts...>(), args...);
+    }
+
+    unsigned get_bv_width(result_type const &e) {
+      wait_idle();
+      return std::get<0>(members_).get_bv_width(std::get<0>(e));
+    }
+
+    void command(assertion_cmd const &, result_type const &e) {
+      wait_idle();
+      assert_members(e, std::index_sequence_for<SolverContexts...>());
+    }
+
+    void command(assumption_cmd const &, result_type const &e) {
+      wait_idle();
+      assume_members(e, std::index_sequence_for<SolverContexts...>());
+    }
+
+    std::vector<result_type> command(pending_assumptions_cmd<result_type> const &) {
+      wait_idle();
+      return pending_assumptions(std::index_sequence_for<SolverContexts...>());
+    }
+
+    std::string command(get_option_cmd const &, std::string const &key) { return opt_.get(key); }
+
+    std::string command(get_option_cmd const &, std::string const &key, std::string const &default_value) {
+      return opt_.get(key, default_value);
+    }
+
+    template <typename T, T option::Typed::*Member>
+    T command(get_option_cmd const &, option::key<T, Member> const &key) {
+      return opt_.get(key);
+    }
+
+    std::shared_ptr<void> &command(support_cache_cmd const &, std::type_index const &type) {
+      return support_cache_[type];
+    }
+
+    /// sets the option of the portfolio and of every member
+    void command(set_option_cmd const &, std::string const &key, std::string const &value) {
+      wait_idle();
+      opt_.set(key, value);
+      std::apply([&key, &value](auto &... members) { (set_option(members, key, value), ...); }, members_);
+    }
+
+    /**
+     * @brief solve all members concurrently, the first answer wins
+     *
+     * @throws std::runtime_error if no member returned a definite answer
+     **/
+    bool solve() {
+      tribool const result = command(solve_limited_cmd(), budget());
+      if (indeterminate(result)) {
+        throw std::runtime_error("Portfolio_Context: no member returned a result");
+      }
+      return static_cast<bool>(result);
+    }
+
+    /**
+     * @brief solve all members concurrently with the budget b
+     *
+     * @returns indeterminate if no member returned a definite answer
+     **/
+    tribool command(solve_limited_cmd const &, budget const &b) {
+      wait_idle();
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      winner_ = no_winner;
+      running_ = size;
+      busy_.fill(true);
+      budget_ = b;
+      ++generation_;
+      job_cv_.notify_all();
+      done_cv_.wait(lock, [this] { return winner_ != no_winner || running_ == 0; });
+      if (winner_ == no_winner) {
+        return indeterminate;
+      }
+      std::size_t const winner = winner_;
+      bool const result = result_;
+      lock.unlock();
+
+      stop_losers(winner);
+      return result;
+    }
+
+    /// the unsat core reported by the winning member
+    std::vector<unsigned> command(get_unsat_core_cmd const &) {
+      std::vector<unsigned> core;
+      unsat_core(core, std::index_sequence_for<SolverContexts...>());
+      return core;
+    }
+
+    /// interrupt every member that supports the Interrupt API
+    void command(interrupt_cmd const &) { interrupt_losers(no_winner, std::index_sequence_for<SolverContexts...>()); }
+
+    /**
+     * @brief index of the member that answered the last solve()
+     *
+     * @pre solve() must have been called before.
+     **/
+    std::size_t winner() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return winner_;
+    }
+
+    /**
+     * @brief result retrieval from the winning member
+     *
+     * @pre solve() must be true before calling and no assertions/assumptions
+     *      may be added in between.
+     **/
+    result_wrapper read_value(result_type const &var) {
+      assert(winner_ != no_winner && "read_value called before solve");
+      return read_value(var, std::index_sequence_for<SolverContexts...>());
+    }
+
+    /// access the I-th member context
+    template <std::size_t I>
+    typename std::tuple_element<I, Members>::type &member() {
+      wait_idle();
+      return std::get<I>(members_);
+    }
+
+   private:
+    static constexpr std::size_t no_winner = std::numeric_limits<std::size_t>::max();
+
+    static constexpr std::array<bool, size> interruptible_ = {
+        {features::supports<DirectSolver_Context<SolverContexts>, interrupt_cmd>::value...}};
+
+    template <std::size_t I, typename T>
+    static T const &project(T const &t) {
+      return t;
+    }
+
+    template <std::size_t I>
+    static typename std::tuple_element<I, result_type>::type const &project(result_type const &r) {
+      return std::get<I>(r);
+    }
+
+    template <std::size_t I>
+    static std::vector<typename std::tuple_element<I, result_type>::type> project(std::vector<result_type> const &rs) {
+      std::vector<typename std::tuple_element<I, result_type>::type> ret;
+      ret.reserve(rs.size());
+      for (result_type const &r : rs) {
+        ret.push_back(std::get<I>(r));
+      }
+      return ret;
+    }
+
+    template <std::size_t I, typename... Args>
+    typename std::tuple_element<I, result_type>::type eval_member(Args const &... args) {
+      return std::get<I>(members_)(project<I>(args)...);
+    }
+
+    template <std::size_t... I, typename... Args>
+    result_type eval(std::index_sequence<I...>, Args const &... args) {
+      return result_type(eval_member<I>(args...)...);
+    }
+
+    template <std::size_t... I>
+    void assert_members(result_type const &e, std::index_sequence<I...>) {
+      (metaSMT::assertion(std::get<I>(members_), std::get<I>(e)), ...);
+    }
+
+    template <std::size_t... I>
+    void assume_members(result_type const &e, std::index_sequence<I...>) {
+      (metaSMT::assumption(std::get<I>(members_), std::get<I>(e)), ...);
+    }
+
+    /// the members hold the same number of pending assumptions
+    template <std::size_t... I>
+    std::vector<result_type> pending_assumptions(std::index_sequence<I...>) {
+      std::tuple<std::vector<typename DirectSolver_Context<SolverContexts>::result_type>...> const pending(
+          std::get<I>(members_).command(
+              pending_assumptions_cmd<typename DirectSolver_Context<SolverContexts>::result_type>())...);
+      std::vector<result_type> ret;
+      for (std::size_t i = 0; i < std::get<0>(pending).size(); ++i) {
+        ret.emplace_back(std::get<I>(pending)[i]...);
+      }
+      return ret;
+    }
+
+    template <std::size_t... I>
+    result_wrapper read_value(result_type const &var, std::index_sequence<I...>) {
+      result_wrapper ret;
+      ((winner_ == I ? (ret = std::get<I>(members_).read_value(std::get<I>(var)), true) : false) || ...);
+      return ret;
+    }
+
+    template <std::size_t... I>
+    void unsat_core(std::vector<unsigned> &core, std::index_sequence<I...>) {
+      ((winner_ == I ? (core = get_unsat_core(std::get<I>(members_)), true) : false) || ...);
+    }
+
+    template <std::size_t I>
+    void interrupt_member(std::size_t winner) {
+      typedef typename std::tuple_element<I, Members>::type Member;
+      if constexpr (features::supports<Member, interrupt_cmd>::value) {
+        if (I != winner) {
+          metaSMT::interrupt(std::get<I>(members_));
+        }
+      }
+    }
+
+    template <std::size_t... I>
+    void interrupt_losers(std::size_t winner, std::index_sequence<I...>) {
+      (interrupt_member<I>(winner), ...);
+    }
+
+    /**
+     * An interrupt that arrives before a member started its search is lost,
+     * so the interrupt is repeated until every interruptible member returned.
+     **/
+    void stop_losers(std::size_t winner) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (interruptible_busy()) {
+        lock.unlock();
+        interrupt_losers(winner, std::index_sequence_for<SolverContexts...>());
+        lock.lock();
+        done_cv_.wait_for(lock, std::chrono::milliseconds(1), [this] { return !interruptible_busy(); });
+      }
+    }
+
+    /// requires the lock on mutex_
+    bool interruptible_busy() const {
+      for (std::size_t i = 0; i < size; ++i) {
+        if (busy_[i] && interruptible_[i]) return true;
+      }
+      return false;
+    }
+
+    template <std::size_t... I>
+    void start_workers(std::index_sequence<I...>) {
+      workers_.reserve(size);
+      (workers_.emplace_back(&Portfolio_Context::worker<I>, this), ...);
+    }
+
+    template <std::size_t I>
+    void worker() {
+      unsigned seen = 0;
+      for (;;) {
+        budget b;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          job_cv_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+          if (stop_) return;
+          seen = generation_;
+          b = budget_;
+        }
+
+        tribool sat = indeterminate;
+        try {
+          sat = solve_limited(std::get<I>(members_), b);
+        } catch (std::exception const &) {
+          // a failing member does not decide the portfolio
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!indeterminate(sat) && winner_ == no_winner) {
+            winner_ = I;
+            result_ = static_cast<bool>(sat);
+          }
+          busy_[I] = false;
+          --running_;
+        }
+        done_cv_.notify_all();
+      }
+    }
+
+    void wait_idle() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_cv_.wait(lock, [this] { return running_ == 0; });
+    }
+
+    Members members_;
+    Options opt_;
+    /// destroyed before the members, the objects may hold expressions
+    std::unordered_map<std::type_index, std::shared_ptr<void> > support_cache_;
+
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable job_cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    unsigned generation_;
+    std::size_t running_;
+    /// members whose solve_limited() has not returned yet
+    std::array<bool, size> busy_;
+    std::size_t winner_;
+    bool result_;
+    budget budget_;
+
+    // disable copying Portfolio_Contexts
+    Portfolio_Context(Portfolio_Context const &);
+    Portfolio_Context &operator=(Portfolio_Context const &);
+  };
+
+  namespace features {
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, assertion_cmd> : std::true_type {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, assumption_cmd> : std::true_type {};
+
+    template <typename... SolverContexts, typename Expr>
+    struct supports<Portfolio_Context<SolverContexts...>, pending_assumptions_cmd<Expr> >
+        : std::is_same<Expr, typename Portfolio_Context<SolverContexts...>::result_type> {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, get_option_cmd> : std::true_type {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, set_option_cmd> : std::true_type {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, support_cache_cmd> : std::true_type {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, solve_limited_cmd> : std::true_type {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, interrupt_cmd> : std::true_type {};
+
+    template <typename... SolverContexts>
+    struct supports<Portfolio_Context<SolverContexts...>, get_unsat_core_cmd>
+        : std::conjunction<supports<DirectSolver_Context<SolverContexts>, get_unsat_core_cmd>...> {};
+  }  // namespace features
+
+  template <typename... SolverContexts>
+  bool solve(Portfolio_Context<SolverContexts...> &ctx) {
+    return ctx.solve();
+  }
+
+  template <typename... SolverContexts>
+  result_wrapper read_value(Portfolio_Context<SolverContexts...> &ctx,
+                            typename Portfolio_Context<SolverContexts...>::result_type const &var) {
+    return ctx.read_value(var);
+  }
+
+  template <typename... SolverContexts>
+  typename Portfolio_Context<SolverContexts...>::result_type evaluate(
+      Portfolio_Context<SolverContexts...> &, typename Portfolio_Context<SolverContexts...>::result_type r) {
+    return r;
+  }
+
+}  // namespace metaSMT
+
+//  vim: ft=cpp:ts=2:sw=2:expandtab
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "../API/Budget.hpp"
+#include "../API/Interrupt.hpp"
+#include "../API/UnsatCore.hpp"
+#include "../Features.hpp"
 #include "../result_wrapper.hpp"
 #include "../tags/Array.hpp"
 #include "../tags/QF_BV.hpp"
@@ -9,8 +13,12 @@ extern "C" {
 }
 
 #include <any>
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <list>
 #include <tuple>
+#include <vector>
 
 namespace metaSMT {
   namespace solver {
@@ -32,10 +40,11 @@ namespace metaSMT {
      public:
       typedef BoolectorNode *result_type;
 
-      Boolector() {
+      Boolector() : _interrupted(false), _unsat(false) {
         _btor = boolector_new();
         boolector_set_opt(_btor, BTOR_OPT_MODEL_GEN, 1);
         boolector_set_opt(_btor, BTOR_OPT_INCREMENTAL, 1);
+        boolector_set_term(_btor, &Boolector::_interrupt_requested, this);
       }
 
       ~Boolector() {
@@ -55,11 +64,52 @@ namespace metaSMT {
      public:
       void assertion(result_type e) { boolector_assert(_btor, e); }
 
-      void assumption(result_type e) { boolector_assume(_btor, e); }
+      void assumption(result_type e) {
+        boolector_assume(_btor, e);
+        _assumptions.push_back(e);
+      }
 
       unsigned get_bv_width(result_type const &e) { return boolector_get_width(_btor, e); }
 
-      bool solve() { return boolector_sat(_btor) == BOOLECTOR_SAT; }
+      bool solve() {
+        _interrupted = false;
+        return sat(-1) == BOOLECTOR_SAT;
+      }
+
+      void command(interrupt_cmd const &) { _interrupted = true; }
+
+      /**
+       * The conflict limit is passed as SAT limit to boolector_limited_sat,
+       * the timeout is checked by the termination callback. There is no
+       * propagation limit.
+       **/
+      tribool command(solve_limited_cmd const &, budget const &b) {
+        _interrupted = false;
+        _deadline.start(b.timeout);
+        int32_t const sat_limit =
+            b.conflicts ? static_cast<int32_t>(std::min<uint64_t>(b.conflicts, std::numeric_limits<int32_t>::max())) : -1;
+        int32_t const r = sat(sat_limit);
+        _deadline.clear();
+        switch (r) {
+          case BOOLECTOR_SAT:
+            return true;
+          case BOOLECTOR_UNSAT:
+            return false;
+          default:
+            return indeterminate;
+        }
+      }
+
+      std::vector<unsigned> command(get_unsat_core_cmd const &) {
+        std::vector<unsigned> core;
+        if (!_unsat) return core;
+        for (unsigned i = 0; i < _last_assumptions.size(); ++i) {
+          if (boolector_failed(_btor, _last_assumptions[i])) {
+            core.push_back(i);
+          }
+        }
+        return core;
+      }
 
       //#ifdef metaSMT_BOOLECTOR_2_NEW_API
 
@@ -392,12 +442,42 @@ namespace metaSMT {
       void command(Boolector const &) {}
 
      protected:
+      int32_t sat(int32_t sat_limit) {
+        _last_assumptions.swap(_assumptions);
+        _assumptions.clear();
+        int32_t const r = sat_limit < 0 ? boolector_sat(_btor) : boolector_limited_sat(_btor, -1, sat_limit);
+        _unsat = (r == BOOLECTOR_UNSAT);
+        return r;
+      }
+
+      static int32_t _interrupt_requested(void *self) {
+        Boolector *btor = static_cast<Boolector *>(self);
+        return btor->_interrupted || btor->_deadline.expired();
+      }
+
       Btor *_btor;
+      std::atomic<bool> _interrupted;
+      metaSMT::detail::deadline _deadline;
+
+      std::vector<result_type> _assumptions;
+      std::vector<result_type> _last_assumptions;
+      bool _unsat;
     };
 
     /**@}*/
 
   }  // namespace solver
+
+  namespace features {
+    template <>
+    struct supports<solver::Boolector, interrupt_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Boolector, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Boolector, get_unsat_core_cmd> : std::true_type {};
+  }  // namespace features
 }  // namespace metaSMT
 
 //  vim: ft=cpp:ts=2:sw=2:expandtab
@@ -2,13 +2,44 @@
 
 #include <cuddObj.hh>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "../API/AllSolutions.hpp"
+#include "../API/Budget.hpp"
+#include "../API/VariableOrder.hpp"
+#include "../Features.hpp"
 #include "../result_wrapper.hpp"
+#include "../support/Options.hpp"
 #include "../tags/Logic.hpp"
 
 namespace metaSMT {
   namespace solver {
     namespace predtags = ::metaSMT::logic::tag;
 
+    /**
+     * BDD backend based on CUDD. The options "cudd.unique_slots" and
+     * "cudd.cache_slots" size the tables of the manager, they take effect
+     * while no variable exists. "cudd.max_memory" (bytes),
+     * "cudd.max_cache_hard" and "cudd.loose_up_to" map to the CUDD
+     * functions of the same names.
+     *
+     * When CUDD runs out of memory the context is exhausted: the
+     * constraints built from then on are meaningless, solve_limited_cmd
+     * returns indeterminate, solve() and the creation of variables throw.
+     *
+     * With "cudd.conjunction" = "partitioned" the assertions are kept as a
+     * list and conjoined on solve(): parts whose supports are connected
+     * are conjoined smallest first, each with the part sharing most of its
+     * support, while the result stays within a node limit. solve() picks
+     * the solution per connected component and never conjoins unrelated
+     * components. The default "eager" conjoins each assertion immediately.
+     */
     class CUDD_Context {
       struct CUDDAssertion : public std::runtime_error {
         CUDDAssertion(const char* what) : std::runtime_error(what) {}
@@ -17,18 +48,27 @@ namespace metaSMT {
       static void _cudd_error(std::string what) { throw CUDDAssertion(what.c_str()); }
 
      public:
-      CUDD_Context() {
-        _manager.setHandler(&CUDD_Context::_cudd_error);
-        _manager.AutodynEnable(CUDD_REORDER_SIFT);
-        _assertions = _manager.bddOne();
-        _assumptions = _manager.bddOne();
+      CUDD_Context()
+          : _order(option::variable_order::creation),
+            _conjunction(option::conjunction_mode::eager),
+            _reordering(option::reordering_method::sift),
+            _reorders(0),
+            _exhausted(false),
+            _interleaved(false) {
+        setup_manager();
       }
 
       typedef BDD result_type;
 
-      void assertion(result_type e) { _assertions &= e; }
+      void assertion(result_type e) {
+        if (_conjunction == option::conjunction_mode::eager) {
+          guard([&] { return _assertions &= e; });
+        } else if (e != _manager.bddOne()) {
+          _partitions.push_back(e);
+        }
+      }
 
-      void assumption(result_type e) { _assumptions &= e; }
+      void assumption(result_type e) { guard([&] { return _assumptions &= e; }); }
 
       void writeDotFile(std::string const& filename) {
 #ifdef _CPPCUDD  // this is defined in CUDD 2.4.x but not in 3.0.0
@@ -36,8 +76,10 @@ namespace metaSMT {
 #else
         std::vector<BDD> bvec(3, _manager.bddOne());
 #endif
-        bvec[0] = _assertions & _assumptions;
-        bvec[1] = _assertions;
+        bvec[0] = conjunction();
+        bvec[1] = _manager.bddOne();
+        for (result_type const& c : schedule(_partitions)) bvec[1] &= c;
+        bvec[1] &= _assertions;
         bvec[2] = _assumptions;
         char comple[] = "complete";
         char assert[] = "assertions";
@@ -53,23 +95,24 @@ namespace metaSMT {
       }
 
       bool solve() {
+        check_exhausted();
         _solution.clear();
-        BDD complete = _assertions & _assumptions;
-        bool ret = complete != _manager.bddZero();
+        std::vector<result_type> const parts = components();
+        bool ret = parts.empty() || parts.front() != _manager.bddZero();
         _assumptions = _manager.bddOne();
         if (ret) {
           unsigned size = _manager.ReadSize();
-          char* buf = new char[size];
-          complete.PickOneCube(buf);
-          _solution.resize(size);
-          for (unsigned i = 0; i < size; ++i) {
-            if (buf[i] == 2) {
-              _solution[i] = indeterminate;
-            } else {
-              _solution[i] = buf[i];
+          std::vector<char> buf(size);
+          _solution.assign(size, indeterminate);
+          // the parts have disjoint supports
+          for (result_type const& part : parts) {
+            part.PickOneCube(buf.data());
+            for (unsigned i = 0; i < size; ++i) {
+              if (buf[i] != 2) {
+                _solution[i] = buf[i];
+              }
             }
           }
-          delete[] buf;
         }
         return ret;
       }
@@ -79,35 +122,57 @@ namespace metaSMT {
         return result_wrapper(_solution[var.NodeReadIndex()]);
       }
 
-      result_type operator()(predtags::var_tag const&, std::any) { return _manager.bddVar(); }
+      /// throws if the context is exhausted, the result is always a variable
+      result_type operator()(predtags::var_tag const&, std::any) {
+        check_exhausted();
+        result_type const var = guard([&] { return _manager.bddVar(); });
+        check_exhausted();
+        return var;
+      }
 
       result_type operator()(predtags::false_tag, std::any) { return _manager.bddZero(); }
 
       result_type operator()(predtags::true_tag, std::any) { return _manager.bddOne(); }
 
-      result_type operator()(predtags::not_tag, result_type a) { return !a; }
+      result_type operator()(predtags::not_tag, result_type a) { return guard([&] { return !a; }); }
 
-      result_type operator()(predtags::equal_tag, result_type a, result_type b) { return !(a ^ b); }
+      result_type operator()(predtags::equal_tag, result_type a, result_type b) {
+        return guard([&] { return !(a ^ b); });
+      }
 
-      result_type operator()(predtags::nequal_tag, result_type a, result_type b) { return a ^ b; }
+      result_type operator()(predtags::nequal_tag, result_type a, result_type b) {
+        return guard([&] { return a ^ b; });
+      }
 
-      result_type operator()(predtags::and_tag, result_type a, result_type b) { return a & b; }
+      result_type operator()(predtags::and_tag, result_type a, result_type b) { return guard([&] { return a & b; }); }
 
-      result_type operator()(predtags::nand_tag, result_type a, result_type b) { return !(a & b); }
+      result_type operator()(predtags::nand_tag, result_type a, result_type b) {
+        return guard([&] { return !(a & b); });
+      }
 
-      result_type operator()(predtags::xor_tag, result_type a, result_type b) { return a ^ b; }
+      result_type operator()(predtags::xor_tag, result_type a, result_type b) { return guard([&] { return a ^ b; }); }
 
-      result_type operator()(predtags::xnor_tag, result_type a, result_type b) { return !(a ^ b); }
+      result_type operator()(predtags::xnor_tag, result_type a, result_type b) {
+        return guard([&] { return !(a ^ b); });
+      }
 
-      result_type operator()(predtags::implies_tag, result_type a, result_type b) { return !a | b; }
+      result_type operator()(predtags::implies_tag, result_type a, result_type b) {
+        return guard([&] { return !a | b; });
+      }
 
-      result_type operator()(predtags::or_tag, result_type a, result_type b) { return a | b; }
+      result_type operator()(predtags::or_tag, result_type a, result_type b) { return guard([&] { return a | b; }); }
 
-      result_type operator()(predtags::nor_tag, result_type a, result_type b) { return !(a | b); }
+      result_type operator()(predtags::nor_tag, result_type a, result_type b) {
+        return guard([&] { return !(a | b); });
+      }
 
-      result_type operator()(predtags::distinct_tag, result_type a, result_type b) { return a ^ b; }
+      result_type operator()(predtags::distinct_tag, result_type a, result_type b) {
+        return guard([&] { return a ^ b; });
+      }
 
-      result_type operator()(predtags::ite_tag, result_type a, result_type b, result_type c) { return a.Ite(b, c); }
+      result_type operator()(predtags::ite_tag, result_type a, result_type b, result_type c) {
+        return guard([&] { return a.Ite(b, c); });
+      }
 
       ////////////////////////
       // Fallback operators //
@@ -137,17 +202,552 @@ namespace metaSMT {
         return _manager.bddZero();
       }
 
+      void command(setup_option_map_cmd const&, Options const& opt) {
+        option::Typed const& t = *opt.typed;
+        if ((t.cudd_unique_slots || t.cudd_cache_slots) && _manager.ReadSize() == 0) {
+          // the table sizes are fixed at construction
+          _assertions = BDD();
+          _assumptions = BDD();
+          _partitions.clear();
+          _manager = Cudd(0, 0, t.cudd_unique_slots ? *t.cudd_unique_slots : CUDD_UNIQUE_SLOTS,
+                          t.cudd_cache_slots ? *t.cudd_cache_slots : CUDD_CACHE_SLOTS,
+                          t.cudd_max_memory ? *t.cudd_max_memory : 0);
+          setup_manager();
+        }
+        if (t.cudd_max_memory) Cudd_SetMaxMemory(_manager.getManager(), *t.cudd_max_memory);
+        if (t.cudd_max_cache_hard) Cudd_SetMaxCacheHard(_manager.getManager(), *t.cudd_max_cache_hard);
+        if (t.cudd_loose_up_to) Cudd_SetLooseUpTo(_manager.getManager(), *t.cudd_loose_up_to);
+
+        option::conjunction_mode const conjunction = opt.get(option::conjunction());
+        if (conjunction != _conjunction) {
+          if (conjunction == option::conjunction_mode::partitioned) {
+            if (_assertions != _manager.bddOne()) _partitions.push_back(_assertions);
+            _assertions = _manager.bddOne();
+          } else {
+            for (result_type const& c : schedule(_partitions)) guard([&] { return _assertions &= c; });
+            _partitions.clear();
+          }
+          _conjunction = conjunction;
+        }
+
+        _order = opt.get(option::order());
+        _reordering = opt.get(option::reordering());
+        if (_reordering == option::reordering_method::none) {
+          _manager.AutodynDisable();
+        } else {
+          _manager.AutodynEnable(method());
+        }
+      }
+
+      /**
+       * With "cudd.order" = "interleave" moves each variable of b directly
+       * below the variable at the same position of a, unless an earlier
+       * hint placed it already. The moves are collected and applied by one
+       * shuffle on the next solve or reorder. With "force" records the
+       * positions as hyperedges. Elements that are no variables are skipped.
+       */
+      void command(order_hint_cmd const&, std::vector<result_type> const& a, std::vector<result_type> const& b) {
+        if (_order == option::variable_order::creation) return;
+
+        std::vector<int> xs, ys;
+        for (unsigned i = 0; i < a.size() && i < b.size(); ++i) {
+          int const x = variable_index(a[i]);
+          int const y = variable_index(b[i]);
+          if (x >= 0 && y >= 0 && x != y) {
+            xs.push_back(x);
+            ys.push_back(y);
+          }
+        }
+        if (xs.empty()) return;
+
+        if (_order == option::variable_order::force) {
+          for (unsigned i = 0; i < xs.size(); ++i) {
+            _hyperedges.push_back({xs[i], ys[i]});
+            if (i + 1 < xs.size()) {
+              // the carry or comparison chain to the next position
+              _hyperedges.push_back({xs[i], ys[i], xs[i + 1], ys[i + 1]});
+            }
+          }
+        } else {
+          interleave(xs, ys);
+        }
+      }
+
+      /**
+       * Enumerates the cubes of the conjunction with the other variables
+       * abstracted and expands the projected variables a cube leaves open.
+       * The other variables read as indeterminate. The elements of vars
+       * must be variables.
+       */
+      std::uint64_t command(for_each_solution_cmd const&, std::vector<result_type> const& vars,
+                            std::function<void()> const& f, std::uint64_t limit) {
+        check_exhausted();
+        result_type const complete = conjunction();
+        _assumptions = _manager.bddOne();
+
+        unsigned const size = _manager.ReadSize();
+        std::vector<bool> projected(size, false);
+        for (result_type const& v : vars) {
+          int const index = variable_index(v);
+          if (index < 0) {
+            assert(false && "projection onto a BDD that is no variable");
+            throw std::exception();
+          }
+          projected[index] = true;
+        }
+        result_type others = _manager.bddOne();
+        for (unsigned i = 0; i < size; ++i) {
+          if (!projected[i]) others = guard([&] { return others & _manager.bddVar(i); });
+        }
+        result_type const projection = guard([&] { return complete.ExistAbstract(others); });
+        check_exhausted();
+
+        _solution.assign(size, indeterminate);
+        std::uint64_t n = 0;
+        if (projection == _manager.bddZero()) return n;
+
+        int* cube;
+        CUDD_VALUE_TYPE value;
+        std::unique_ptr<DdGen, int (*)(DdGen*)> gen(
+            Cudd_FirstCube(_manager.getManager(), projection.getNode(), &cube, &value), &Cudd_GenFree);
+        for (; !Cudd_IsGenEmpty(gen.get()) && n < limit; Cudd_NextCube(gen.get(), &cube, &value)) {
+          std::vector<unsigned> open;
+          for (unsigned i = 0; i < size; ++i) {
+            if (!projected[i]) continue;
+            if (cube[i] == 2) {
+              open.push_back(i);
+            } else {
+              _solution[i] = bool(cube[i]);
+            }
+          }
+          // counts through the assignments of the open variables
+          std::vector<bool> values(open.size(), false);
+          for (bool more = true; more && n < limit; ++n) {
+            for (unsigned i = 0; i < open.size(); ++i) _solution[open[i]] = bool(values[i]);
+            f();
+            more = false;
+            for (unsigned i = 0; i < open.size() && !more; ++i) {
+              values[i] = !values[i];
+              more = values[i];
+            }
+          }
+        }
+        return n;
+      }
+
+      /// only the memory limit is enforced, the budget is ignored
+      tribool command(solve_limited_cmd const&, budget const&) {
+        return limited([this] { return CUDD_Context::solve(); });
+      }
+
+      void command(reorder_cmd const&) {
+        interleave();
+        if (_order == option::variable_order::force) {
+          force();
+        } else if (_reordering != option::reordering_method::none) {
+          Cudd_ReduceHeap(_manager.getManager(), method(), 0);
+          ++_reorders;
+        }
+      }
+
       /* pseudo command */
       void command(CUDD_Context const&){};
 
      protected:
+      /**
+       * Runs f, which builds a BDD. If CUDD runs out of memory, marks the
+       * context as exhausted and returns False instead. Exhausted contexts
+       * build no more BDDs.
+       */
+      template <typename F>
+      result_type guard(F f) {
+        if (!_exhausted) {
+          try {
+            return f();
+          } catch (CUDDAssertion const&) {
+            if (!memory_exhausted()) throw;
+          }
+        }
+        return _manager.bddZero();
+      }
+
+      /// solves with solve, indeterminate if the context is exhausted
+      template <typename Solve>
+      tribool limited(Solve solve) {
+        if (!_exhausted) {
+          try {
+            return solve();
+          } catch (CUDDAssertion const&) {
+            if (!memory_exhausted()) throw;
+          }
+        }
+        return indeterminate;
+      }
+
+      void check_exhausted() const {
+        if (_exhausted) {
+          throw CUDDAssertion("Out of memory.");
+        }
+      }
+
+      /// whether the last CUDD error is a memory error, marks the context as exhausted
+      bool memory_exhausted() {
+        Cudd_ErrorType const error = Cudd_ReadErrorCode(_manager.getManager());
+        if (error == CUDD_MEMORY_OUT || error == CUDD_MAX_MEM_EXCEEDED || error == CUDD_TOO_MANY_NODES) {
+          Cudd_ClearErrorCode(_manager.getManager());
+          _exhausted = true;
+        }
+        return _exhausted;
+      }
+
+      /**
+       * The assertions and assumptions as conjunctions with pairwise
+       * disjoint supports, a single False if they are unsatisfiable and
+       * none if they are valid. Partitioned assertions are conjoined and
+       * kept conjoined, the assumptions are not.
+       */
+      std::vector<result_type> components() {
+        interleave();
+        std::vector<result_type> parts;
+        if (_conjunction == option::conjunction_mode::eager) {
+          parts.push_back(guard([this] { return _assertions & _assumptions; }));
+        } else {
+          _partitions = schedule(_partitions);
+          parts = _partitions;
+          if (_assumptions != _manager.bddOne()) {
+            parts.push_back(_assumptions);
+            parts = schedule(parts);
+          }
+        }
+        check_exhausted();
+        return parts;
+      }
+
+      /// the conjunction of the assertions and assumptions
+      result_type conjunction() {
+        result_type complete = _manager.bddOne();
+        for (result_type const& c : components()) {
+          complete = guard([&] { return complete & c; });
+        }
+        check_exhausted();
+        return complete;
+      }
+
+      /// the index of e if it is a variable or its negation, -1 otherwise
+      int variable_index(result_type const& e) {
+        DdNode* node = Cudd_Regular(e.getNode());
+        DdNode* one = Cudd_ReadOne(_manager.getManager());
+        if (Cudd_IsConstant(node) || Cudd_T(node) != one || Cudd_E(node) != Cudd_Not(one)) {
+          return -1;
+        }
+        return Cudd_NodeReadIndex(node);
+      }
+
       Cudd _manager;
       BDD _assertions;
       BDD _assumptions;
       std::vector<tribool> _solution;
+      option::conjunction_mode _conjunction;
+      /// the assertions with "cudd.conjunction" = "partitioned"
+      std::vector<result_type> _partitions;
+      option::variable_order _order;
+      option::reordering_method _reordering;
+      /// number of reorderings issued by the context itself
+      unsigned _reorders;
+      bool _exhausted;
+
+     private:
+      void setup_manager() {
+        _manager.setHandler(&CUDD_Context::_cudd_error);
+        Cudd_RegisterOutOfMemoryCallback(_manager.getManager(), Cudd_OutOfMemSilent);
+        _manager.AutodynEnable(CUDD_REORDER_SIFT);
+        _assertions = _manager.bddOne();
+        _assumptions = _manager.bddOne();
+      }
+
+      /**
+       * Conjoins parts per connected component of their supports, see
+       * conjoin(). Returns the conjunctions of the components, or only
+       * False if one of them is False.
+       */
+      std::vector<result_type> schedule(std::vector<result_type> const& parts) {
+        // union-find over the variables
+        std::vector<int> parent(_manager.ReadSize());
+        for (unsigned v = 0; v < parent.size(); ++v) parent[v] = v;
+        auto find = [&parent](int v) {
+          while (parent[v] != v) v = parent[v] = parent[parent[v]];
+          return v;
+        };
+
+        std::vector<result_type> bdds;
+        std::vector<std::vector<int> > supports;
+        for (result_type const& part : parts) {
+          if (part == _manager.bddZero()) return {part};
+          if (part == _manager.bddOne()) continue;
+          bdds.push_back(part);
+          supports.push_back(support(part));
+          for (int v : supports.back()) parent[find(v)] = find(supports.back().front());
+        }
+
+        std::vector<result_type> result;
+        std::vector<int> root(bdds.size());
+        for (unsigned i = 0; i < bdds.size(); ++i) root[i] = find(supports[i].front());
+        std::vector<bool> done(bdds.size(), false);
+        for (unsigned i = 0; i < bdds.size(); ++i) {
+          if (done[i]) continue;
+          std::vector<result_type> component;
+          std::vector<std::vector<int> > component_supports;
+          for (unsigned j = i; j < bdds.size(); ++j) {
+            if (root[j] == root[i]) {
+              done[j] = true;
+              component.push_back(bdds[j]);
+              component_supports.push_back(supports[j]);
+            }
+          }
+          result_type const c = conjoin(component, component_supports);
+          if (c == _manager.bddZero()) return {c};
+          result.push_back(c);
+        }
+        return result;
+      }
+
+      /**
+       * Conjoins the smallest BDD with the one sharing most of its support
+       * until one is left. The conjunction is aborted if it exceeds twice
+       * the nodes of the operands and the partner sharing the next most
+       * variables is tried. If no partner stays within the limit, the
+       * partner sharing most variables is conjoined without limit.
+       */
+      result_type conjoin(std::vector<result_type>& bdds, std::vector<std::vector<int> >& supports) {
+        std::vector<unsigned> sizes;
+        for (result_type const& b : bdds) sizes.push_back(b.nodeCount());
+
+        while (bdds.size() > 1) {
+          unsigned const a = std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+          std::vector<unsigned> partners;
+          std::vector<unsigned> shared(bdds.size(), 0);
+          for (unsigned p = 0; p < bdds.size(); ++p) {
+            if (p == a) continue;
+            std::vector<int> common;
+            std::set_intersection(supports[a].begin(), supports[a].end(), supports[p].begin(), supports[p].end(),
+                                  std::back_inserter(common));
+            shared[p] = common.size();
+            if (shared[p] > 0) partners.push_back(p);
+          }
+          std::sort(partners.begin(), partners.end(), [&](unsigned x, unsigned y) {
+            return shared[x] != shared[y] ? shared[x] > shared[y] : sizes[x] < sizes[y];
+          });
+
+          result_type r;
+          unsigned p = partners.front();
+          for (unsigned candidate : partners) {
+            r = and_limit(bdds[a], bdds[candidate], 2 * (sizes[a] + sizes[candidate]));
+            if (r.getNode()) {
+              p = candidate;
+              break;
+            }
+          }
+          if (!r.getNode()) {
+            r = guard([&] { return bdds[a] & bdds[p]; });
+          }
+          if (r == _manager.bddZero()) return r;
+
+          std::vector<int> merged;
+          std::set_union(supports[a].begin(), supports[a].end(), supports[p].begin(), supports[p].end(),
+                         std::back_inserter(merged));
+          bdds[a] = r;
+          supports[a].swap(merged);
+          sizes[a] = r.nodeCount();
+          bdds[p] = bdds.back();
+          supports[p].swap(supports.back());
+          sizes[p] = sizes.back();
+          bdds.pop_back();
+          supports.pop_back();
+          sizes.pop_back();
+        }
+        return bdds.front();
+      }
+
+      /// f & g, or no BDD if more than limit new nodes are needed
+      result_type and_limit(result_type const& f, result_type const& g, unsigned limit) {
+        if (_exhausted) return _manager.bddZero();
+        DdManager* mgr = _manager.getManager();
+        DdNode* r = Cudd_bddAndLimit(mgr, f.getNode(), g.getNode(), limit);
+        if (r) return BDD(_manager, r);
+        if (Cudd_ReadErrorCode(mgr) == CUDD_TOO_MANY_NODES) {
+          Cudd_ClearErrorCode(mgr);
+        } else {
+          memory_exhausted();
+        }
+        return BDD();
+      }
+
+      /// the indices of the variables f depends on, in ascending order
+      std::vector<int> support(result_type const& f) {
+        int* index = Cudd_SupportIndex(_manager.getManager(), f.getNode());
+        std::vector<int> vars;
+        for (int v = 0; v < _manager.ReadSize(); ++v) {
+          if (index[v]) vars.push_back(v);
+        }
+        free(index);
+        return vars;
+      }
+
+      Cudd_ReorderingType method() const {
+        switch (_reordering) {
+          case option::reordering_method::sift_converge:
+            return CUDD_REORDER_SIFT_CONVERGE;
+          case option::reordering_method::symm_sift:
+            return CUDD_REORDER_SYMM_SIFT;
+          case option::reordering_method::group_sift:
+            return CUDD_REORDER_GROUP_SIFT;
+          case option::reordering_method::window:
+            return CUDD_REORDER_WINDOW3_CONV;
+          default:
+            return CUDD_REORDER_SIFT;
+        }
+      }
+
+      /// current order, the variable index per level
+      std::vector<int> levels() {
+        std::vector<int> order(_manager.ReadSize());
+        for (unsigned l = 0; l < order.size(); ++l) {
+          order[l] = Cudd_ReadInvPerm(_manager.getManager(), l);
+        }
+        return order;
+      }
+
+      void shuffle(std::vector<int>& order) {
+        if (order != levels()) {
+          Cudd_ShuffleHeap(_manager.getManager(), order.data());
+          ++_reorders;
+        }
+      }
+
+      /// records that each y follows its x, for the ys not placed by an earlier hint
+      void interleave(std::vector<int> const& xs, std::vector<int> const& ys) {
+        unsigned const size = _manager.ReadSize();
+        _placed.resize(size, false);
+        _follow.resize(size, -1);
+        for (unsigned i = 0; i < xs.size(); ++i) {
+          if (!_placed[ys[i]] && _follow[xs[i]] < 0) {
+            _follow[xs[i]] = ys[i];
+            _placed[xs[i]] = true;
+            _placed[ys[i]] = true;
+            _interleaved = true;
+          }
+        }
+      }
+
+      /// moves the recorded ys below their xs with one shuffle
+      void interleave() {
+        if (!_interleaved) return;
+        unsigned const size = _manager.ReadSize();
+        _follow.resize(size, -1);
+        std::vector<bool> moved(size, false);
+        for (int y : _follow) {
+          if (y >= 0) moved[y] = true;
+        }
+
+        std::vector<int> const current = levels();
+        std::vector<int> order;
+        order.reserve(size);
+        std::vector<bool> emitted(size, false);
+        for (unsigned pass = 0; pass < 2; ++pass) {
+          // the second pass emits the variables of cycles of follow
+          for (int v : current) {
+            if (emitted[v] || (pass == 0 && moved[v])) continue;
+            for (; v >= 0 && !emitted[v]; v = _follow[v]) {
+              emitted[v] = true;
+              order.push_back(v);
+            }
+          }
+        }
+        _follow.assign(size, -1);
+        _interleaved = false;
+        shuffle(order);
+      }
+
+      /**
+       * FORCE, Aloul, Markov and Sakallah, "FORCE: A Fast and Easy-To-
+       * Implement Variable-Ordering Heuristic", GLSVLSI 2003. Moves every
+       * variable to the mean center of gravity of its hyperedges until the
+       * total span of the hyperedges stops decreasing.
+       */
+      void force() {
+        unsigned const size = _manager.ReadSize();
+        std::vector<int> order = levels();
+        std::vector<double> position(size);
+        for (unsigned l = 0; l < size; ++l) position[order[l]] = l;
+
+        std::vector<int> best = order;
+        double best_span = span(position);
+        for (unsigned iteration = 0; iteration < 64; ++iteration) {
+          std::vector<double> sum(size, 0);
+          std::vector<unsigned> count(size, 0);
+          for (std::vector<int> const& edge : _hyperedges) {
+            double center = 0;
+            for (int v : edge) center += position[v];
+            center /= edge.size();
+            for (int v : edge) {
+              sum[v] += center;
+              ++count[v];
+            }
+          }
+          std::vector<double> target(size);
+          for (unsigned v = 0; v < size; ++v) {
+            target[v] = count[v] > 0 ? sum[v] / count[v] : position[v];
+          }
+          std::stable_sort(order.begin(), order.end(), [&target](int a, int b) { return target[a] < target[b]; });
+          for (unsigned l = 0; l < size; ++l) position[order[l]] = l;
+
+          double const s = span(position);
+          if (s >= best_span) break;
+          best_span = s;
+          best = order;
+        }
+        shuffle(best);
+      }
+
+      double span(std::vector<double> const& position) const {
+        double total = 0;
+        for (std::vector<int> const& edge : _hyperedges) {
+          double lo = position[edge.front()];
+          double hi = lo;
+          for (int v : edge) {
+            lo = std::min(lo, position[v]);
+            hi = std::max(hi, position[v]);
+          }
+          total += hi - lo;
+        }
+        return total;
+      }
+
+      std::vector<bool> _placed;
+      /// the variable to move below each variable on the next interleave(), -1 if none
+      std::vector<int> _follow;
+      bool _interleaved;
+      std::vector<std::vector<int> > _hyperedges;
     };
 
   }  // namespace solver
+
+  namespace features {
+    template <>
+    struct supports<solver::CUDD_Context, setup_option_map_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Context, order_hint_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Context, reorder_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Context, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Context, for_each_solution_cmd> : std::true_type {};
+  }  // namespace features
 }  // namespace metaSMT
 
 //  vim: ft=cpp:ts=2:sw=2:expandtab
@@ -1,133 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <limits>
 #include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "../API/LiteralWeights.hpp"
+#include "../API/ModelCount.hpp"
+#include "../API/Sample.hpp"
+#include "../Features.hpp"
+#include "../support/Options.hpp"
 #include "CUDD_Context.hpp"
 
 namespace metaSMT {
   namespace solver {
+    namespace cudd_distributed {
+      /// digits of the exact counts, base 2^32, least significant first
+      typedef std::uint32_t digit;
+
+      /// log2(2^a + 2^b)
+      inline double log_add(double a, double b) {
+        if (a < b) std::swap(a, b);
+        if (b == -std::numeric_limits<double>::infinity()) return a;
+        return a + std::log1p(std::exp2(b - a)) / std::log(2.0);
+      }
+
+      /// r += a * 2^shift, r and a have the given number of digits
+      inline void add_shifted(digit *r, digit const *a, unsigned shift, unsigned digits) {
+        unsigned const words = shift / 32;
+        unsigned const bits = shift % 32;
+        std::uint64_t carry = 0;
+        for (unsigned i = words; i < digits; ++i) {
+          std::uint64_t s = (std::uint64_t(a[i - words]) << bits) & 0xffffffffu;
+          if (bits > 0 && i > words) s |= a[i - words - 1] >> (32 - bits);
+          s += std::uint64_t(r[i]) + carry;
+          r[i] = digit(s);
+          carry = s >> 32;
+        }
+        assert(carry == 0 && "model count overflow");
+      }
+
+      inline bool less(digit const *a, digit const *b, unsigned digits) {
+        for (unsigned i = digits; i-- > 0;) {
+          if (a[i] != b[i]) return a[i] < b[i];
+        }
+        return false;
+      }
+
+      /// r = uniformly distributed in [0, bound), bound must not be zero
+      template <typename Generator>
+      void random_below(digit *r, digit const *bound, unsigned digits, Generator &gen) {
+        unsigned top = digits - 1;
+        while (bound[top] == 0) {
+          assert(top > 0 && "empty range");
+          --top;
+        }
+        digit mask = bound[top];
+        mask |= mask >> 1;
+        mask |= mask >> 2;
+        mask |= mask >> 4;
+        mask |= mask >> 8;
+        mask |= mask >> 16;
 
+        std::uniform_int_distribution<digit> rnd;
+        std::fill(r + top + 1, r + digits, 0);
+        do {
+          for (unsigned i = 0; i < top; ++i) r[i] = rnd(gen);
+          r[top] = rnd(gen) & mask;
+        } while (!less(r, bound, digits));
+      }
+
+      inline std::string decimal(std::vector<digit> n) {
+        std::string s;
+        bool zero;
+        do {
+          std::uint64_t rem = 0;
+          zero = true;
+          for (unsigned i = n.size(); i-- > 0;) {
+            std::uint64_t const cur = (rem << 32) | n[i];
+            n[i] = digit(cur / 1000000000u);
+            rem = cur % 1000000000u;
+            zero = zero && n[i] == 0;
+          }
+          for (unsigned k = 0; k < 9; ++k, rem /= 10) s.push_back(char('0' + rem % 10));
+        } while (!zero);
+
+        while (s.size() > 1 && s.back() == '0') s.pop_back();
+        std::reverse(s.begin(), s.end());
+        return s;
+      }
+    }  // namespace cudd_distributed
+
+    /**
+     * CUDD backend whose solve() picks each solution of the assertions and
+     * assumptions with the same probability. sample_cmd draws many of them
+     * at once, count_solutions_cmd returns their number. With literal
+     * weights, see API/LiteralWeights.hpp, the probabilities and the count
+     * are weighted instead.
+     *
+     * All count the solutions below every node of the BDD. The counts are
+     * cached per node in flat arrays and kept while the BDD, the variables
+     * and their order do not change. Depending on the option "counting"
+     * they are doubles in log-space or exact multi-precision numbers, see
+     * API/ModelCount.hpp.
+     */
     class CUDD_Distributed : public CUDD_Context {
+      typedef cudd_distributed::digit digit;
+
+      /// a cache entry, the slots of the children are those for true
+      struct node {
+        unsigned index;
+        unsigned then_slot;
+        unsigned else_slot;
+        unsigned then_skip;
+      };
+
+      /// literal weights of a variable, log2 of the weights
+      struct weight {
+        double log_true;
+        double log_false;
+        /// probability of true where unconstrained
+        double bias;
+      };
+
      public:
-      CUDD_Distributed() : CUDD_Context(), previous(_manager.bddZero()) { reset(); }
+      CUDD_Distributed()
+          : CUDD_Context(),
+            previous(_manager.bddZero()),
+            precision_(option::counting_precision::log_space),
+            size_(0),
+            reorderings_(0),
+            digits_(1),
+            weighted_(false) {
+        reset();
+      }
 
       bool solve() {
-        BDD complete = _assertions & _assumptions;
-        if (previous != complete) {
-          // std::cout << "resetting distribution cache" << std::endl;
-          reset();
-          previous = complete;
-        } else {
-          // std::cout << "keeping distribution cache" << std::endl;
-        }
+        check_exhausted();
+        BDD complete = conjunction();
         bool ret = complete != _manager.bddZero();
         _assumptions = _manager.bddOne();
-        // printDD(complete.getNode(),"BDD.dot");
         if (ret) {
+          update(complete);
           store_solution(complete.getNode());
         }
         return ret;
       }
 
-     private:
-      std::map<DdNode *, unsigned> map_0;
-      std::map<DdNode *, unsigned> map_1;
+      solution_count command(count_solutions_cmd const &) {
+        check_exhausted();
+        BDD complete = conjunction();
+        _assumptions = _manager.bddOne();
+        update(complete);
 
-      void reset() {
-        map_0.clear();
-        map_1.clear();
+        DdNode *root = complete.getNode();
+        unsigned const s = slot(root, true);
+        // the variables above the root are free
+        unsigned const above = level(root);
 
-        map_0[_manager.bddZero().getNode()] = 1;
-        map_1[_manager.bddZero().getNode()] = 0;
-        map_0[_manager.bddOne().getNode()] = 0;
-        map_1[_manager.bddOne().getNode()] = 1;
+        solution_count c;
+        c.log2 = log_[s] + free_[above];
+        if (precision_ == option::counting_precision::exact) {
+          std::vector<digit> n(digits_, 0);
+          cudd_distributed::add_shifted(n.data(), &exact_[s * digits_], above, digits_);
+          c.exact = cudd_distributed::decimal(n);
+        }
+        return c;
       }
-      unsigned distance(DdNode *parent, DdNode *child) {
-        int i_1 = Cudd_ReadPerm(_manager.getManager(), Cudd_NodeReadIndex(parent));
-        int i_2 = (Cudd_IsConstant(child)) ? _manager.ReadSize()
-                                           : Cudd_ReadPerm(_manager.getManager(), Cudd_NodeReadIndex(child));
-        return i_2 - i_1;
+
+      bool command(sample_cmd const &, unsigned n, sample_matrix &out, unsigned threads) {
+        check_exhausted();
+        BDD complete = conjunction();
+        _assumptions = _manager.bddOne();
+        unsigned const size = _manager.ReadSize();
+        if (complete == _manager.bddZero()) {
+          out.resize(0, size);
+          return false;
+        }
+        update(complete);
+        // computes all entries before the threads only read them
+        unsigned const s = slot(complete.getNode(), true);
+        out.resize(n, size);
+
+        auto draw = [this, s, size, &out](unsigned begin, unsigned end, std::mt19937 &rng) {
+          std::vector<digit> scratch(2 * digits_);
+          std::uniform_int_distribution<std::uint64_t> bits;
+          for (unsigned r = begin; r < end; ++r) {
+            std::uint64_t *row = out.row(r);
+            if (weighted_) {
+              std::fill(row, row + out.words(), 0);
+              for (unsigned i = 0; i < size; ++i) {
+                std::bernoulli_distribution coin(weights_[i].bias);
+                if (coin(rng)) row[i / 64] |= std::uint64_t(1) << (i % 64);
+              }
+            } else {
+              for (unsigned w = 0; w < out.words(); ++w) row[w] = bits(rng);
+              if (size % 64 != 0) row[out.words() - 1] &= (std::uint64_t(1) << (size % 64)) - 1;
+            }
+            walk(s, rng, scratch, [row](unsigned i, bool value) {
+              std::uint64_t const bit = std::uint64_t(1) << (i % 64);
+              row[i / 64] = value ? row[i / 64] | bit : row[i / 64] & ~bit;
+            });
+          }
+        };
+
+        if (threads <= 1) {
+          draw(0, n, gen);
+        } else {
+          std::vector<std::mt19937> streams;
+          streams.reserve(threads);
+          for (unsigned t = 0; t < threads; ++t) {
+            std::seed_seq seed{std::uint32_t(gen()), std::uint32_t(gen()), std::uint32_t(t)};
+            streams.emplace_back(seed);
+          }
+          std::vector<std::thread> workers;
+          for (unsigned t = 0; t < threads; ++t) {
+            unsigned const begin = std::uint64_t(n) * t / threads;
+            unsigned const end = std::uint64_t(n) * (t + 1) / threads;
+            workers.emplace_back(draw, begin, end, std::ref(streams[t]));
+          }
+          for (std::thread &w : workers) w.join();
+        }
+        return true;
       }
 
-      unsigned skipped(DdNode *parent, DdNode *child) {
-        unsigned t = distance(parent, child);
-        if (t > 0)
-          return t - 1;
-        else
-          return 0;
+      bool command(sample_cmd const &, unsigned n, std::function<void()> const &f) {
+        check_exhausted();
+        BDD complete = conjunction();
+        _assumptions = _manager.bddOne();
+        if (complete == _manager.bddZero()) {
+          return false;
+        }
+        update(complete);
+        for (unsigned i = 0; i < n; ++i) {
+          store_solution(complete.getNode());
+          f();
+        }
+        return true;
       }
 
-      unsigned count_0(DdNode *root) {
-        if (Cudd_IsComplement(root)) {
-          DdNode *comp = Cudd_Regular(root);
-          return count_1(comp);
+      /// var must be a variable or its negation
+      void command(literal_weight_cmd const &, result_type var, double w_true, double w_false) {
+        int const index = variable_index(var);
+        if (index < 0) {
+          assert(false && "Literal weights require a variable");
+          throw std::exception();
         }
-        std::map<DdNode *, unsigned>::iterator iter = map_0.find(root);
-        if (iter != map_0.end()) {
-          return iter->second;
-        } else {
-          unsigned ret = count_0(Cudd_T(root)) * (1ull << skipped(root, Cudd_T(root)));
-          ret += count_0(Cudd_E(root)) * (1ull << skipped(root, Cudd_E(root)));
-          map_0.insert(std::make_pair(root, ret));
-          return ret;
+        assert(w_true >= 0 && w_false >= 0 && w_true + w_false > 0 && "Invalid literal weights");
+        if (Cudd_IsComplement(var.getNode())) {
+          std::swap(w_true, w_false);
         }
+
+        if (weights_.size() <= unsigned(index)) {
+          weights_.resize(_manager.ReadSize(), {0, 0, 0.5});
+        }
+        weights_[index] = {std::log2(w_true), std::log2(w_false), w_true / (w_true + w_false)};
+        weighted_ = true;
+        previous = _manager.bddZero();
+      }
+
+      /// only the memory limit is enforced, the budget is ignored
+      tribool command(solve_limited_cmd const &, budget const &) {
+        return limited([this] { return solve(); });
+      }
+
+      void command(setup_option_map_cmd const &, Options const &opt) {
+        // the base may replace the manager
+        previous = BDD();
+        index_.clear();
+        CUDD_Context::command(setup_option_map_cmd(), opt);
+        precision_ = opt.get(option::counting());
+        reset();
+        previous = _manager.bddZero();
       }
 
-      unsigned count_1(DdNode *root) {
-        if (Cudd_IsComplement(root)) {
-          DdNode *comp = Cudd_Regular(root);
-          return count_0(comp);
+      using CUDD_Context::command;
+
+     private:
+      /// resets the counts if the BDD, the variables or their order changed
+      void update(BDD const &complete) {
+        if (weighted_ && precision_ == option::counting_precision::exact) {
+          assert(false && "Literal weights require log_space counting");
+          throw std::exception();
+        }
+        if (previous != complete || size_ != unsigned(_manager.ReadSize()) || reorderings_ != reorderings()) {
+          reset();
+          previous = complete;
         }
-        std::map<DdNode *, unsigned>::iterator iter = map_1.find(root);
+      }
 
-        if (iter != map_1.end()) {
-          return iter->second;
-        } else {
-          unsigned ret = count_1(Cudd_T(root)) * (1ull << skipped(root, Cudd_T(root)));
-          ret += count_1(Cudd_E(root)) * (1ull << skipped(root, Cudd_E(root)));
+      void reset() {
+        index_.clear();
+        nodes_.clear();
+        log_.clear();
+        then_.clear();
+        exact_.clear();
+        size_ = _manager.ReadSize();
+        reorderings_ = reorderings();
+        // counts range up to 2^size_
+        digits_ = size_ / 32 + 1;
 
-          map_1.insert(std::make_pair(root, ret));
-          return ret;
+        weights_.resize(size_, {0, 0, 0.5});
+        free_.assign(size_ + 1, 0);
+        for (unsigned l = 0; l < size_; ++l) {
+          weight const &w = weights_[Cudd_ReadInvPerm(_manager.getManager(), l)];
+          free_[l + 1] = free_[l] + cudd_distributed::log_add(w.log_true, w.log_false);
+        }
+
+        // the constant one has one solution for true, none for false
+        index_.emplace(_manager.bddOne().getNode(), 0);
+        nodes_.push_back({CUDD_CONST_INDEX, 0, 0, 0});
+        log_.push_back(0);
+        log_.push_back(-std::numeric_limits<double>::infinity());
+        then_.assign(2, 0);
+        if (precision_ == option::counting_precision::exact) {
+          exact_.assign(2 * digits_, 0);
+          exact_[0] = 1;
         }
       }
 
-      void store_solution(DdNode *root) {
-        // clear solution
-        unsigned size = _manager.ReadSize();
-        std::vector<tribool>(size, indeterminate).swap(_solution);
+      /// changes whenever the variable order changed
+      unsigned reorderings() { return Cudd_ReadReorderings(_manager.getManager()) + _reorders; }
 
-        bool negated = false;
+      unsigned level(DdNode *node) {
+        return Cudd_IsConstant(node) ? _manager.ReadSize()
+                                     : Cudd_ReadPerm(_manager.getManager(), Cudd_NodeReadIndex(node));
+      }
 
-        while (!Cudd_IsConstant(root)) {
-          // std::cout << "chosing for v" << root->index << " (negated: " << negated << ")" << std::endl;
+      unsigned skipped(DdNode *parent, DdNode *child) { return level(child) - level(parent) - 1; }
 
-          unsigned cnt_r = 0;
-          unsigned cnt_t = 0;
-          negated ^= Cudd_IsComplement(root);
-          root = Cudd_Regular(root);
-          DdNode *child = Cudd_T(root);
-          if (negated) {
-            cnt_r = count_0(root);
-            cnt_t = count_0(child) << skipped(root, child);
-          } else {
-            cnt_r = count_1(root);
-            cnt_t = count_1(child) << skipped(root, child);
-          }
+      /**
+       * The position of the count of assignments to the variables from the
+       * level of node downwards that evaluate node to value. The count for
+       * !value is at slot ^ 1.
+       */
+      unsigned slot(DdNode *node, bool value) {
+        return 2 * entry(Cudd_Regular(node)) + (value != bool(Cudd_IsComplement(node)) ? 0 : 1);
+      }
 
-          // std::cout << "count: " << cnt_r << " " << cnt_t << std::endl;
+      /// the cache index of the regular node, computed if not cached yet
+      unsigned entry(DdNode *node) {
+        std::unordered_map<DdNode *, unsigned>::const_iterator it = index_.find(node);
+        if (it != index_.end()) {
+          return it->second;
+        }
+
+        DdNode *t = Cudd_T(node);
+        DdNode *e = Cudd_E(node);
+        unsigned const s_t = slot(t, true);
+        unsigned const s_e = slot(e, true);
+        unsigned const k_t = skipped(node, t);
+        unsigned const k_e = skipped(node, e);
+        // log2 of the weight of the skipped variables, k_t and k_e unless weighted
+        unsigned const l = level(node) + 1;
+        double const f_t = free_[level(t)] - free_[l];
+        double const f_e = free_[level(e)] - free_[l];
+        weight const &w = weights_[Cudd_NodeReadIndex(node)];
 
-          std::uniform_int_distribution<unsigned> rnd(0, cnt_r - 1);
-          unsigned select = rnd(gen);
-          if (select < cnt_t) {
-            // std::cout << "v" << root->index << " = 1" << std::endl;
-            _solution[Cudd_NodeReadIndex(root)] = true;
-            root = Cudd_T(root);
+        unsigned const i = index_.size();
+        index_.emplace(node, i);
+        nodes_.push_back({Cudd_NodeReadIndex(node), s_t, s_e, k_t});
+        for (unsigned v = 0; v < 2; ++v) {
+          double const then_weight = w.log_true + log_[s_t ^ v] + f_t;
+          double const sum = cudd_distributed::log_add(then_weight, w.log_false + log_[s_e ^ v] + f_e);
+          log_.push_back(sum);
+          then_.push_back(sum == -std::numeric_limits<double>::infinity() ? 0 : std::exp2(then_weight - sum));
+        }
+        if (precision_ == option::counting_precision::exact) {
+          exact_.resize(exact_.size() + 2 * digits_, 0);
+          for (unsigned v = 0; v < 2; ++v) {
+            digit *r = &exact_[(2 * i + v) * digits_];
+            cudd_distributed::add_shifted(r, &exact_[(s_t ^ v) * digits_], k_t, digits_);
+            cudd_distributed::add_shifted(r, &exact_[(s_e ^ v) * digits_], k_e, digits_);
+          }
+        }
+        return i;
+      }
+
+      /**
+       * Draws the variables on a path from slot s to the constant one,
+       * calls assign(index, value) for each. Only reads the cache, the
+       * entries below s must exist. scratch holds 2 * digits_ digits.
+       */
+      template <typename Generator, typename Assign>
+      void walk(unsigned s, Generator &rng, std::vector<digit> &scratch, Assign assign) const {
+        while (s > 1) {
+          node const &n = nodes_[s / 2];
+          unsigned const v = s & 1;
+          bool then;
+          if (precision_ == option::counting_precision::exact) {
+            digit *then_count = scratch.data();
+            digit *select = scratch.data() + digits_;
+            std::fill(then_count, then_count + digits_, 0);
+            cudd_distributed::add_shifted(then_count, &exact_[(n.then_slot ^ v) * digits_], n.then_skip, digits_);
+            cudd_distributed::random_below(select, &exact_[s * digits_], digits_, rng);
+            then = cudd_distributed::less(select, then_count, digits_);
           } else {
-            // std::cout << "v" << root->index << " = 0" << std::endl;
-            _solution[Cudd_NodeReadIndex(root)] = false;
-            root = Cudd_E(root);
+            std::uniform_real_distribution<double> rnd(0, 1);
+            then = rnd(rng) < then_[s];
           }
+          assign(n.index, then);
+          s = (then ? n.then_slot : n.else_slot) ^ v;
         }
-        assert(Cudd_V(root) == 1);
+        assert(s == 0 && "sampled path does not satisfy the BDD");
+      }
+
+      void store_solution(DdNode *root) {
+        // variables off the chosen path are free, they get uniform values
+        unsigned size = _manager.ReadSize();
+        _solution.resize(size);
+        for (unsigned i = 0; i < size; ++i) {
+          std::bernoulli_distribution coin(weights_[i].bias);
+          _solution[i] = coin(gen);
+        }
+
+        scratch_.resize(2 * digits_);
+        walk(slot(root, true), gen, scratch_, [this](unsigned i, bool value) { _solution[i] = value; });
       }
 
       void printDD(DdNode *root, std::string fileName) {
@@ -149,7 +444,52 @@ namespace metaSMT {
 
      private:
       BDD previous;
+      option::counting_precision precision_;
+      unsigned size_;
+      unsigned reorderings_;
+      unsigned digits_;
+      std::unordered_map<DdNode *, unsigned> index_;
+      /// variable and children per cache entry
+      std::vector<node> nodes_;
+      /// log2 of the counts, true and false per cache entry
+      std::vector<double> log_;
+      /// probability of the then-branch, laid out as log_
+      std::vector<double> then_;
+      /// literal weights per variable index
+      std::vector<weight> weights_;
+      bool weighted_;
+      /// log2 of the weight of all assignments to the variables above a level
+      std::vector<double> free_;
+      /// exact counts, digits_ digits each, laid out as log_
+      std::vector<digit> exact_;
+      std::vector<digit> scratch_;
     };  // class CUDD_Distribuded
 
   }  //  namespace solver
+
+  namespace features {
+    template <>
+    struct supports<solver::CUDD_Distributed, count_solutions_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, setup_option_map_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, sample_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, literal_weight_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, order_hint_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, reorder_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::CUDD_Distributed, for_each_solution_cmd> : std::true_type {};
+  }  // namespace features
 }  // namespace metaSMT
@@ -0,0 +1,496 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../API/Budget.hpp"
+#include "../API/Interrupt.hpp"
+#include "../Features.hpp"
+#include "../result_wrapper.hpp"
+#include "../tags/SAT.hpp"
+#include "SAT_Commands.hpp"
+
+namespace metaSMT {
+
+  /**
+   * @brief configuration of the cube-and-conquer solver
+   *
+   * A value of zero selects the default.
+   **/
+  struct cube_config {
+    cube_config() : threads(0), depth(0), share_learnts(true), share_size(2), probe_conflicts(0) {}
+
+    /// number of worker threads, default: hardware concurrency
+    unsigned threads;
+    /// number of split variables, i.e. 2^depth cubes, default: log2(threads) + 3
+    unsigned depth;
+    /// exchange short learnt clauses between the workers
+    bool share_learnts;
+    /// maximal length of exchanged clauses
+    unsigned share_size;
+    /// conflict limit of the probe run that ranks the split variables, default: 1000
+    unsigned probe_conflicts;
+  };
+
+  struct set_cube_config_cmd {
+    typedef void result_type;
+  };
+
+  namespace solver {
+
+    /**
+     * @ingroup Backend
+     * @class CubeAndConquer CubeAndConquer.hpp metaSMT/backend/CubeAndConquer.hpp
+     * @brief parallel cube-and-conquer driver for a SAT solver
+     *
+     *  Records the clause set and solves it with one SatSolver instance per
+     *  worker thread. The worker threads are started once and kept between
+     *  the calls. Each solve() splits the problem on the highest ranked
+     *  variables into cubes. A cube is solved as additional assumptions on
+     *  a worker; idle workers steal cubes from the other queues. The first
+     *  satisfiable cube decides the result and stops the other workers, the
+     *  problem is unsatisfiable when all cubes are.
+     *
+     *  If the SatSolver supports var_activity_cmd, the first worker probes
+     *  the problem with a small conflict limit before the split. A definite
+     *  probe result is returned directly; otherwise the split variables are
+     *  ranked by the branching activity the workers accumulated so far,
+     *  which approximates a lookahead on the variables that cause the
+     *  conflicts. Ties and solvers without activities fall back to the
+     *  static Jeroslow-Wang score of the occurrences. Only frontend
+     *  variables (as reported by SAT_Clause via input_var_cmd) are
+     *  considered, unless there are none.
+     *
+     *  If the SatSolver supports export_learnts_cmd, short learnt clauses
+     *  are exchanged between the workers after each cube.
+     *
+     * \code
+     *  DirectSolver_Context< BitBlast< SAT_Clause< solver::CubeAndConquer< solver::MiniSAT > > > > ctx;
+     *
+     *  cube_config cfg;
+     *  cfg.threads = 8;
+     *  ctx.command(set_cube_config_cmd(), cfg);
+     * \endcode
+     **/
+    template <typename SatSolver>
+    class CubeAndConquer {
+     public:
+      typedef SAT::tag::lit_tag result_type;
+
+      CubeAndConquer() : stop_(false), winner_(-1), running_(0), generation_(0), shutdown_(false), unknown_(false) {}
+
+      ~CubeAndConquer() { stop_threads(); }
+
+      void clause(std::vector<result_type> const& cls) {
+        clauses_.push_back(cls);
+        double const weight = 1.0 / static_cast<double>(1u << std::min<std::size_t>(cls.size(), 31));
+        for (result_type const& lit : cls) {
+          std::size_t const v = lit.var();
+          if (score_.size() <= v) score_.resize(v + 1, 0.0);
+          score_[v] += weight;
+        }
+      }
+
+      void assertion(result_type lit) { clause(std::vector<result_type>(1, lit)); }
+
+      void assumption(result_type lit) { assumptions_.push_back(lit); }
+
+      void command(input_var_cmd const&, result_type lit) { inputs_.push_back(lit.var()); }
+
+      void command(set_cube_config_cmd const&, cube_config const& cfg) { config_ = cfg; }
+
+      /// interrupts all workers except a winner, its model stays readable
+      void command(interrupt_cmd const&) {
+        stop_ = true;
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (std::size_t i = 0; i < workers_.size(); ++i) {
+          if (static_cast<int>(i) != winner_) interrupt_worker(*workers_[i]);
+        }
+      }
+
+      /**
+       * @throws std::runtime_error if a worker failed or the search was
+       *         interrupted before a definite answer
+       **/
+      bool solve() {
+        tribool const r = command(solve_limited_cmd(), budget());
+        if (indeterminate(r)) {
+          throw std::runtime_error("CubeAndConquer: no definite result");
+        }
+        return static_cast<bool>(r);
+      }
+
+      /**
+       * The timeout applies to the whole call, conflict and propagation
+       * limits apply to each cube.
+       **/
+      tribool command(solve_limited_cmd const&, budget const& b) {
+        stop_ = false;
+        winner_ = -1;
+        setup_workers();
+
+        tribool r = indeterminate;
+        {
+          metaSMT::detail::watchdog w(b.timeout, [this] { command(interrupt_cmd()); });
+          unsigned const depth = split_depth();
+          if (depth > 0) {
+            r = probe(b);
+          }
+          if (indeterminate(r) && !stop_) {
+            r = run_cubes(depth, b);
+          }
+        }
+
+        assumptions_.clear();
+        return r;
+      }
+
+      result_wrapper read_value(result_type lit) {
+        if (winner_ < 0) return result_wrapper('X');
+        return workers_[winner_]->solver.read_value(lit);
+      }
+
+     private:
+      struct Worker {
+        Worker() : synced(0), imported(0) {}
+
+        SatSolver solver;
+        std::size_t synced;
+        std::size_t imported;
+
+        std::mutex queue_mutex;
+        std::deque<std::size_t> queue;
+      };
+
+      unsigned num_threads() const {
+        unsigned n = config_.threads ? config_.threads : std::thread::hardware_concurrency();
+        return std::max(n, 1u);
+      }
+
+      /// (re)starts the worker threads when the number of threads changed
+      void setup_workers() {
+        unsigned const n = num_threads();
+        if (threads_.size() != n) {
+          stop_threads();
+          {
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            while (workers_.size() < n) {
+              workers_.emplace_back(new Worker());
+            }
+            workers_.resize(n);
+          }
+          threads_.reserve(n);
+          for (std::size_t i = 0; i < n; ++i) {
+            threads_.emplace_back(&CubeAndConquer::worker, this, i, generation_);
+          }
+        }
+        for (std::unique_ptr<Worker>& w : workers_) {
+          w->queue.clear();
+        }
+      }
+
+      void stop_threads() {
+        {
+          std::lock_guard<std::mutex> lock(done_mutex_);
+          shutdown_ = true;
+        }
+        job_cv_.notify_all();
+        for (std::thread& t : threads_) {
+          t.join();
+        }
+        threads_.clear();
+        shutdown_ = false;
+      }
+
+      unsigned split_depth() const {
+        unsigned depth = config_.depth;
+        if (depth == 0) {
+          unsigned const n = num_threads();
+          while ((1u << depth) < n) ++depth;
+          depth = n > 1 ? depth + 3 : 0;
+        }
+        return std::min(depth, 20u);
+      }
+
+      /**
+       * Solves the problem on the first worker with a small conflict limit,
+       * the search fills its activities for the ranking of the split
+       * variables. Without activities the probe is skipped.
+       **/
+      tribool probe(budget const& b) {
+        if constexpr (features::supports<SatSolver, var_activity_cmd>::value) {
+          Worker& w = *workers_[0];
+          sync_clauses(w);
+          import_learnts(w);
+          for (result_type const& lit : assumptions_) {
+            w.solver.assumption(lit);
+          }
+
+          budget probe_budget = b;
+          probe_budget.timeout = std::chrono::milliseconds(0);
+          unsigned const limit = config_.probe_conflicts ? config_.probe_conflicts : 1000;
+          if (!probe_budget.conflicts || probe_budget.conflicts > limit) probe_budget.conflicts = limit;
+
+          tribool r = indeterminate;
+          try {
+            r = solve_limited(w.solver, probe_budget);
+          } catch (std::exception const&) {
+            // the cubes decide
+          }
+          if (r) winner_ = 0;
+          export_learnts(w);
+          return r;
+        } else {
+          (void)b;
+          return indeterminate;
+        }
+      }
+
+      /// the branching activity summed over the workers, each normalized to [0,1]
+      std::vector<double> activities() {
+        std::vector<double> ret;
+        if constexpr (features::supports<SatSolver, var_activity_cmd>::value) {
+          for (std::unique_ptr<Worker>& w : workers_) {
+            std::vector<double> const act = w->solver.command(var_activity_cmd());
+            double const max = act.empty() ? 0.0 : *std::max_element(act.begin(), act.end());
+            if (max <= 0.0) continue;
+            if (ret.size() < act.size()) ret.resize(act.size(), 0.0);
+            for (std::size_t v = 0; v < act.size(); ++v) ret[v] += act[v] / max;
+          }
+        }
+        return ret;
+      }
+
+      /// the depth highest ranked variables, frontend variables preferred
+      std::vector<int> split_variables(unsigned depth) {
+        std::vector<int> candidates;
+        if (!inputs_.empty()) {
+          candidates.assign(inputs_.begin(), inputs_.end());
+        } else {
+          for (std::size_t v = 1; v < score_.size(); ++v) candidates.push_back(v);
+        }
+
+        std::vector<double> const act = activities();
+        auto rank = [this, &act](int v) {
+          std::size_t const i = v;
+          return std::make_pair(i < act.size() ? act[i] : 0.0, i < score_.size() ? score_[i] : 0.0);
+        };
+        std::size_t const k = std::min<std::size_t>(depth, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end(),
+                          [&rank](int a, int b) { return rank(a) > rank(b); });
+        candidates.resize(k);
+        return candidates;
+      }
+
+      /// distributes the cubes and waits until the workers finished them
+      tribool run_cubes(unsigned depth, budget const& b) {
+        split_ = split_variables(depth);
+        std::size_t const cubes = std::size_t(1) << split_.size();
+        for (std::size_t i = 0; i < cubes; ++i) {
+          workers_[i % workers_.size()]->queue.push_back(i);
+        }
+
+        cube_budget_ = b;
+        cube_budget_.timeout = std::chrono::milliseconds(0);
+        unknown_ = false;
+        {
+          std::lock_guard<std::mutex> lock(done_mutex_);
+          running_ = threads_.size();
+          ++generation_;
+        }
+        job_cv_.notify_all();
+        wait_for_workers();
+
+        if (winner_ >= 0) return true;
+        if (unknown_ || stop_) return indeterminate;
+        return false;
+      }
+
+      bool next_cube(std::size_t self, std::size_t& cube) {
+        {
+          Worker& w = *workers_[self];
+          std::lock_guard<std::mutex> lock(w.queue_mutex);
+          if (!w.queue.empty()) {
+            cube = w.queue.back();
+            w.queue.pop_back();
+            return true;
+          }
+        }
+        for (std::size_t i = 1; i < workers_.size(); ++i) {
+          Worker& victim = *workers_[(self + i) % workers_.size()];
+          std::lock_guard<std::mutex> lock(victim.queue_mutex);
+          if (!victim.queue.empty()) {
+            cube = victim.queue.front();
+            victim.queue.pop_front();
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /// an interrupt before a worker started its search is lost, repeat it
+      void wait_for_workers() {
+        std::unique_lock<std::mutex> lock(done_mutex_);
+        while (!done_cv_.wait_for(lock, std::chrono::milliseconds(10), [this] { return running_ == 0; })) {
+          if (stop_) {
+            lock.unlock();
+            command(interrupt_cmd());
+            lock.lock();
+          }
+        }
+      }
+
+      void worker(std::size_t self, unsigned seen) {
+        for (;;) {
+          {
+            std::unique_lock<std::mutex> lock(done_mutex_);
+            job_cv_.wait(lock, [this, seen] { return shutdown_ || generation_ != seen; });
+            if (shutdown_) return;
+            seen = generation_;
+          }
+
+          conquer(self);
+
+          {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            --running_;
+          }
+          done_cv_.notify_all();
+        }
+      }
+
+      void sync_clauses(Worker& w) {
+        for (; w.synced < clauses_.size(); ++w.synced) {
+          w.solver.clause(clauses_[w.synced]);
+        }
+      }
+
+      void conquer(std::size_t self) {
+        Worker& w = *workers_[self];
+        std::vector<int> const& split = split_;
+
+        sync_clauses(w);
+
+        std::size_t cube;
+        while (!stop_ && next_cube(self, cube)) {
+          import_learnts(w);
+
+          for (result_type const& lit : assumptions_) {
+            w.solver.assumption(lit);
+          }
+          for (std::size_t i = 0; i < split.size(); ++i) {
+            result_type lit = {(cube >> i) & 1 ? split[i] : -split[i]};
+            w.solver.assumption(lit);
+          }
+
+          tribool r = indeterminate;
+          try {
+            r = solve_limited(w.solver, cube_budget_);
+          } catch (std::exception const&) {
+            // treated as unknown
+          }
+
+          if (r) {
+            int expected = -1;
+            if (winner_.compare_exchange_strong(expected, static_cast<int>(self))) {
+              command(interrupt_cmd());
+            }
+            return;
+          }
+          if (indeterminate(r)) {
+            unknown_ = true;
+          }
+
+          export_learnts(w);
+        }
+      }
+
+      void interrupt_worker(Worker& w) {
+        if constexpr (features::supports<SatSolver, interrupt_cmd>::value) {
+          w.solver.command(interrupt_cmd());
+        }
+      }
+
+      void export_learnts(Worker& w) {
+        if constexpr (features::supports<SatSolver, export_learnts_cmd>::value) {
+          if (!config_.share_learnts) return;
+          export_learnts_cmd::result_type learnts = w.solver.command(export_learnts_cmd(), config_.share_size);
+
+          std::lock_guard<std::mutex> lock(shared_mutex_);
+          for (std::vector<result_type>& cls : learnts) {
+            std::vector<int> key(cls.size());
+            for (std::size_t i = 0; i < cls.size(); ++i) key[i] = cls[i].id;
+            std::sort(key.begin(), key.end());
+            if (shared_keys_.insert(key).second) {
+              shared_.push_back(cls);
+            }
+          }
+        }
+      }
+
+      void import_learnts(Worker& w) {
+        if (!config_.share_learnts) return;
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        for (; w.imported < shared_.size(); ++w.imported) {
+          w.solver.clause(shared_[w.imported]);
+        }
+      }
+
+      cube_config config_;
+
+      std::vector<std::vector<result_type> > clauses_;
+      std::vector<result_type> assumptions_;
+      std::vector<double> score_;
+      std::vector<int> inputs_;
+
+      std::mutex workers_mutex_;
+      std::vector<std::unique_ptr<Worker> > workers_;
+      std::atomic<bool> stop_;
+      std::atomic<int> winner_;
+
+      std::vector<std::thread> threads_;
+      std::mutex done_mutex_;
+      std::condition_variable job_cv_;
+      std::condition_variable done_cv_;
+      std::size_t running_;
+      unsigned generation_;
+      bool shutdown_;
+
+      /// the job of the current generation
+      std::vector<int> split_;
+      budget cube_budget_;
+      std::atomic<bool> unknown_;
+
+      std::mutex shared_mutex_;
+      std::vector<std::vector<result_type> > shared_;
+      std::set<std::vector<int> > shared_keys_;
+    };
+  }  // namespace solver
+
+  namespace features {
+    template <typename SatSolver>
+    struct supports<solver::CubeAndConquer<SatSolver>, input_var_cmd> : std::true_type {};
+
+    template <typename SatSolver>
+    struct supports<solver::CubeAndConquer<SatSolver>, set_cube_config_cmd> : std::true_type {};
+
+    template <typename SatSolver>
+    struct supports<solver::CubeAndConquer<SatSolver>, interrupt_cmd> : std::true_type {};
+
+    template <typename SatSolver>
+    struct supports<solver::CubeAndConquer<SatSolver>, solve_limited_cmd> : std::true_type {};
+  }  // namespace features
+}  // namespace metaSMT
+
+//  vim: ft=cpp:ts=2:sw=2:expandtab
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "../API/Budget.hpp"
+#include "../API/Interrupt.hpp"
+#include "../API/UnsatCore.hpp"
 #include "../Features.hpp"
 #include "../result_wrapper.hpp"
 #include "../tags/SAT.hpp"
@@ -7,9 +10,12 @@
 extern "C" {
 #include <lglib.h>
 }
+#include <algorithm>
 #include <any>
+#include <atomic>
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 namespace metaSMT {
@@ -24,7 +30,10 @@ namespace metaSMT {
      public:
       typedef SAT::tag::lit_tag result_type;
 
-      Lingeling() { m_solver = lglinit(); }
+      Lingeling() : m_interrupted(false), m_unsat(false) {
+        m_solver = lglinit();
+        lglseterm(m_solver, &Lingeling::_interrupt_requested, this);
+      }
 
       ~Lingeling() { lglrelease(m_solver); }
 
@@ -40,6 +49,8 @@ namespace metaSMT {
 
       void command(addclause_cmd const&, std::vector<result_type> const& cls) { clause(cls); }
 
+      void command(interrupt_cmd const&) { m_interrupted = true; }
+
       void assertion(result_type lit) { add(toLit(lit), 0); }
 
       void assumption(result_type lit) { m_buffered_assume_clauses.push_back(toLit(lit)); }
@@ -68,15 +79,18 @@ namespace metaSMT {
           lglassume(m_solver, lit);
         }
 
+        m_last_assumptions.swap(m_buffered_assume_clauses);
         m_buffered_assume_clauses.clear();
-        ;
       }
 
       bool solve() {
+        m_interrupted = false;
         flush_buffered_clauses();
         flush_buffered_assumptions();
 
-        switch (lglsat(m_solver)) {
+        int const r = lglsat(m_solver);
+        m_unsat = (r == LGL_UNSATISFIABLE);
+        switch (r) {
           case LGL_UNSATISFIABLE:
             return false;
           case LGL_SATISFIABLE:
@@ -88,6 +102,49 @@ namespace metaSMT {
         }
       }
 
+      /**
+       * Conflict and propagation limits map to the "clim" and "plim"
+       * options (plim counts thousands of propagations), the timeout is
+       * checked by the termination callback.
+       **/
+      tribool command(solve_limited_cmd const&, budget const& b) {
+        m_interrupted = false;
+        flush_buffered_clauses();
+        flush_buffered_assumptions();
+
+        m_deadline.start(b.timeout);
+        if (b.conflicts) lglsetopt(m_solver, "clim", to_limit(b.conflicts));
+        if (b.propagations) lglsetopt(m_solver, "plim", to_limit((b.propagations + 999) / 1000));
+
+        int const r = lglsat(m_solver);
+        m_unsat = (r == LGL_UNSATISFIABLE);
+
+        lglsetopt(m_solver, "clim", -1);
+        lglsetopt(m_solver, "plim", -1);
+        m_deadline.clear();
+        switch (r) {
+          case LGL_UNSATISFIABLE:
+            return false;
+          case LGL_SATISFIABLE:
+            return true;
+          case LGL_UNKNOWN:
+            return indeterminate;
+          default:
+            throw std::runtime_error("unsupported return type of Lingeling_sat ");
+        }
+      }
+
+      std::vector<unsigned> command(get_unsat_core_cmd const&) {
+        std::vector<unsigned> core;
+        if (!m_unsat) return core;
+        for (unsigned i = 0; i < m_last_assumptions.size(); ++i) {
+          if (lglfailed(m_solver, m_last_assumptions[i])) {
+            core.push_back(i);
+          }
+        }
+        return core;
+      }
+
       result_wrapper read_value(result_type lit) {
         switch (lglderef(m_solver, toLit(lit))) {
           case -1:
@@ -103,16 +160,38 @@ namespace metaSMT {
       }
 
      private:
+      static int _interrupt_requested(void* self) {
+        Lingeling* lgl = static_cast<Lingeling*>(self);
+        return lgl->m_interrupted || lgl->m_deadline.expired();
+      }
+
+      static int to_limit(uint64_t value) {
+        return static_cast<int>(std::min<uint64_t>(value, std::numeric_limits<int>::max()));
+      }
+
       LGL* m_solver;
+      std::atomic<bool> m_interrupted;
+      metaSMT::detail::deadline m_deadline;
 
       std::vector<int> m_buffered_clauses;
       std::vector<int> m_buffered_assume_clauses;
+      std::vector<int> m_last_assumptions;
+      bool m_unsat;
     };
   }  // namespace solver
 
   namespace features {
     template <>
     struct supports<solver::Lingeling, features::addclause_api> : std::true_type {};
+
+    template <>
+    struct supports<solver::Lingeling, interrupt_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Lingeling, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Lingeling, get_unsat_core_cmd> : std::true_type {};
   }  // namespace features
 
 }  // namespace metaSMT
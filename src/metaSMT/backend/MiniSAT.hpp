@@ -6,9 +6,14 @@
 #include <iostream>
 #include <vector>
 
+#include "../API/Budget.hpp"
+#include "../API/Interrupt.hpp"
+#include "../API/UnsatCore.hpp"
 #include "../Features.hpp"
 #include "../result_wrapper.hpp"
+#include "../support/Options.hpp"
 #include "../tags/SAT.hpp"
+#include "SAT_Commands.hpp"
 
 namespace metaSMT {
 
@@ -18,6 +23,35 @@ namespace metaSMT {
     struct addclause_api;
   }
   namespace solver {
+    namespace detail {
+      /**
+       * Minisat::Solver with access to the clauses and the activities. Uses
+       * the protected members of the Minisat master fetched by the build
+       * (clauses, learnts, ca, activity), which release 2.2.0 lays out
+       * differently.
+       */
+      class MiniSAT_Solver : public Minisat::Solver {
+       public:
+        double var_activity(Minisat::Var v) const { return activity[v]; }
+
+        template <typename F>
+        void for_each_clause(F f) {
+          for (int i = 0; i < clauses.size(); ++i) {
+            f(ca[clauses[i]]);
+          }
+        }
+
+        template <typename F>
+        void for_each_learnt(int max_size, F f) {
+          for (int i = 0; i < learnts.size(); ++i) {
+            Minisat::Clause& c = ca[learnts[i]];
+            if (c.size() <= max_size) {
+              f(c);
+            }
+          }
+        }
+      };
+    }  // namespace detail
 
     class MiniSAT {
      public:
@@ -62,17 +96,133 @@ namespace metaSMT {
 
       void command(addclause_cmd const&, std::vector<result_type> const& cls) { clause(cls); }
 
+      void command(interrupt_cmd const&) { solver_.interrupt(); }
+
+      /// applies the "sat.*" options, unset options keep the Minisat defaults
+      void command(setup_option_map_cmd const&, Options const& opt) {
+        option::Typed const& t = *opt.typed;
+        if (t.sat_var_decay) solver_.var_decay = *t.sat_var_decay;
+        if (t.sat_clause_decay) solver_.clause_decay = *t.sat_clause_decay;
+        if (t.sat_random_var_freq) solver_.random_var_freq = *t.sat_random_var_freq;
+        if (t.sat_phase_saving) solver_.phase_saving = *t.sat_phase_saving;
+        if (t.sat_ccmin_mode) solver_.ccmin_mode = *t.sat_ccmin_mode;
+        if (t.sat_luby_restart) solver_.luby_restart = *t.sat_luby_restart;
+        if (t.sat_restart_first) solver_.restart_first = *t.sat_restart_first;
+      }
+
       bool solve() {
+        solver_.clearInterrupt();
         solver_.simplify();
+        take_assumptions();
         if (!solver_.okay()) {
           // might be unsat during pre-processing (empty clause derived)
+          last_assumptions_.clear();
           return false;
         }
 
-        bool r = solver_.solve(assumption_);
+        return solver_.solve(last_assumptions_);
+      }
 
-        assumption_.clear();
-        return r;
+      /**
+       * Conflict and propagation limits map to the Minisat budgets, the
+       * timeout is enforced by a watchdog thread calling interrupt().
+       **/
+      tribool command(solve_limited_cmd const&, budget const& b) {
+        using namespace Minisat;
+
+        solver_.clearInterrupt();
+        solver_.simplify();
+        take_assumptions();
+        if (!solver_.okay()) {
+          last_assumptions_.clear();
+          return false;
+        }
+
+        solver_.budgetOff();
+        if (b.conflicts) solver_.setConfBudget(b.conflicts);
+        if (b.propagations) solver_.setPropBudget(b.propagations);
+
+        lbool r;
+        {
+          metaSMT::detail::watchdog w(b.timeout, [this] { solver_.interrupt(); });
+          r = solver_.solveLimited(last_assumptions_);
+        }
+
+        solver_.budgetOff();
+
+        if (r == l_True) return true;
+        if (r == l_False) return false;
+        return indeterminate;
+      }
+
+      /**
+       * Units are the top-level assignments, longer clauses are taken from
+       * the learnt clause database.
+       **/
+      export_learnts_cmd::result_type command(export_learnts_cmd const&, unsigned max_size) {
+        using namespace Minisat;
+
+        export_learnts_cmd::result_type ret;
+        if (max_size == 0) return ret;
+
+        for (Var v = 1; v < solver_.nVars(); ++v) {
+          lbool val = solver_.value(v);
+          if (val != l_Undef) {
+            result_type lit = {val == l_True ? v : -v};
+            ret.push_back(std::vector<result_type>(1, lit));
+          }
+        }
+
+        solver_.for_each_learnt(max_size, [this, &ret](Clause& c) {
+          std::vector<result_type> cls(c.size());
+          for (int i = 0; i < c.size(); ++i) {
+            cls[i] = fromLit(c[i]);
+          }
+          ret.push_back(cls);
+        });
+        return ret;
+      }
+
+      /// the VSIDS activities, scaled by the current increment
+      std::vector<double> command(var_activity_cmd const&) {
+        std::vector<double> ret(solver_.nVars());
+        for (Minisat::Var v = 0; v < solver_.nVars(); ++v) {
+          ret[v] = solver_.var_activity(v);
+        }
+        return ret;
+      }
+
+      /**
+       * Checks the problem clauses against the model. Top-level assignments
+       * are not stored as clauses and are always kept.
+       **/
+      lift_cmd::result_type command(lift_cmd const&, std::vector<result_type> const& candidates) {
+        using namespace Minisat;
+
+        metaSMT::detail::Lifter lifter(candidates);
+        std::vector<result_type> true_lits;
+        solver_.for_each_clause([this, &lifter, &true_lits](Clause& c) {
+          true_lits.clear();
+          for (int i = 0; i < c.size(); ++i) {
+            if (solver_.modelValue(c[i]) == l_True) true_lits.push_back(fromLit(c[i]));
+          }
+          lifter.satisfied_by(true_lits);
+        });
+        for (result_type const& lit : candidates) {
+          if (solver_.value(toLit(lit)) != l_Undef) lifter.keep(lit);
+        }
+        return lifter.droppable(candidates);
+      }
+
+      /// the final conflict holds the negations of the failed assumptions
+      std::vector<unsigned> command(get_unsat_core_cmd const&) {
+        std::vector<unsigned> core;
+        for (int i = 0; i < last_assumptions_.size(); ++i) {
+          if (solver_.conflict.has(~last_assumptions_[i])) {
+            core.push_back(i);
+          }
+        }
+        return core;
       }
 
       result_wrapper read_value(result_type lit) {
@@ -89,14 +239,46 @@ namespace metaSMT {
       }
 
      private:
-      Minisat::Solver solver_;
+      void take_assumptions() {
+        assumption_.copyTo(last_assumptions_);
+        assumption_.clear();
+      }
+
+      result_type fromLit(Minisat::Lit lit) const {
+        result_type ret = {Minisat::sign(lit) ? -Minisat::var(lit) : Minisat::var(lit)};
+        return ret;
+      }
+
+      detail::MiniSAT_Solver solver_;
       Minisat::vec<Minisat::Lit> assumption_;
+      Minisat::vec<Minisat::Lit> last_assumptions_;
     };
   }  // namespace solver
 
   namespace features {
     template <>
     struct supports<solver::MiniSAT, features::addclause_api> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, interrupt_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, setup_option_map_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, export_learnts_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, var_activity_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, lift_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::MiniSAT, get_unsat_core_cmd> : std::true_type {};
   }  // namespace features
 }  // namespace metaSMT
 // vim: ts=2 sw=2 et
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "../API/Budget.hpp"
+#include "../API/Interrupt.hpp"
+#include "../API/UnsatCore.hpp"
 #include "../Features.hpp"
 #include "../result_wrapper.hpp"
 #include "../tags/SAT.hpp"
@@ -7,9 +10,12 @@
 extern "C" {
 #include <picosat.h>
 }
+#include <algorithm>
 #include <any>
+#include <atomic>
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 namespace metaSMT {
@@ -20,40 +26,46 @@ namespace metaSMT {
   }
 
   namespace solver {
+    /**
+     * @brief PicoSAT backend
+     *
+     * Uses the reentrant picosat API, every instance owns a separate
+     * PicoSAT object. Instances can be created and solved concurrently
+     * on different threads.
+     **/
     class PicoSAT {
      public:
       typedef SAT::tag::lit_tag result_type;
-      PicoSAT() {
-        //          if ( in_use == USED )
-        //            throw std:runtime_error ("Picosat already in use. Only single instances supported.");
-
-        picosat_init();
-        //          in_use = USED;
+      PicoSAT() : solver_(picosat_init()), interrupted_(false), unsat_(false) {
+        picosat_set_interrupt(solver_, this, &PicoSAT::_interrupt_requested);
       }
 
-      ~PicoSAT() {
-        picosat_reset();
-        //         in_use = UNUSED;
-      }
+      ~PicoSAT() { picosat_reset(solver_); }
 
       int toLit(result_type lit) { return lit.id; }
 
       void clause(std::vector<result_type> const& clause) {
-        for (result_type const& lit : clause) picosat_add(toLit(lit));
-        picosat_add(0);
+        for (result_type const& lit : clause) picosat_add(solver_, toLit(lit));
+        picosat_add(solver_, 0);
       }
 
       void command(addclause_cmd const&, std::vector<result_type> const& cls) { clause(cls); }
 
       void assertion(result_type lit) {
-        picosat_add(toLit(lit));
-        picosat_add(0);
+        picosat_add(solver_, toLit(lit));
+        picosat_add(solver_, 0);
+      }
+
+      void assumption(result_type lit) {
+        picosat_assume(solver_, toLit(lit));
+        assumptions_.push_back(lit);
       }
 
-      void assumption(result_type lit) { picosat_assume(toLit(lit)); }
+      void command(interrupt_cmd const&) { interrupted_ = true; }
 
       bool solve() {
-        switch (picosat_sat(-1)) {
+        interrupted_ = false;
+        switch (sat(-1)) {
           case PICOSAT_UNSATISFIABLE:
             return false;
           case PICOSAT_SATISFIABLE:
@@ -65,8 +77,49 @@ namespace metaSMT {
         }
       }
 
+      /**
+       * PicoSAT has no conflict limit, the conflict budget is used as
+       * decision limit instead. The timeout is checked by the interrupt
+       * callback.
+       **/
+      tribool command(solve_limited_cmd const&, budget const& b) {
+        interrupted_ = false;
+        deadline_.start(b.timeout);
+        if (b.propagations) {
+          picosat_set_propagation_limit(solver_, picosat_propagations(solver_) + b.propagations);
+        }
+        int const decision_limit =
+            b.conflicts ? static_cast<int>(std::min<uint64_t>(b.conflicts, std::numeric_limits<int>::max())) : -1;
+
+        int const r = sat(decision_limit);
+
+        picosat_set_propagation_limit(solver_, 0);
+        deadline_.clear();
+        switch (r) {
+          case PICOSAT_UNSATISFIABLE:
+            return false;
+          case PICOSAT_SATISFIABLE:
+            return true;
+          case PICOSAT_UNKNOWN:
+            return indeterminate;
+          default:
+            throw std::runtime_error("unsupported return type of picosat_sat ");
+        }
+      }
+
+      std::vector<unsigned> command(get_unsat_core_cmd const&) {
+        std::vector<unsigned> core;
+        if (!unsat_) return core;
+        for (unsigned i = 0; i < last_assumptions_.size(); ++i) {
+          if (picosat_failed_assumption(solver_, toLit(last_assumptions_[i]))) {
+            core.push_back(i);
+          }
+        }
+        return core;
+      }
+
       result_wrapper read_value(result_type lit) {
-        switch (picosat_deref(toLit(lit))) {
+        switch (picosat_deref(solver_, toLit(lit))) {
           case -1:
             return result_wrapper('0');
           case 1:
@@ -80,14 +133,45 @@ namespace metaSMT {
       }
 
      private:
-      //         enum { UNUSED, USED };
-      //         static int in_use = UNUSED;
+      int sat(int decision_limit) {
+        last_assumptions_.swap(assumptions_);
+        assumptions_.clear();
+        int const r = picosat_sat(solver_, decision_limit);
+        unsat_ = (r == PICOSAT_UNSATISFIABLE);
+        return r;
+      }
+
+      static int _interrupt_requested(void* self) {
+        PicoSAT* pico = static_cast<PicoSAT*>(self);
+        return pico->interrupted_ || pico->deadline_.expired();
+      }
+
+      ::PicoSAT* solver_;
+      std::atomic<bool> interrupted_;
+      metaSMT::detail::deadline deadline_;
+
+      std::vector<result_type> assumptions_;
+      std::vector<result_type> last_assumptions_;
+      bool unsat_;
+
+      // disable copying, the PicoSAT object is owned
+      PicoSAT(PicoSAT const&);
+      PicoSAT& operator=(PicoSAT const&);
     };
   }  // namespace solver
 
   namespace features {
     template <>
     struct supports<solver::PicoSAT, features::addclause_api> : std::true_type {};
+
+    template <>
+    struct supports<solver::PicoSAT, interrupt_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::PicoSAT, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::PicoSAT, get_unsat_core_cmd> : std::true_type {};
   }  // namespace features
 
 }  // namespace metaSMT
@@ -1,11 +1,19 @@
 
 #pragma once
 
+#include <algorithm>
 #include <any>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
+#include "../API/AllSolutions.hpp"
+#include "../API/Interrupt.hpp"
 #include "../Features.hpp"
+#include "../result_wrapper.hpp"
+#include "../tags/Logic.hpp"
 #include "../tags/SAT.hpp"
+#include "SAT_Commands.hpp"
 
 namespace metaSMT {
   // Forward declaration
@@ -14,14 +22,22 @@ namespace metaSMT {
     struct addclause_api;
   }
 
+  /**
+   * @brief Tseitin transformation of Boolean operations into clauses
+   *
+   * Literals are numbered densely per context (starting at 1) instead of
+   * using the process-wide metaSMT::impl::new_var_id(). The SAT solver only
+   * sees the variables of this context, which keeps its internal arrays
+   * small and avoids contention between concurrent contexts.
+   **/
   template <typename SatSolver>
   class SAT_Clause {
    public:
     typedef SAT::tag::lit_tag result_type;
 
    public:
-    SAT_Clause() {
-      true_lit.id = int(impl::new_var_id());
+    SAT_Clause() : num_vars_(0) {
+      true_lit = new_lit();
       // std::cout << "<true>\n";
       solver.assertion(true_lit);
       // std::cout << "</true>\n";
@@ -33,7 +49,10 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::var_tag const&, std::any) {
-      result_type lit = {int(impl::new_var_id())};
+      result_type lit = new_lit();
+      if constexpr (features::supports<SatSolver, input_var_cmd>::value) {
+        solver.command(input_var_cmd(), lit);
+      }
       return lit;
     }
 
@@ -48,7 +67,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::and_tag const&, result_type lhs, result_type rhs) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(-lhs, -rhs, out);
       clause2(rhs, -out);
       clause2(lhs, -out);
@@ -56,7 +75,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::or_tag const&, result_type lhs, result_type rhs) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(lhs, rhs, -out);
       clause2(-rhs, out);
       clause2(-lhs, out);
@@ -64,7 +83,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::nor_tag const&, result_type lhs, result_type rhs) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(lhs, rhs, out);
       clause2(-rhs, -out);
       clause2(-lhs, -out);
@@ -76,7 +95,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::nand_tag const&, result_type lhs, result_type rhs) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(-lhs, -rhs, -out);
       clause2(rhs, out);
       clause2(lhs, out);
@@ -84,7 +103,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::xnor_tag const&, result_type lhs, result_type rhs) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(lhs, rhs, out);
       clause3(lhs, -rhs, -out);
       clause3(-lhs, rhs, -out);
@@ -93,7 +112,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::xor_tag const&, result_type lhs, result_type rhs) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(lhs, rhs, -out);
       clause3(lhs, -rhs, out);
       clause3(-lhs, rhs, out);
@@ -126,7 +145,7 @@ namespace metaSMT {
     }
 
     result_type operator()(logic::tag::ite_tag const&, result_type op1, result_type op2, result_type op3) {
-      result_type out = {int(impl::new_var_id())};
+      result_type out = new_lit();
       clause3(op1, op3, -out);
       clause3(op1, -op3, out);
       clause3(-op1, op2, -out);
@@ -144,19 +163,93 @@ namespace metaSMT {
       solver.assertion(lit);
     }
 
+    /// kept until the next solve() or solver command
     void assumption(result_type lit) {
       // std::cout << "assume " << lit << std::endl;
-      solver.assumption(lit);
+      assumptions_.push_back(lit);
+    }
+
+    template <typename Cmd>
+    typename Cmd::result_type command(Cmd const& cmd) {
+      pass_assumptions();
+      return solver.command(cmd);
     }
 
     template <typename Cmd, typename Expr>
-    void command(Cmd const& cmd, Expr& expr) {
-      solver.command(cmd, expr);
+    typename Cmd::result_type command(Cmd const& cmd, Expr& expr) {
+      pass_assumptions();
+      return solver.command(cmd, expr);
+    }
+
+    /// called from other threads during solve(), leaves the assumptions alone
+    void command(interrupt_cmd const& cmd) { solver.command(cmd); }
+
+    /**
+     * Blocks each solution by a clause over the projected literals. The
+     * clauses go to the solver directly, guarded by a fresh literal that
+     * is assumed during the enumeration only and retired afterwards. The
+     * pending assumptions are repeated for every solution.
+     *
+     * Solvers supporting lift_cmd generalize each model to a cube: the
+     * projected literals no clause needs are dropped from the blocking
+     * clause, and f is called for every assignment of them without another
+     * solver call. read_value() returns that assignment meanwhile.
+     */
+    std::uint64_t command(for_each_solution_cmd const&, std::vector<result_type> const& lits,
+                          std::function<void()> const& f, std::uint64_t limit) {
+      std::vector<result_type> assumptions;
+      assumptions.swap(assumptions_);
+      result_type const enabled = new_lit();
+      std::vector<result_type> cube;
+      std::vector<result_type> block;
+      std::uint64_t n = 0;
+      while (n < limit) {
+        for (result_type const& lit : assumptions) {
+          solver.assumption(lit);
+        }
+        solver.assumption(enabled);
+        if (!solver.solve()) break;
+        cube.clear();
+        for (result_type const& lit : lits) {
+          cube.push_back(static_cast<bool>(solver.read_value(lit)) ? lit : -lit);
+        }
+
+        std::vector<result_type> const free = dont_cares(cube, assumptions);
+        block.assign(1, -enabled);
+        for (result_type const& lit : cube) {
+          if (std::find_if(free.begin(), free.end(), [&lit](result_type const& l) { return l.var() == lit.var(); }) ==
+              free.end()) {
+            block.push_back(-lit);
+          }
+        }
+
+        // every assignment of the free literals, the model value first
+        std::uint64_t const combinations = std::uint64_t(1) << free.size();
+        for (std::uint64_t mask = 0; mask < combinations && n < limit; ++mask, ++n) {
+          overrides_.clear();
+          for (std::size_t i = 0; i < free.size(); ++i) {
+            overrides_.push_back(mask & (std::uint64_t(1) << i) ? -free[i] : free[i]);
+          }
+          f();
+        }
+        overrides_.clear();
+        solver.clause(block);
+      }
+      solver.clause(std::vector<result_type>(1, -enabled));
+      return n;
     }
 
-    bool solve() { return solver.solve(); }
+    bool solve() {
+      pass_assumptions();
+      return solver.solve();
+    }
 
-    result_wrapper read_value(result_type lit) { return solver.read_value(lit); }
+    result_wrapper read_value(result_type lit) {
+      for (result_type const& o : overrides_) {
+        if (o.var() == lit.var()) return result_wrapper(o.id == lit.id);
+      }
+      return solver.read_value(lit);
+    }
 
     void clause2(result_type a, result_type b) {
       std::vector<result_type> cls(2);
@@ -173,9 +266,51 @@ namespace metaSMT {
       solver.clause(cls);
     }
 
+    /// allocate a fresh literal from the dense, context-local id space
+    result_type new_lit() {
+      result_type lit = {++num_vars_};
+      return lit;
+    }
+
+    /// number of SAT variables allocated by this context
+    int num_vars() const { return num_vars_; }
+
    private:
+    /**
+     * the literals of the cube that lift_cmd drops, one per variable and
+     * at most 63, assumed variables stay in the cube
+     */
+    std::vector<result_type> dont_cares(std::vector<result_type> const& cube,
+                                        std::vector<result_type> const& assumptions) {
+      std::vector<result_type> free;
+      if constexpr (features::supports<SatSolver, lift_cmd>::value) {
+        std::vector<result_type> candidates;
+        for (result_type const& lit : cube) {
+          auto const same_var = [&lit](result_type const& l) { return l.var() == lit.var(); };
+          if (std::find_if(assumptions.begin(), assumptions.end(), same_var) == assumptions.end() &&
+              std::find_if(candidates.begin(), candidates.end(), same_var) == candidates.end()) {
+            candidates.push_back(lit);
+          }
+        }
+        free = solver.command(lift_cmd(), candidates);
+        if (free.size() > 63) free.resize(63);
+      }
+      return free;
+    }
+
+    void pass_assumptions() {
+      for (result_type const& lit : assumptions_) {
+        solver.assumption(lit);
+      }
+      assumptions_.clear();
+    }
+
     SatSolver solver;
+    int num_vars_;
     result_type true_lit;
+    std::vector<result_type> assumptions_;
+    /// the values of the dropped literals while for_each_solution() calls f
+    std::vector<result_type> overrides_;
   };
 
   namespace features {
@@ -183,6 +318,9 @@ namespace metaSMT {
     template <typename Context>
     struct supports<SAT_Clause<Context>, features::addclause_api> : std::true_type {};
 
+    template <typename Context>
+    struct supports<SAT_Clause<Context>, for_each_solution_cmd> : std::true_type {};
+
     /* Forward all other supported operations */
     template <typename Context, typename Feature>
     struct supports<SAT_Clause<Context>, Feature> : supports<Context, Feature>::type {};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "../tags/SAT.hpp"
+
+namespace metaSMT {
+  /**
+   * @brief marks a SAT literal as frontend variable
+   *
+   * Sent by SAT_Clause for every Boolean variable created by the frontend
+   * (including the bits of bit-vectors), in contrast to the auxiliary
+   * variables of the Tseitin transformation. Only sent to solvers that
+   * support the command.
+   **/
+  struct input_var_cmd {
+    typedef void result_type;
+  };
+
+  /**
+   * @brief export short clauses learnt during the last solve
+   *
+   * Takes the maximal clause length and returns the learnt clauses up to
+   * that length, unit clauses included. The clauses are implied by the
+   * clause set without the assumptions.
+   **/
+  struct export_learnts_cmd {
+    typedef std::vector<std::vector<SAT::tag::lit_tag> > result_type;
+  };
+
+  /**
+   * @brief branching activity of the variables
+   *
+   * Returns the activity of each variable, indexed by variable. Higher
+   * values mark variables the solver branched on in recent conflicts.
+   * Variables unknown to the solver may be missing at the end.
+   **/
+  struct var_activity_cmd {
+    typedef std::vector<double> result_type;
+  };
+
+  /**
+   * @brief literals of the last model that no clause needs
+   *
+   * Takes literals that are true in the model of the last solve() and
+   * returns those of them that can take any value: every clause of the
+   * solver is satisfied by a true literal of the model that is not
+   * returned. Any assignment of the returned variables together with the
+   * rest of the model is a solution. Used by SAT_Clause to generalize the
+   * solutions of for_each_solution() to cubes.
+   **/
+  struct lift_cmd {
+    typedef std::vector<SAT::tag::lit_tag> result_type;
+  };
+
+  namespace detail {
+    /**
+     * lift_cmd for solvers that can visit their clauses. Each clause is
+     * given by its literals that are true in the model, a clause whose true
+     * literals are all candidates keeps the first of them.
+     */
+    class Lifter {
+     public:
+      explicit Lifter(std::vector<SAT::tag::lit_tag> const& candidates) {
+        for (SAT::tag::lit_tag const& lit : candidates) {
+          droppable_.insert(lit.id);
+        }
+      }
+
+      void satisfied_by(std::vector<SAT::tag::lit_tag> const& true_lits) {
+        for (SAT::tag::lit_tag const& lit : true_lits) {
+          if (!droppable_.count(lit.id)) return;
+        }
+        if (!true_lits.empty()) keep(true_lits.front());
+      }
+
+      /// a literal that is needed without clause, e.g. a top-level unit
+      void keep(SAT::tag::lit_tag const& lit) { droppable_.erase(lit.id); }
+
+      std::vector<SAT::tag::lit_tag> droppable(std::vector<SAT::tag::lit_tag> const& candidates) const {
+        std::vector<SAT::tag::lit_tag> ret;
+        for (SAT::tag::lit_tag const& lit : candidates) {
+          if (droppable_.count(lit.id)) ret.push_back(lit);
+        }
+        return ret;
+      }
+
+     private:
+      std::unordered_set<int> droppable_;
+    };
+  }  // namespace detail
+}  // namespace metaSMT
+
+//  vim: ft=cpp:ts=2:sw=2:expandtab
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../API/ReadValues.hpp"
+#include "../Features.hpp"
 #include "../result_wrapper.hpp"
 #include "../tags/Array.hpp"
 #include "../tags/QF_BV.hpp"
@@ -9,10 +11,26 @@ extern "C" {
 }
 
 #include <any>
+#include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <list>
+#include <memory>
+#include <vector>
 
 namespace metaSMT {
+  /**
+   * @brief number of STP expressions alive in the context
+   *
+   * The expressions referenced by a result_type of the context, e.g. by
+   * the frontend, the variable cache or the pending assumptions.
+   * Intermediate expressions are freed with their last reference, for
+   * long-running contexts this number should not grow without bound.
+   */
+  struct live_expressions_cmd {
+    typedef std::size_t result_type;
+  };
+
   namespace solver {
     namespace predtags = ::metaSMT::logic::tag;
     namespace bvtags = ::metaSMT::logic::QF_BV::tag;
@@ -22,31 +40,79 @@ namespace metaSMT {
      * @ingroup Backend
      * @class STP STP.hpp metaSMT/backend/STP.hpp
      * @brief The STP backend
+     *
+     * Note: the STP C interface keeps parts of its state in library-wide
+     * globals, STP contexts must not be used concurrently from several threads.
+     *
+     * Every expression returned by the C interface is owned by a
+     * result_type and deleted with its last copy. Copies that outlive the
+     * context are not deleted, their memory is released with the context.
      */
     class STP {
      private:
       typedef std::tuple<uint64_t, unsigned> bvuint_tuple;
       typedef std::tuple<int64_t, unsigned> bvsint_tuple;
 
+      /// shared by the context and its expressions
+      struct expressions {
+        /// NULL once the context is destroyed
+        VC vc;
+        std::size_t live;
+      };
+
+      struct delete_expr {
+        std::shared_ptr<expressions> owner;
+
+        void operator()(Expr e) const {
+          if (owner->vc) {
+            vc_DeleteExpr(e);
+            --owner->live;
+          }
+        }
+      };
+
      public:
-      typedef Expr result_type;
-      typedef std::list<Expr> Exprs;
+      /// a reference-counted Expr, converts to Expr for the C interface
+      class result_type {
+       public:
+        result_type() {}
+
+        operator Expr() const { return expr_.get(); }
+
+       private:
+        friend class STP;
 
+        result_type(Expr e, std::shared_ptr<expressions> const& owner) : expr_(e, delete_expr{owner}) {}
+
+        std::shared_ptr<void> expr_;
+      };
+
+      typedef std::list<result_type> Exprs;
+
+      /// takes ownership of an expression returned by the C interface
       result_type ptr(Expr expr) {
-        exprs.push_back(expr);
-        return expr;
+        ++owner_->live;
+        return result_type(expr, owner_);
       }
 
-      STP() : vc(vc_createValidityChecker()) { make_division_total(vc); }
+      STP()
+          : vc(vc_createValidityChecker()),
+            owner_(std::make_shared<expressions>(expressions{vc, 0})),
+            counterexample_(NULL) {
+        make_division_total(vc);
+      }
 
       ~STP() {
-        for (Exprs::iterator it = exprs.begin(), ie = exprs.end(); it != ie; ++it) {
-          vc_DeleteExpr(*it);
-        }
+        free_counterexample();
+        assumptions.clear();
+        owner_->vc = NULL;
         vc_Destroy(vc);
       }
 
-      void assertion(result_type e) { vc_assertFormula(vc, e); }
+      void assertion(result_type e) {
+        free_counterexample();
+        vc_assertFormula(vc, e);
+      }
 
       void assumption(result_type e) { assumptions.push_back(e); }
 
@@ -55,6 +121,7 @@ namespace metaSMT {
       bool solve() {
         enum SolverResult { INVALID = 0, VALID = 1, ERROR = 2, TIMEOUT = 3 };
 
+        free_counterexample();
         if (!assumptions.empty()) {
           vc_push(vc);
           for (Exprs::const_iterator it = assumptions.begin(), ie = assumptions.end(); it != ie; ++it) {
@@ -64,7 +131,7 @@ namespace metaSMT {
 
         bool sat = false;
         // check (F -> false)
-        switch (vc_query(vc, vc_falseExpr(vc))) {
+        switch (vc_query(vc, ptr(vc_falseExpr(vc)))) {
           case VALID:
             // implies (not F) is valid
             sat = false;
@@ -86,36 +153,17 @@ namespace metaSMT {
         return sat;
       }
 
-      result_wrapper read_value(result_type var) {
-        Expr cex = ptr(vc_getCounterExample(vc, var));
-        // vc_printExpr(vc, cex);
+      result_wrapper read_value(result_type const& var) { return value(counterexample(), var); }
 
-        switch (getType(var)) {
-          case BOOLEAN_TYPE: {
-            int const value = vc_isBool(cex);
-            if (value == 1) {
-              return result_wrapper(true);
-            } else if (value == 0) {
-              return result_wrapper(false);
-            }
-          } break;
-          case BITVECTOR_TYPE: {
-            unsigned const width = getBVLength(cex);
-            if (width <= sizeof(unsigned long long) * 8) {
-              return result_wrapper(getBVUnsignedLongLong(cex), width);
-            } else {
-              std::string str = exprString(cex);
-              std::cout << str << std::endl;
-              size_t pos = str.find_first_of(' ');  // find trailing space
-              return result_wrapper(pos != std::string::npos ? str.substr(2, pos - 2) : str.substr(2));
-            }
-          } break;
-          case ARRAY_TYPE:
-          case UNKNOWN_TYPE:
-            assert(false);
-            break;
+      /// reads all variables from the same counterexample
+      std::vector<result_wrapper> command(read_values_cmd const&, std::vector<result_type> const& vars) {
+        WholeCounterExample cex = counterexample();
+        std::vector<result_wrapper> values;
+        values.reserve(vars.size());
+        for (result_type const& var : vars) {
+          values.push_back(value(cex, var));
         }
-        return result_wrapper(false);
+        return values;
       }
 
       // predtags
@@ -133,17 +181,13 @@ namespace metaSMT {
       result_type operator()(predtags::not_tag, result_type e) { return ptr(vc_notExpr(vc, e)); }
 
       result_type operator()(predtags::and_tag, std::vector<result_type> const& vs) {
-        std::size_t const num_elm = vs.size();
-        Expr* exprs = new Expr[num_elm];
-        for (unsigned u = 0; u < num_elm; ++u) exprs[u] = vs[u];
-        return ptr(vc_andExprN(vc, exprs, num_elm));
+        std::vector<Expr> exprs(vs.begin(), vs.end());
+        return ptr(vc_andExprN(vc, exprs.data(), exprs.size()));
       }
 
       result_type operator()(predtags::or_tag, std::vector<result_type> const& vs) {
-        std::size_t const num_elm = vs.size();
-        Expr* exprs = new Expr[num_elm];
-        for (unsigned u = 0; u < num_elm; ++u) exprs[u] = vs[u];
-        return ptr(vc_orExprN(vc, exprs, num_elm));
+        std::vector<Expr> exprs(vs.begin(), vs.end());
+        return ptr(vc_orExprN(vc, exprs.data(), exprs.size()));
       }
 
       result_type operator()(predtags::ite_tag, result_type a, result_type b, result_type c) {
@@ -160,11 +204,11 @@ namespace metaSMT {
       }
 
       result_type operator()(bvtags::bit0_tag, std::any) {
-        return (vc_bvConstExprFromInt(vc, 1, 0));  // No ptr()
+        return ptr(vc_bvConstExprFromInt(vc, 1, 0));
       }
 
       result_type operator()(bvtags::bit1_tag, std::any) {
-        return (vc_bvConstExprFromInt(vc, 1, 1));  // No ptr()
+        return ptr(vc_bvConstExprFromInt(vc, 1, 1));
       }
 
       result_type operator()(bvtags::bvuint_tag, std::any arg) {
@@ -207,7 +251,7 @@ namespace metaSMT {
 
       result_type operator()(bvtags::bvbin_tag, std::any arg) {
         std::string val = std::any_cast<std::string>(arg);
-        return (vc_bvConstExprFromStr(vc, val.c_str()));
+        return ptr(vc_bvConstExprFromStr(vc, val.c_str()));
       }
 
       result_type operator()(bvtags::bvhex_tag, std::any arg) {
@@ -275,7 +319,7 @@ namespace metaSMT {
       result_type operator()(bvtags::bvneg_tag, result_type e) { return ptr(vc_bvUMinusExpr(vc, e)); }
 
       result_type operator()(bvtags::bvcomp_tag, result_type a, result_type b) {
-        Expr comp = ptr(vc_eqExpr(vc, a, b));
+        result_type comp = ptr(vc_eqExpr(vc, a, b));
         return ptr(vc_boolToBVExpr(vc, comp));
       }
 
@@ -300,7 +344,7 @@ namespace metaSMT {
 
       result_type operator()(bvtags::zero_extend_tag const&, unsigned width, result_type e) {
         std::string s(width, '0');
-        Expr zeros = ptr(vc_bvConstExprFromStr(vc, s.c_str()));
+        result_type zeros = ptr(vc_bvConstExprFromStr(vc, s.c_str()));
         return ptr(vc_bvConcatExpr(vc, zeros, e));
       }
 
@@ -365,14 +409,14 @@ namespace metaSMT {
         return ptr(vc_falseExpr(vc));
       }
 
-      template <result_type (*FN)(VC, Expr, Expr)>
+      template <Expr (*FN)(VC, Expr, Expr)>
       struct VC_F2 {
-        static result_type exec(VC vc, Expr x, Expr y) { return (*FN)(vc, x, y); }
+        static Expr exec(VC vc, Expr x, Expr y) { return (*FN)(vc, x, y); }
       };
 
-      template <result_type (*FN)(VC, int, Expr, Expr)>
+      template <Expr (*FN)(VC, int, Expr, Expr)>
       struct VC_SIZE_F2 {
-        static result_type exec(VC vc, Expr x, Expr y) {
+        static Expr exec(VC vc, Expr x, Expr y) {
           int const size_x = getBVLength(x);
           int const size_y = getBVLength(y);
           assert(size_x == size_y);
@@ -380,14 +424,24 @@ namespace metaSMT {
         }
       };
 
-      template <result_type (*FN)(VC, Expr, Expr)>
+      template <Expr (*FN)(VC, Expr, Expr)>
       struct VC_NOT_F2 {
-        static result_type exec(VC vc, Expr x, Expr y) { return vc_notExpr(vc, (*FN)(vc, x, y)); }
+        static Expr exec(VC vc, Expr x, Expr y) {
+          Expr const inner = (*FN)(vc, x, y);
+          Expr const r = vc_notExpr(vc, inner);
+          vc_DeleteExpr(inner);
+          return r;
+        }
       };
 
-      template <result_type (*FN)(VC, Expr, Expr)>
+      template <Expr (*FN)(VC, Expr, Expr)>
       struct VC_BVNOT_F2 {
-        static result_type exec(VC vc, Expr x, Expr y) { return vc_bvNotExpr(vc, (*FN)(vc, x, y)); }
+        static Expr exec(VC vc, Expr x, Expr y) {
+          Expr const inner = (*FN)(vc, x, y);
+          Expr const r = vc_bvNotExpr(vc, inner);
+          vc_DeleteExpr(inner);
+          return r;
+        }
       };
 
       result_type operator()(predtags::and_tag, result_type a, result_type b) {
@@ -490,13 +544,76 @@ namespace metaSMT {
         return ptr(vc_falseExpr(vc));
       }
 
+      std::size_t command(live_expressions_cmd const&) const { return owner_->live; }
+
       // pseudo command
       void command(STP const&) {}
 
       VC vc;
       Exprs assumptions;
-      Exprs exprs;
+
+     private:
+      /// the counterexample of the last solve, fetched on the first read
+      WholeCounterExample counterexample() {
+        if (!counterexample_) counterexample_ = vc_getWholeCounterExample(vc);
+        return counterexample_;
+      }
+
+      void free_counterexample() {
+        if (counterexample_) {
+          vc_deleteWholeCounterExample(counterexample_);
+          counterexample_ = NULL;
+        }
+      }
+
+      result_wrapper value(WholeCounterExample whole, result_type const& var) {
+        Expr cex = vc_getTermFromCounterExample(vc, var, whole);
+        result_wrapper const r = value_of(cex, var);
+        vc_DeleteExpr(cex);
+        return r;
+      }
+
+      result_wrapper value_of(Expr cex, result_type const& var) {
+        switch (getType(var)) {
+          case BOOLEAN_TYPE: {
+            int const value = vc_isBool(cex);
+            if (value == 1) {
+              return result_wrapper(true);
+            } else if (value == 0) {
+              return result_wrapper(false);
+            }
+          } break;
+          case BITVECTOR_TYPE: {
+            unsigned const width = getBVLength(cex);
+            if (width <= sizeof(unsigned long long) * 8) {
+              return result_wrapper(getBVUnsignedLongLong(cex), width);
+            } else {
+              char* s = exprString(cex);
+              std::string str = s;
+              free(s);
+              size_t pos = str.find_first_of(' ');  // find trailing space
+              return result_wrapper(pos != std::string::npos ? str.substr(2, pos - 2) : str.substr(2));
+            }
+          } break;
+          case ARRAY_TYPE:
+          case UNKNOWN_TYPE:
+            assert(false);
+            break;
+        }
+        return result_wrapper(false);
+      }
+
+      std::shared_ptr<expressions> owner_;
+      WholeCounterExample counterexample_;
     };  // STP
 
   }  // namespace solver
+
+  namespace features {
+    template <>
+    struct supports<solver::STP, read_values_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::STP, live_expressions_cmd> : std::true_type {};
+  }  // namespace features
 }  // namespace metaSMT
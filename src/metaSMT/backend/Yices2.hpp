@@ -4,8 +4,16 @@
 
 #include <any>
 #include <list>
+#include <mutex>
+#include <set>
 #include <tuple>
+#include <vector>
 
+#include "../API/Budget.hpp"
+#include "../API/Interrupt.hpp"
+#include "../API/ReadValues.hpp"
+#include "../API/UnsatCore.hpp"
+#include "../Features.hpp"
 #include "../result_wrapper.hpp"
 #include "../tags/Array.hpp"
 #include "../tags/Logic.hpp"
@@ -40,13 +48,34 @@ namespace metaSMT {
       };  // yices_type_visitor
     }     // namespace detail
 
-    template <class T>
-    struct ObjectCounter {
-      static int count;
-    };
+    /**
+     * @brief reference count of the process-wide yices library state
+     *
+     * yices_init()/yices_exit() initialize and destroy global tables shared
+     * by all contexts. The first Yices2Impl of either mode (on any thread)
+     * initializes the library, the last one releases it. Term construction
+     * itself touches the global term table, so concurrent use of several
+     * Yices2 contexts additionally requires a yices build configured with
+     * --enable-thread-safety.
+     */
+    struct yices_library {
+      static void acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count++ == 0) {
+          yices_init();
+        }
+      }
 
-    template <class T>
-    int ObjectCounter<T>::count = 0;
+      static void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--count == 0) {
+          yices_exit();
+        }
+      }
+
+      static inline int count = 0;
+      static inline std::mutex mutex;
+    };
 
     template <bool RealIncreamentalMode = false>
     class Yices2Impl {
@@ -61,8 +90,11 @@ namespace metaSMT {
      private:
       Exprs assumptions_;
       Exprs assertions_;
-      bool isPushed_;
+      std::vector<term_t> last_assumptions_;
+      bool last_unsat_;
       context_t *ctx;
+      /// the model of the last solve, fetched on the first read
+      model_t *model_;
 
       std::string yices_error_message_with_prefix(std::string prefix) { return prefix + yices_error_string(); }
 
@@ -74,10 +106,8 @@ namespace metaSMT {
       }
 
      public:
-      Yices2Impl() : isPushed_(false) {
-        if (ObjectCounter<Yices2Impl>::count == 0) {
-          yices_init();
-        }
+      Yices2Impl() : last_unsat_(false), model_(NULL) {
+        yices_library::acquire();
         ctx_config_t *config = yices_new_config();
         yices_default_config_for_logic(config, "QF_AUFBV");
         if (RealIncreamentalMode)
@@ -86,63 +116,80 @@ namespace metaSMT {
           yices_set_config(config, "mode", "one-shot");
         ctx = yices_new_context(config);
         yices_free_config(config);
-        ObjectCounter<Yices2Impl>::count++;
       }
 
       ~Yices2Impl() {
+        free_model();
         yices_free_context(ctx);
-        ObjectCounter<Yices2Impl>::count--;
-        if (ObjectCounter<Yices2Impl>::count == 0) {
-          yices_exit();
-        }
+        yices_library::release();
       }
 
-      void assertion(result_type e) { assertions_.push_back(e); }
+      void assertion(result_type e) {
+        free_model();
+        assertions_.push_back(e);
+      }
 
       void assumption(result_type e) { assumptions_.push_back(e); }
 
-      bool solve() {
-        if (RealIncreamentalMode)
-          removeOldAssumptions();
-        else
-          yices_reset_context(ctx);
-        pushAssertions();
-        pushAssumptions();
-        smt_status_t status = yices_check_context(ctx, NULL);
-        return (status == STATUS_SAT);
-      }
+      /**
+       * In incremental mode assumptions are passed to
+       * yices_check_context_with_assumptions, which provides the unsat
+       * core. In one-shot mode the context is rebuilt and assumptions are
+       * asserted.
+       **/
+      bool solve() { return check() == STATUS_SAT; }
+
+      /**
+       * The timeout is enforced by a watchdog thread calling
+       * yices_stop_search(). An interrupted or unknown search is
+       * indeterminate. Yices has no conflict or propagation limit.
+       **/
+      tribool command(solve_limited_cmd const &, budget const &b) {
+        smt_status_t status;
+        {
+          metaSMT::detail::watchdog w(b.timeout, [this] { yices_stop_search(ctx); });
+          status = check();
+        }
 
-      result_wrapper read_value(result_type var) {
-        model_t *model = yices_get_model(ctx, true);
-        if (!model) {
-          throw std::runtime_error(std::string("read_value: Cannot get model from Yices2"));
+        switch (status) {
+          case STATUS_SAT:
+            return true;
+          case STATUS_UNSAT:
+            return false;
+          default:
+            return indeterminate;
         }
-        if (yices_term_is_bitvector(var)) {
-          int32_t bits = yices_term_bitsize(var);
-          int32_t *array = new int32_t[bits];
-          std::vector<bool> booleans;
-          if (yices_get_bv_value(model, var, array) != -1) {
-            for (int32_t i = 0; i < bits; i++) {
-              booleans.push_back(array[i]);
+      }
+
+      std::vector<unsigned> command(get_unsat_core_cmd const &) {
+        std::vector<unsigned> core;
+        if (!last_unsat_ || last_assumptions_.empty()) return core;
+
+        term_vector_t v;
+        yices_init_term_vector(&v);
+        if (yices_get_unsat_core(ctx, &v) == 0) {
+          std::set<term_t> failed(v.data, v.data + v.size);
+          for (unsigned i = 0; i < last_assumptions_.size(); ++i) {
+            if (failed.count(last_assumptions_[i])) {
+              core.push_back(i);
             }
-            delete[] array;
-            return result_wrapper(booleans);
-          } else {
-            throw std::runtime_error(std::string("read_value: Failed to read bitvector from Yices2"));
-          }
-        } else if (yices_term_is_bool(var)) {
-          int32_t value = 0;
-          if (yices_get_bool_value(model, var, &value) == 0) {
-            return result_wrapper((bool)value);
-          } else {
-            throw std::runtime_error(std::string("read_value: Failed to read bool from Yices2"));
           }
-        } else if (yices_term_is_tuple(var)) {
-          throw std::runtime_error(std::string("read_value: Reading tuple from Yices2 not yet supported"));
         }
+        yices_delete_term_vector(&v);
+        return core;
+      }
 
-        throw std::runtime_error(yices_error_message_with_prefix("read_value: "));
-        return result_wrapper(false);
+      result_wrapper read_value(result_type var) { return value(model(), var); }
+
+      /// reads all variables from the same model
+      std::vector<result_wrapper> command(read_values_cmd const &, std::vector<result_type> const &vars) {
+        model_t *m = model();
+        std::vector<result_wrapper> values;
+        values.reserve(vars.size());
+        for (result_type var : vars) {
+          values.push_back(value(m, var));
+        }
+        return values;
       }
 
       // predtags
@@ -385,26 +432,67 @@ namespace metaSMT {
 
       void command(Yices2Impl const &) {}
 
+      void command(interrupt_cmd const &) { yices_stop_search(ctx); }
+
      private:
-      void removeOldAssumptions() {
-        if (isPushed_) {
-          if (yices_pop(ctx)) {
-            throw std::runtime_error(yices_error_message_with_prefix("removeOldAssumptions error: "));
+      /// solves with the pending assumptions, shared by solve() and solve_limited
+      smt_status_t check() {
+        free_model();
+        if (!RealIncreamentalMode) yices_reset_context(ctx);
+        pushAssertions();
+
+        last_assumptions_.assign(assumptions_.begin(), assumptions_.end());
+        assumptions_.clear();
+
+        smt_status_t status;
+        if (RealIncreamentalMode && !last_assumptions_.empty()) {
+          status = yices_check_context_with_assumptions(ctx, NULL, last_assumptions_.size(), last_assumptions_.data());
+        } else {
+          if (!RealIncreamentalMode) applyAssertions(Exprs(last_assumptions_.begin(), last_assumptions_.end()));
+          status = yices_check_context(ctx, NULL);
+        }
+        last_unsat_ = (status == STATUS_UNSAT);
+        return status;
+      }
+
+      model_t *model() {
+        if (!model_) {
+          model_ = yices_get_model(ctx, true);
+          if (!model_) {
+            throw std::runtime_error(std::string("read_value: Cannot get model from Yices2"));
           }
-          isPushed_ = false;
         }
+        return model_;
       }
 
-      void pushAssumptions() {
-        if (assumptions_.empty()) return;
-        if (RealIncreamentalMode) {
-          if (yices_push(ctx)) {
-            throw std::runtime_error(yices_error_message_with_prefix("pushAssumptions error: "));
+      result_wrapper value(model_t *model, result_type var) {
+        if (yices_term_is_bitvector(var)) {
+          std::vector<int32_t> array(yices_term_bitsize(var));
+          if (yices_get_bv_value(model, var, array.data()) != -1) {
+            return result_wrapper(std::vector<bool>(array.begin(), array.end()));
+          } else {
+            throw std::runtime_error(std::string("read_value: Failed to read bitvector from Yices2"));
           }
-          isPushed_ = true;
+        } else if (yices_term_is_bool(var)) {
+          int32_t value = 0;
+          if (yices_get_bool_value(model, var, &value) == 0) {
+            return result_wrapper((bool)value);
+          } else {
+            throw std::runtime_error(std::string("read_value: Failed to read bool from Yices2"));
+          }
+        } else if (yices_term_is_tuple(var)) {
+          throw std::runtime_error(std::string("read_value: Reading tuple from Yices2 not yet supported"));
+        }
+
+        throw std::runtime_error(yices_error_message_with_prefix("read_value: "));
+        return result_wrapper(false);
+      }
+
+      void free_model() {
+        if (model_) {
+          yices_free_model(model_);
+          model_ = NULL;
         }
-        applyAssertions(assumptions_);
-        assumptions_.clear();
       }
 
       void pushAssertions() {
@@ -426,4 +514,18 @@ namespace metaSMT {
     typedef Yices2Impl<true> Yices2;
 
   }  // namespace solver
+
+  namespace features {
+    template <bool RealIncreamentalMode>
+    struct supports<solver::Yices2Impl<RealIncreamentalMode>, interrupt_cmd> : std::true_type {};
+
+    template <bool RealIncreamentalMode>
+    struct supports<solver::Yices2Impl<RealIncreamentalMode>, solve_limited_cmd> : std::true_type {};
+
+    template <bool RealIncreamentalMode>
+    struct supports<solver::Yices2Impl<RealIncreamentalMode>, read_values_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Yices2Impl<true>, get_unsat_core_cmd> : std::true_type {};
+  }  // namespace features
 }  // namespace metaSMT
@@ -1,14 +1,28 @@
 #pragma once
 #include <z3++.h>
 
+#include <algorithm>
 #include <any>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <limits>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
 #include <tuple>
-
+#include <unordered_map>
+#include <vector>
+
+#include "../API/Budget.hpp"
+#include "../API/Cardinality.hpp"
+#include "../API/Interrupt.hpp"
+#include "../API/Optimize.hpp"
+#include "../API/ReadValues.hpp"
+#include "../API/UnsatCore.hpp"
 #include "../Features.hpp"
 #include "../result_wrapper.hpp"
 #include "../tags/Array.hpp"
+#include "../tags/Cardinality.hpp"
 #include "../tags/QF_BV.hpp"
 #include "../tags/QF_UF.hpp"
 
@@ -26,6 +40,7 @@ namespace metaSMT {
     namespace bvtags = ::metaSMT::logic::QF_BV::tag;
     namespace arraytags = ::metaSMT::logic::Array::tag;
     namespace uftags = ::metaSMT::logic::QF_UF::tag;
+    namespace cardtags = ::metaSMT::logic::cardinality::tag;
 
     namespace detail {
       struct dummy {
@@ -99,49 +114,56 @@ namespace metaSMT {
 
       // typedef z3::ast result_type;
 
-      Z3_Backend() : solver_(ctx_, "QF_AUFBV"), assumption_((*this)(predtags::true_tag(), std::any())) {}
+      Z3_Backend() : solver_(ctx_, "QF_AUFBV"), optimizing_(false), last_unsat_(false), scopes_(0), checks_(0) {}
 
       ~Z3_Backend() {}
 
-      result_wrapper read_value(result_type const &var) {
-        z3::model model = solver_.get_model();
-        z3::expr r = model.eval(z3::expr(var), /* completion = */ true);
+      result_wrapper read_value(result_type const &var) { return value(model(), var); }
 
-        // predicate
-        if (r.is_bool()) {
-          Z3_lbool b = Z3_get_bool_value(ctx_, r);
-          if (b == Z3_L_FALSE) return result_wrapper(false);
-          if (b == Z3_L_TRUE) return result_wrapper(true);
-          return result_wrapper();
+      /// evaluates all variables in the same model
+      std::vector<result_wrapper> command(read_values_cmd const &, std::vector<result_type> const &vars) {
+        z3::model &m = model();
+        std::vector<result_wrapper> values;
+        values.reserve(vars.size());
+        for (result_type const &var : vars) {
+          values.push_back(value(m, var));
         }
-
-        assert(r.is_bv());
-        uint64_t val = 0;
-        if (Z3_get_numeral_uint64(ctx_, r, &val) && val <= std::numeric_limits<uint64_t>::max())
-          return result_wrapper(val, r.get_sort().bv_size());
-
-        std::string str = Z3_ast_to_string(ctx_, r);
-        assert(str.find("#b") == 0);
-        return result_wrapper(str.substr(2));
+        return values;
       }
 
-      void assertion(result_type const &e) { solver_.add(static_cast<z3::expr const &>(e)); }
+      void assertion(result_type const &e) {
+        model_.reset();
+        solver_.add(static_cast<z3::expr const &>(e));
+      }
 
-      void assumption(result_type const &e) { assumption_ = (*this)(predtags::and_tag(), assumption_, e); }
+      void assumption(result_type const &e) { assumptions_.push_back(e); }
 
       unsigned get_bv_width(result_type const &e) {
         z3::expr r = z3::expr(e);
         return r.is_bv() ? r.get_sort().bv_size() : 0;
       }
 
-      bool solve() {
-        solver_.push();
-        assertion(assumption_);
-        z3::check_result result = solver_.check(ctx_);
-        // std::cerr << result << '\n';
-        solver_.pop();
-        assumption_ = (*this)(predtags::true_tag(), std::any());
-        return (result == z3::sat);
+      bool solve() { return check() == z3::sat; }
+
+      /**
+       * The timeout and conflict limit map to the "timeout" and
+       * "max_conflicts" solver parameters. Z3 has no propagation limit.
+       **/
+      tribool command(solve_limited_cmd const &, budget const &b) {
+        unsigned const unlimited = std::numeric_limits<unsigned>::max();
+        set_limits(b.timeout.count() > 0 ? to_limit(b.timeout.count()) : unlimited,
+                   b.conflicts ? to_limit(b.conflicts) : unlimited);
+        z3::check_result const result = check();
+        set_limits(unlimited, unlimited);
+
+        switch (result) {
+          case z3::sat:
+            return true;
+          case z3::unsat:
+            return false;
+          default:
+            return indeterminate;
+        }
       }
 
       result_type operator()(predtags::var_tag const &var, std::any) {
@@ -588,21 +610,366 @@ namespace metaSMT {
       void command(stack_push const &, unsigned howmany) {
         while (howmany > 0) {
           solver_.push();
+          ++scopes_;
           --howmany;
         }
       }
 
-      void command(stack_pop const &, unsigned howmany) { solver_.pop(howmany); }
+      /// forgets the indicators whose definitions are popped
+      void command(stack_pop const &, unsigned howmany) {
+        solver_.pop(howmany);
+        scopes_ -= std::min(howmany, scopes_);
+        for (auto it = indicators_.begin(); it != indicators_.end();) {
+          if (it->second.scope > scopes_) {
+            it = indicators_.erase(it);
+          } else {
+            ++it;
+          }
+        }
+      }
+
+      /**
+       * Interrupts the solver only, an interrupt of the context outside of a
+       * check stays pending and silently drops the next assertion. The
+       * optimizer has no interrupt of its own and gets the interrupt of the
+       * context only while it optimizes.
+       **/
+      void command(interrupt_cmd const &) {
+        std::lock_guard<std::mutex> lock(interrupt_mutex_);
+        if (optimizing_) {
+          ctx_.interrupt();
+        } else {
+          Z3_solver_interrupt(ctx_, solver_);
+        }
+      }
+
+      /**
+       * Optimizes with a z3::optimize that is created on the first call and
+       * receives the assertions of the solver for each call. The objective
+       * and the pending assumptions only apply to this call.
+       **/
+      bool command(minimize_cmd const &, result_type const &objective) {
+        begin_optimize();
+        optimize_->minimize(objective);
+        return check_optimize();
+      }
+
+      bool command(maximize_cmd const &, result_type const &objective) {
+        begin_optimize();
+        optimize_->maximize(objective);
+        return check_optimize();
+      }
+
+      bool command(maxsat_cmd const &, std::vector<result_type> const &soft, std::vector<uint64_t> const &weights) {
+        begin_optimize();
+        for (std::size_t i = 0; i < soft.size(); ++i) {
+          optimize_->add_soft(soft[i], std::to_string(weights[i]).c_str());
+        }
+        return check_optimize();
+      }
+
+      /// cardinality constraints with the pseudo-Boolean theory of Z3
+      result_type command(cardinality_cmd const &, cardtags::lt_tag const &, std::vector<result_type> const &ps,
+                          unsigned k) {
+        if (k == 0) return ctx_.bool_val(false);
+        return z3::atmost(vector(ps), k - 1);
+      }
+
+      result_type command(cardinality_cmd const &, cardtags::le_tag const &, std::vector<result_type> const &ps,
+                          unsigned k) {
+        return z3::atmost(vector(ps), k);
+      }
+
+      result_type command(cardinality_cmd const &, cardtags::eq_tag const &, std::vector<result_type> const &ps,
+                          unsigned k) {
+        z3::expr_vector const es = vector(ps);
+        return z3::atmost(es, k) && z3::atleast(es, k);
+      }
+
+      result_type command(cardinality_cmd const &, cardtags::ge_tag const &, std::vector<result_type> const &ps,
+                          unsigned k) {
+        return z3::atleast(vector(ps), k);
+      }
+
+      result_type command(cardinality_cmd const &, cardtags::gt_tag const &, std::vector<result_type> const &ps,
+                          unsigned k) {
+        return z3::atleast(vector(ps), k + 1);
+      }
+
+      result_type command(pseudo_boolean_cmd const &, cardtags::lt_tag const &, std::vector<result_type> const &ps,
+                          std::vector<int64_t> const &weights, int64_t k) {
+        std::vector<int> const ws = coefficients(weights);
+        return z3::pble(vector(ps), ws.data(), coefficient(k - 1));
+      }
+
+      result_type command(pseudo_boolean_cmd const &, cardtags::le_tag const &, std::vector<result_type> const &ps,
+                          std::vector<int64_t> const &weights, int64_t k) {
+        std::vector<int> const ws = coefficients(weights);
+        return z3::pble(vector(ps), ws.data(), coefficient(k));
+      }
+
+      result_type command(pseudo_boolean_cmd const &, cardtags::eq_tag const &, std::vector<result_type> const &ps,
+                          std::vector<int64_t> const &weights, int64_t k) {
+        std::vector<int> const ws = coefficients(weights);
+        return z3::pbeq(vector(ps), ws.data(), coefficient(k));
+      }
+
+      result_type command(pseudo_boolean_cmd const &, cardtags::ge_tag const &, std::vector<result_type> const &ps,
+                          std::vector<int64_t> const &weights, int64_t k) {
+        std::vector<int> const ws = coefficients(weights);
+        return z3::pbge(vector(ps), ws.data(), coefficient(k));
+      }
+
+      result_type command(pseudo_boolean_cmd const &, cardtags::gt_tag const &, std::vector<result_type> const &ps,
+                          std::vector<int64_t> const &weights, int64_t k) {
+        std::vector<int> const ws = coefficients(weights);
+        return z3::pbge(vector(ps), ws.data(), coefficient(k + 1));
+      }
+
+      std::vector<unsigned> command(get_unsat_core_cmd const &) {
+        std::vector<unsigned> core;
+        if (!last_unsat_) return core;
+
+        std::set<unsigned> failed;
+        z3::expr_vector const z3_core = solver_.unsat_core();
+        for (unsigned i = 0; i < z3_core.size(); ++i) {
+          failed.insert(z3_core[i].id());
+        }
+        for (unsigned i = 0; i < last_literals_.size(); ++i) {
+          if (failed.count(last_literals_[i].id())) {
+            core.push_back(i);
+          }
+        }
+        return core;
+      }
 
      private:
+      z3::check_result check() {
+        // check with assumptions instead of push()/pop(), which keeps the
+        // lemmas of the solver and push() would fail on a pending interrupt
+        last_literals_.clear();
+        model_.reset();
+        ++checks_;
+
+        z3::expr_vector assumptions(ctx_);
+        for (result_type const &e : assumptions_) {
+          last_literals_.push_back(literal(e));
+          assumptions.push_back(last_literals_.back());
+        }
+        assumptions_.clear();
+        retire_indicators();
+        z3::check_result result = solver_.check(assumptions);
+        last_unsat_ = (result == z3::unsat);
+        return result;
+      }
+
+      /**
+       * e if it is a Boolean variable or its negation, otherwise an
+       * indicator variable that implies e. The indicators are defined once
+       * per expression and reused by later checks, see retire_indicators().
+       */
+      z3::expr literal(z3::expr const &e) {
+        z3::expr const atom = e.is_not() ? e.arg(0) : e;
+        if (atom.is_const() && atom.decl().decl_kind() == Z3_OP_UNINTERPRETED) return e;
+
+        auto it = indicators_.find(e.id());
+        if (it == indicators_.end()) {
+          z3::expr const a = z3::to_expr(ctx_, Z3_mk_fresh_const(ctx_, "assumption", ctx_.bool_sort()));
+          solver_.add(z3::implies(a, e));
+          it = indicators_.emplace(e.id(), indicator{e, a, scopes_, checks_}).first;
+        }
+        it->second.used = checks_;
+        return it->second.literal;
+      }
+
+      /**
+       * Keeps at most indicator_capacity indicators. Beyond that, retires
+       * the least recently used ones down to half the capacity: each is
+       * asserted false, which lets the solver drop its definition, and
+       * forgotten. Indicators of the current check are kept.
+       */
+      void retire_indicators() {
+        if (indicators_.size() <= indicator_capacity) return;
+
+        std::vector<std::unordered_map<unsigned, indicator>::iterator> old;
+        for (auto it = indicators_.begin(); it != indicators_.end(); ++it) {
+          if (it->second.used < checks_) old.push_back(it);
+        }
+        std::sort(old.begin(), old.end(), [](auto const &a, auto const &b) { return a->second.used < b->second.used; });
+        for (auto const &it : old) {
+          if (indicators_.size() <= indicator_capacity / 2) break;
+          solver_.add(!it->second.literal);
+          indicators_.erase(it);
+        }
+      }
+
+      /// the model of the last check or optimization, fetched once
+      z3::model &model() {
+        if (!model_) model_ = solver_.get_model();
+        return *model_;
+      }
+
+      result_wrapper value(z3::model &m, result_type const &var) {
+        z3::expr r = m.eval(z3::expr(var), /* completion = */ true);
+
+        // predicate
+        if (r.is_bool()) {
+          Z3_lbool b = Z3_get_bool_value(ctx_, r);
+          if (b == Z3_L_FALSE) return result_wrapper(false);
+          if (b == Z3_L_TRUE) return result_wrapper(true);
+          return result_wrapper();
+        }
+
+        assert(r.is_bv());
+        uint64_t val = 0;
+        if (Z3_get_numeral_uint64(ctx_, r, &val) && val <= std::numeric_limits<uint64_t>::max())
+          return result_wrapper(val, r.get_sort().bv_size());
+
+        std::string str = Z3_ast_to_string(ctx_, r);
+        assert(str.find("#b") == 0);
+        return result_wrapper(str.substr(2));
+      }
+
+      z3::expr_vector vector(std::vector<result_type> const &ps) {
+        z3::expr_vector es(ctx_);
+        for (result_type const &p : ps) {
+          es.push_back(p);
+        }
+        return es;
+      }
+
+      static int coefficient(int64_t c) {
+        if (c < std::numeric_limits<int>::min() || c > std::numeric_limits<int>::max()) {
+          assert(false && "pseudo-Boolean coefficient exceeds int");
+          throw std::exception();
+        }
+        return static_cast<int>(c);
+      }
+
+      static std::vector<int> coefficients(std::vector<int64_t> const &cs) {
+        std::vector<int> r;
+        r.reserve(cs.size());
+        for (int64_t c : cs) {
+          r.push_back(coefficient(c));
+        }
+        return r;
+      }
+
+      /**
+       * opens a scope of the optimizer for one call with the current
+       * assertions of the solver, the assumptions become hard constraints
+       **/
+      void begin_optimize() {
+        last_literals_.clear();
+        model_.reset();
+        last_unsat_ = false;
+
+        if (!optimize_) optimize_.emplace(ctx_);
+        optimize_->push();
+        z3::expr_vector const asserted = solver_.assertions();
+        for (unsigned i = 0; i < asserted.size(); ++i) {
+          optimize_->add(asserted[i]);
+        }
+        for (result_type const &e : assumptions_) {
+          optimize_->add(static_cast<z3::expr const &>(e));
+        }
+        assumptions_.clear();
+      }
+
+      /// checks and closes the scope of begin_optimize(), which drops the objectives
+      bool check_optimize() {
+        set_optimizing(true);
+        z3::check_result result;
+        try {
+          result = optimize_->check();
+        } catch (z3::exception const &) {
+          set_optimizing(false);
+          optimize_->pop();
+          throw;
+        }
+        set_optimizing(false);
+        bool const sat = result == z3::sat;
+        if (sat) model_ = optimize_->get_model();
+        optimize_->pop();
+        return sat;
+      }
+
+      /// directs interrupt_cmd to the optimizer while optimize_->check() runs
+      void set_optimizing(bool optimizing) {
+        std::lock_guard<std::mutex> lock(interrupt_mutex_);
+        optimizing_ = optimizing;
+      }
+
+      void set_limits(unsigned timeout, unsigned conflicts) {
+        z3::params p(ctx_);
+        p.set("timeout", timeout);
+        p.set("max_conflicts", conflicts);
+        solver_.set(p);
+      }
+
+      template <typename T>
+      static unsigned to_limit(T value) {
+        return static_cast<unsigned>(std::min<uint64_t>(value, std::numeric_limits<unsigned>::max()));
+      }
+
       z3::context ctx_;
       z3::solver solver_;
-      result_type assumption_;
+      /// the optimizer, created by the first optimization, empty between them
+      std::optional<z3::optimize> optimize_;
+      /// guards optimizing_ against interrupts from other threads
+      std::mutex interrupt_mutex_;
+      bool optimizing_;
+      struct indicator {
+        /// keeps the id of the assumption from being reused
+        z3::expr assumption;
+        z3::expr literal;
+        /// the stack depth of the definition
+        unsigned scope;
+        /// the last check using the indicator
+        uint64_t used;
+      };
+      static unsigned const indicator_capacity = 1024;
+
+      std::vector<result_type> assumptions_;
+      /// the assumption literals of the last check
+      std::vector<z3::expr> last_literals_;
+      bool last_unsat_;
+      unsigned scopes_;
+      /// number of checks so far
+      uint64_t checks_;
+      /// indicators of the assumptions that are no literals, by AST id
+      std::unordered_map<unsigned, indicator> indicators_;
+      /// the model of the last check or optimization, reset by assertions
+      std::optional<z3::model> model_;
     };  // Z3_Backend
   }     // namespace solver
 
   namespace features {
     template <>
     struct supports<solver::Z3_Backend, features::stack_api> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, features::cardinality_api> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, interrupt_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, solve_limited_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, get_unsat_core_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, minimize_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, maximize_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, maxsat_cmd> : std::true_type {};
+
+    template <>
+    struct supports<solver::Z3_Backend, read_values_cmd> : std::true_type {};
   }  // namespace features
 }  // namespace metaSMT
@@ -2,6 +2,13 @@
 
 namespace metaSMT {
   namespace impl {
+    /**
+     * @brief process-wide unique id for frontend variables
+     *
+     * Ids are unique across all contexts and threads but not dense, use them
+     * only to identify frontend variables. Backends that need dense numbering
+     * (e.g. SAT literals) allocate ids locally, see SAT_Clause::new_lit().
+     **/
     unsigned new_var_id();
   }  // namespace impl
 }  // namespace metaSMT
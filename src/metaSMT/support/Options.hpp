@@ -1,13 +1,314 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
+#include <exception>
 #include <map>
 #include <memory>
+#include <optional>
+#include <string>
 
 #include "../API/Options.hpp"
 
 namespace metaSMT {
   struct Options;
 
+  namespace option {
+    /// encodings of support/cardinality, automatic selects native or bdd
+    enum class cardinality_encoding {
+      automatic,
+      native,
+      bdd,
+      adder,
+      totalizer,
+      modulo_totalizer,
+      sequential_counter,
+      sorting_network
+    };
+
+    /// encodings of support/pseudo_boolean, automatic selects native or bdd
+    enum class pseudo_boolean_encoding { automatic, native, bdd, gte, binary_merge, adder };
+
+    /// encodings of support/amo, automatic selects by the number of inputs
+    enum class at_most_one_encoding { automatic, pairwise, ladder, commander, product, bimander };
+
+    /// bit-vector multipliers of BitBlast
+    enum class bv_multiplier { shift_add, wallace };
+
+    /// bit-vector dividers of BitBlast
+    enum class bv_divider { shift_subtract, restoring };
+
+    /// arithmetic of model counting and uniform sampling in CUDD_Distributed
+    enum class counting_precision { log_space, exact };
+
+    /// static variable order of the CUDD backends, see API/VariableOrder.hpp
+    enum class variable_order { creation, interleave, force };
+
+    /// dynamic reordering method of the CUDD backends
+    enum class reordering_method { sift, sift_converge, symm_sift, group_sift, window, none };
+
+    /// how CUDD_Context conjoins the assertions
+    enum class conjunction_mode { eager, partitioned };
+
+    inline void parse(std::string const &value, cardinality_encoding &e) {
+      if (value == "" || value == "auto") {
+        e = cardinality_encoding::automatic;
+      } else if (value == "native") {
+        e = cardinality_encoding::native;
+      } else if (value == "bdd") {
+        e = cardinality_encoding::bdd;
+      } else if (value == "adder") {
+        e = cardinality_encoding::adder;
+      } else if (value == "totalizer") {
+        e = cardinality_encoding::totalizer;
+      } else if (value == "modulo_totalizer") {
+        e = cardinality_encoding::modulo_totalizer;
+      } else if (value == "sequential_counter") {
+        e = cardinality_encoding::sequential_counter;
+      } else if (value == "sorting_network") {
+        e = cardinality_encoding::sorting_network;
+      } else {
+        assert(false && "Unknown cardinality implementation");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, pseudo_boolean_encoding &e) {
+      if (value == "" || value == "auto") {
+        e = pseudo_boolean_encoding::automatic;
+      } else if (value == "native") {
+        e = pseudo_boolean_encoding::native;
+      } else if (value == "bdd") {
+        e = pseudo_boolean_encoding::bdd;
+      } else if (value == "gte") {
+        e = pseudo_boolean_encoding::gte;
+      } else if (value == "binary_merge") {
+        e = pseudo_boolean_encoding::binary_merge;
+      } else if (value == "adder") {
+        e = pseudo_boolean_encoding::adder;
+      } else {
+        assert(false && "Unknown pseudo-Boolean implementation");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, at_most_one_encoding &e) {
+      if (value == "" || value == "auto") {
+        e = at_most_one_encoding::automatic;
+      } else if (value == "pairwise") {
+        e = at_most_one_encoding::pairwise;
+      } else if (value == "ladder") {
+        e = at_most_one_encoding::ladder;
+      } else if (value == "commander") {
+        e = at_most_one_encoding::commander;
+      } else if (value == "product") {
+        e = at_most_one_encoding::product;
+      } else if (value == "bimander") {
+        e = at_most_one_encoding::bimander;
+      } else {
+        assert(false && "Unknown at-most-one implementation");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, bv_multiplier &e) {
+      if (value == "shift_add") {
+        e = bv_multiplier::shift_add;
+      } else if (value == "wallace") {
+        e = bv_multiplier::wallace;
+      } else {
+        assert(false && "Unknown multiplier implementation");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, bv_divider &e) {
+      if (value == "shift_subtract") {
+        e = bv_divider::shift_subtract;
+      } else if (value == "restoring") {
+        e = bv_divider::restoring;
+      } else {
+        assert(false && "Unknown divider implementation");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, counting_precision &e) {
+      if (value == "log_space") {
+        e = counting_precision::log_space;
+      } else if (value == "exact") {
+        e = counting_precision::exact;
+      } else {
+        assert(false && "Unknown counting precision");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, variable_order &e) {
+      if (value == "creation") {
+        e = variable_order::creation;
+      } else if (value == "interleave") {
+        e = variable_order::interleave;
+      } else if (value == "force") {
+        e = variable_order::force;
+      } else {
+        assert(false && "Unknown variable order");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, reordering_method &e) {
+      if (value == "sift") {
+        e = reordering_method::sift;
+      } else if (value == "sift_converge") {
+        e = reordering_method::sift_converge;
+      } else if (value == "symm_sift") {
+        e = reordering_method::symm_sift;
+      } else if (value == "group_sift") {
+        e = reordering_method::group_sift;
+      } else if (value == "window") {
+        e = reordering_method::window;
+      } else if (value == "none") {
+        e = reordering_method::none;
+      } else {
+        assert(false && "Unknown reordering method");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, conjunction_mode &e) {
+      if (value == "eager") {
+        e = conjunction_mode::eager;
+      } else if (value == "partitioned") {
+        e = conjunction_mode::partitioned;
+      } else {
+        assert(false && "Unknown conjunction mode");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, std::optional<bool> &e) {
+      if (value == "1" || value == "true") {
+        e = true;
+      } else if (value == "0" || value == "false") {
+        e = false;
+      } else {
+        assert(false && "Unknown Boolean value");
+        throw std::exception();
+      }
+    }
+
+    inline void parse(std::string const &value, std::optional<int> &e) { e = std::stoi(value); }
+
+    inline void parse(std::string const &value, std::optional<double> &e) { e = std::stod(value); }
+
+    inline void parse(std::string const &value, std::optional<std::uint64_t> &e) { e = std::stoull(value); }
+
+    /**
+     * The options with a fixed type, parsed once when they are set.
+     * Unset SAT and CUDD options keep the defaults of the solver.
+     */
+    struct Typed {
+      cardinality_encoding cardinality = cardinality_encoding::automatic;
+      pseudo_boolean_encoding pseudo_boolean = pseudo_boolean_encoding::automatic;
+      at_most_one_encoding at_most_one = at_most_one_encoding::automatic;
+      bv_multiplier multiplier = bv_multiplier::shift_add;
+      bv_divider divider = bv_divider::shift_subtract;
+      counting_precision counting = counting_precision::log_space;
+      variable_order order = variable_order::creation;
+      reordering_method reordering = reordering_method::sift;
+      conjunction_mode conjunction = conjunction_mode::eager;
+
+      std::optional<double> sat_var_decay;
+      std::optional<double> sat_clause_decay;
+      std::optional<double> sat_random_var_freq;
+      std::optional<int> sat_phase_saving;
+      std::optional<int> sat_ccmin_mode;
+      std::optional<bool> sat_luby_restart;
+      std::optional<int> sat_restart_first;
+
+      std::optional<std::uint64_t> cudd_unique_slots;
+      std::optional<std::uint64_t> cudd_cache_slots;
+      std::optional<std::uint64_t> cudd_max_memory;
+      std::optional<std::uint64_t> cudd_max_cache_hard;
+      std::optional<std::uint64_t> cudd_loose_up_to;
+
+      /// parses value if key is a typed option, returns whether it is
+      bool set(std::string const &key, std::string const &value) {
+        if (key == "cardinality") {
+          parse(value, cardinality);
+        } else if (key == "pseudo_boolean") {
+          parse(value, pseudo_boolean);
+        } else if (key == "at_most_one") {
+          parse(value, at_most_one);
+        } else if (key == "multiplier") {
+          parse(value, multiplier);
+        } else if (key == "divider") {
+          parse(value, divider);
+        } else if (key == "counting") {
+          parse(value, counting);
+        } else if (key == "cudd.order") {
+          parse(value, order);
+        } else if (key == "cudd.reordering") {
+          parse(value, reordering);
+        } else if (key == "cudd.conjunction") {
+          parse(value, conjunction);
+        } else if (key == "sat.var_decay") {
+          parse(value, sat_var_decay);
+        } else if (key == "sat.clause_decay") {
+          parse(value, sat_clause_decay);
+        } else if (key == "sat.random_var_freq") {
+          parse(value, sat_random_var_freq);
+        } else if (key == "sat.phase_saving") {
+          parse(value, sat_phase_saving);
+        } else if (key == "sat.ccmin_mode") {
+          parse(value, sat_ccmin_mode);
+        } else if (key == "sat.luby_restart") {
+          parse(value, sat_luby_restart);
+        } else if (key == "sat.restart_first") {
+          parse(value, sat_restart_first);
+        } else if (key == "cudd.unique_slots") {
+          parse(value, cudd_unique_slots);
+        } else if (key == "cudd.cache_slots") {
+          parse(value, cudd_cache_slots);
+        } else if (key == "cudd.max_memory") {
+          parse(value, cudd_max_memory);
+        } else if (key == "cudd.max_cache_hard") {
+          parse(value, cudd_max_cache_hard);
+        } else if (key == "cudd.loose_up_to") {
+          parse(value, cudd_loose_up_to);
+        } else {
+          return false;
+        }
+        return true;
+      }
+    };  // Typed
+
+    /**
+     * Key of a typed option, e.g.
+     *
+     * \code
+     *  option::cardinality_encoding e = get_option(ctx, option::cardinality());
+     * \endcode
+     */
+    template <typename T, T Typed::*Member>
+    struct key {
+      typedef T value_type;
+
+      static T const &get(Typed const &typed) { return typed.*Member; }
+    };
+
+    typedef key<cardinality_encoding, &Typed::cardinality> cardinality;
+    typedef key<pseudo_boolean_encoding, &Typed::pseudo_boolean> pseudo_boolean;
+    typedef key<at_most_one_encoding, &Typed::at_most_one> at_most_one;
+    typedef key<bv_multiplier, &Typed::multiplier> multiplier;
+    typedef key<bv_divider, &Typed::divider> divider;
+    typedef key<counting_precision, &Typed::counting> counting;
+    typedef key<variable_order, &Typed::order> order;
+    typedef key<reordering_method, &Typed::reordering> reordering;
+    typedef key<conjunction_mode, &Typed::conjunction> conjunction;
+  }  // namespace option
+
   namespace option {
     struct NOPCommand {
       template <typename SolverType, typename T1>
@@ -41,16 +342,26 @@ namespace metaSMT {
     };  // SetOptionCommand
   }     // namespace option
 
+  /**
+   * String options shared by all copies. Options of option::Typed are
+   * additionally parsed into their typed values when they are set, reading
+   * them costs no lookup.
+   */
   struct Options {
     typedef std::map<std::string, std::string> Map;
     typedef std::shared_ptr<Map> SharedMap;
 
-    Options() : map(new Map()) {}
+    Options() : map(new Map()), typed(new option::Typed()) {}
 
-    Options(Map const &map) : map(new Map(map)) {}
+    Options(Map const &map) : map(new Map(map)), typed(new option::Typed()) {
+      for (Map::const_iterator it = map.begin(); it != map.end(); ++it) {
+        typed->set(it->first, it->second);
+      }
+    }
 
     void set(std::string const &key, std::string const &value) {
       assert(map != 0);
+      typed->set(key, value);
       (*map)[key] = value;
     }
 
@@ -76,6 +387,12 @@ namespace metaSMT {
       return default_value;
     }
 
+    template <typename T, T option::Typed::*Member>
+    T get(option::key<T, Member> const &) const {
+      return option::key<T, Member>::get(*typed);
+    }
+
     SharedMap map;
+    std::shared_ptr<option::Typed> typed;
   };  // Options
 }  // namespace metaSMT
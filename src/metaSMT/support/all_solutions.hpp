@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "../API/AllSolutions.hpp"
+#include "../API/Assertion.hpp"
+#include "../API/Assumption.hpp"
+#include "../Features.hpp"
+#include "../tags/Logic.hpp"
+#include "../tags/QF_BV.hpp"
+
+namespace metaSMT {
+
+  namespace detail {
+    /**
+     * Enumerates by solve() and a blocking clause over the projected bits
+     * per solution. The clauses are guarded by a fresh variable that is
+     * only assumed during the enumeration, afterwards they are void. The
+     * pending assumptions are repeated for every solution.
+     */
+    template <typename Context>
+    std::uint64_t for_each_solution_blocking(Context &ctx, std::vector<typename Context::result_type> const &vars,
+                                             std::function<void()> const &f, std::uint64_t limit) {
+      typedef typename Context::result_type result_type;
+      namespace bvtags = logic::QF_BV::tag;
+
+      std::vector<result_type> bits;
+      for (result_type const &v : vars) {
+        unsigned const width = ctx.get_bv_width(v);
+        if (width == 0) {
+          bits.push_back(v);
+        }
+        for (unsigned i = 0; i < width; ++i) {
+          bits.push_back(
+              ctx(logic::tag::equal_tag{}, ctx(bvtags::extract_tag{}, i, i, v), ctx(bvtags::bit1_tag{})));
+        }
+      }
+
+      std::vector<result_type> assumptions;
+      if constexpr (features::supports<Context, pending_assumptions_cmd<result_type> >::value) {
+        assumptions = ctx.command(pending_assumptions_cmd<result_type>());
+      }
+      result_type const enabled = ctx(logic::new_variable());
+      std::vector<bool> values(bits.size());
+      std::uint64_t n = 0;
+      for (; n < limit; ++n) {
+        for (result_type const &a : assumptions) {
+          metaSMT::assumption(ctx, a);
+        }
+        metaSMT::assumption(ctx, enabled);
+        if (!solve(ctx)) break;
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+          values[i] = static_cast<bool>(read_value(ctx, bits[i]));
+        }
+        f();
+
+        result_type block = ctx(logic::tag::not_tag{}, enabled);
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+          result_type const differs = values[i] ? ctx(logic::tag::not_tag{}, bits[i]) : bits[i];
+          block = ctx(logic::tag::or_tag{}, block, differs);
+        }
+        metaSMT::assertion(ctx, block);
+      }
+      return n;
+    }
+  }  // namespace detail
+
+  /**
+   * @brief enumerate all solutions projected onto vars
+   *
+   * Calls f once per assignment of the Boolean and bit-vector variables
+   * in vars that extends to a solution of the assertions and pending
+   * assumptions, at most limit times. In f, read_value() returns the
+   * assignment of vars, the other variables hold some extension. f must
+   * not add constraints or call solve().
+   *
+   * \code
+   *  bitvector opcode = new_bitvector(8);
+   *  ...
+   *  std::uint64_t n = for_each_solution(ctx, {ctx(opcode)}, [&] {
+   *    unsigned value = read_value(ctx, opcode);
+   *  });
+   * \endcode
+   *
+   * Contexts supporting for_each_solution_cmd enumerate natively, CUDD
+   * by the cubes of the projected BDD and the clause-based SAT backends
+   * by blocking clauses added to the solver directly, generalized to
+   * cubes if the SAT solver supports lift_cmd. Other contexts add
+   * one blocking clause per solution through the context. The pending
+   * assumptions restrict the whole enumeration and are consumed by it,
+   * like by solve().
+   *
+   * @returns the number of solutions enumerated
+   *
+   * @ingroup Support
+   * @defgroup AllSolutions All solutions
+   * @{
+   **/
+  template <typename Context>
+  std::uint64_t for_each_solution(Context &ctx, std::vector<typename Context::result_type> const &vars,
+                                  std::function<void()> const &f,
+                                  std::uint64_t limit = std::numeric_limits<std::uint64_t>::max()) {
+    if constexpr (features::supports<Context, for_each_solution_cmd>::value) {
+      return ctx.command(for_each_solution_cmd(), vars, f, limit);
+    } else {
+      return detail::for_each_solution_blocking(ctx, vars, f, limit);
+    }
+  }
+  /**@}*/
+}  // namespace metaSMT
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cassert>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "../../API/Evaluator.hpp"
+#include "../../API/Options.hpp"
+#include "../Options.hpp"
+#include "bimander_impl.hpp"
+#include "commander_impl.hpp"
+#include "ladder_impl.hpp"
+#include "object.hpp"
+#include "pairwise_impl.hpp"
+#include "product_impl.hpp"
+
+namespace metaSMT {
+  namespace amo {
+
+    /// pairwise up to 6 inputs, commander up to 64, product above
+    inline option::at_most_one_encoding automatic(std::size_t n) {
+      if (n <= 6) return option::at_most_one_encoding::pairwise;
+      if (n <= 64) return option::at_most_one_encoding::commander;
+      return option::at_most_one_encoding::product;
+    }
+
+    template <typename Context>
+    typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps,
+                                              option::at_most_one_encoding encoding) {
+      switch (encoding == option::at_most_one_encoding::automatic ? automatic(ps.size()) : encoding) {
+        case option::at_most_one_encoding::pairwise:
+          return pairwise::at_most_one(ctx, ps);
+        case option::at_most_one_encoding::ladder:
+          return ladder::at_most_one(ctx, ps);
+        case option::at_most_one_encoding::commander:
+          return commander::at_most_one(ctx, ps);
+        case option::at_most_one_encoding::product:
+          return product::at_most_one(ctx, ps);
+        case option::at_most_one_encoding::bimander:
+          return bimander::at_most_one(ctx, ps);
+        default:
+          assert(false && "Unknown at-most-one implementation");
+          throw std::exception();
+      }
+    }
+  }  // namespace amo
+
+  /**
+   * Evaluates at-most-one and exactly-one constraints with the encoding
+   * given by the constraint or the "at_most_one" option: "pairwise",
+   * "ladder", "commander", "product" or "bimander". By default the
+   * encoding is chosen by the number of inputs, see amo::automatic().
+   */
+  template <typename Boolean>
+  struct Evaluator<amo::AtMostOne<Boolean> > : public std::true_type {
+    template <typename Context>
+    static typename Context::result_type eval(Context &ctx, amo::AtMostOne<Boolean> const &c) {
+      std::vector<typename Context::result_type> ps;
+      ps.reserve(c.ps.size());
+      for (Boolean const &p : c.ps) ps.push_back(ctx(p));
+
+      option::at_most_one_encoding enc = get_option(ctx, option::at_most_one());
+      if (!c.encoding.empty()) {
+        option::parse(c.encoding, enc);
+      }
+
+      typename Context::result_type const r = amo::at_most_one(ctx, ps, enc);
+      if (!c.exactly) return r;
+      return ctx(logic::tag::and_tag{}, amo::any(ctx, ps, 0, ps.size()), r);
+    }
+  };  // Evaluator
+}  // namespace metaSMT
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../../tags/Logic.hpp"
+#include "pairwise_impl.hpp"
+
+namespace metaSMT {
+  namespace amo {
+    namespace bimander {
+
+      /**
+       * Bimander encoding by Nguyen and Mai [1]
+       *
+       * The inputs are split into groups of two that are constrained
+       * pairwise. Group i is identified by the binary code of i over
+       * log2(n/2) bits b[k], where b[k] is the disjunction of the groups
+       * with bit k set. An input of group i excludes every b[k] with bit k
+       * of i unset,
+       *
+       *    AND_{p in group i, bit k of i unset} not (p & b[k])
+       *
+       * so two true inputs of different groups conflict on a bit where
+       * their codes differ. Defining b[k] by the groups keeps the formula
+       * equivalent to at-most-one without free auxiliary variables.
+       *
+       * [1] V. H. Nguyen and S. T. Mai. A new method to encode the
+       * at-most-one constraint into SAT. In Sixth International Symposium
+       * on Information and Communication Technology (SoICT), 2015.
+       */
+      template <typename Context>
+      typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps) {
+        std::size_t const group_size = 2;
+        if (ps.size() <= 6) return pairwise::at_most_one(ctx, ps);
+
+        std::size_t const groups = (ps.size() + group_size - 1) / group_size;
+        unsigned bits = 0;
+        while ((std::size_t(1) << bits) < groups) ++bits;
+
+        std::vector<typename Context::result_type> fs;
+        std::vector<std::vector<typename Context::result_type> > bit_ps(bits);
+        for (std::size_t g = 0; g < groups; ++g) {
+          std::size_t const begin = g * group_size;
+          std::size_t const end = std::min(begin + group_size, ps.size());
+          fs.push_back(pairwise::at_most_one(ctx, ps, begin, end));
+          for (unsigned k = 0; k < bits; ++k) {
+            if ((g >> k) & 1) bit_ps[k].insert(bit_ps[k].end(), ps.begin() + begin, ps.begin() + end);
+          }
+        }
+
+        for (unsigned k = 0; k < bits; ++k) {
+          typename Context::result_type const b = any(ctx, bit_ps[k], 0, bit_ps[k].size());
+          for (std::size_t g = 0; g < groups; ++g) {
+            if ((g >> k) & 1) continue;
+            std::size_t const end = std::min((g + 1) * group_size, ps.size());
+            for (std::size_t i = g * group_size; i < end; ++i) {
+              fs.push_back(ctx(logic::tag::not_tag{}, ctx(logic::tag::and_tag{}, ps[i], b)));
+            }
+          }
+        }
+        return all(ctx, fs);
+      }
+    }  // namespace bimander
+  }    // namespace amo
+}  // namespace metaSMT
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "pairwise_impl.hpp"
+
+namespace metaSMT {
+  namespace amo {
+    namespace commander {
+
+      /**
+       * Commander encoding by Klieber and Kwon [1]
+       *
+       * The inputs are split into groups of three. Each group is
+       * constrained pairwise and represented by its commander, the
+       * disjunction of the group. The commanders are constrained
+       * recursively, down to pairwise for at most six of them.
+       *
+       * [1] W. Klieber and G. Kwon. Efficient CNF encoding for selecting 1
+       * from N objects. In Fourth Workshop on Constraints in Formal
+       * Verification (CFV), 2007.
+       */
+      template <typename Context>
+      typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps) {
+        std::size_t const group_size = 3;
+        if (ps.size() <= 2 * group_size) return pairwise::at_most_one(ctx, ps);
+
+        std::vector<typename Context::result_type> fs, commanders;
+        for (std::size_t begin = 0; begin < ps.size(); begin += group_size) {
+          std::size_t const end = std::min(begin + group_size, ps.size());
+          fs.push_back(pairwise::at_most_one(ctx, ps, begin, end));
+          commanders.push_back(any(ctx, ps, begin, end));
+        }
+        fs.push_back(commander::at_most_one(ctx, commanders));
+        return all(ctx, fs);
+      }
+    }  // namespace commander
+  }    // namespace amo
+}  // namespace metaSMT
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "../../tags/Logic.hpp"
+#include "pairwise_impl.hpp"
+
+namespace metaSMT {
+  namespace amo {
+    namespace ladder {
+
+      /**
+       * Ladder (sequential) encoding
+       *
+       *    AND_{i > 0} not (ps[i] & s[i-1])    with s[i] = ps[0] | ... | ps[i]
+       *
+       * where the prefixes s share their subformulas, linear in n.
+       */
+      template <typename Context>
+      typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps) {
+        if (ps.size() < 2) return ctx(true);
+
+        std::vector<typename Context::result_type> fs;
+        typename Context::result_type prefix = ps[0];
+        for (std::size_t i = 1; i < ps.size(); ++i) {
+          fs.push_back(ctx(logic::tag::not_tag{}, ctx(logic::tag::and_tag{}, ps[i], prefix)));
+          if (i + 1 < ps.size()) prefix = ctx(logic::tag::or_tag{}, prefix, ps[i]);
+        }
+        return all(ctx, fs);
+      }
+    }  // namespace ladder
+  }    // namespace amo
+}  // namespace metaSMT
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace metaSMT {
+  namespace amo {
+
+    /**
+     * At most one of ps is true, or exactly one if exactly is set.
+     */
+    template <typename Boolean>
+    struct AtMostOne {
+      AtMostOne(std::vector<Boolean> const &ps, bool const exactly, std::string const encoding = "")
+          : ps(ps), exactly(exactly), encoding(encoding) {}
+
+      std::vector<Boolean> const &ps;
+      bool const exactly;
+      std::string const encoding;
+    };  // AtMostOne
+
+    template <typename Boolean>
+    AtMostOne<Boolean> at_most_one(std::vector<Boolean> const &ps, std::string const encoding = "") {
+      return AtMostOne<Boolean>(ps, false, encoding);
+    }
+
+    template <typename Boolean>
+    AtMostOne<Boolean> exactly_one(std::vector<Boolean> const &ps, std::string const encoding = "") {
+      return AtMostOne<Boolean>(ps, true, encoding);
+    }
+
+  }  // namespace amo
+}  // namespace metaSMT
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "../../tags/Logic.hpp"
+
+namespace metaSMT {
+  namespace amo {
+
+    /// conjunction of fs, true if empty
+    template <typename Context>
+    typename Context::result_type all(Context &ctx, std::vector<typename Context::result_type> const &fs) {
+      if (fs.empty()) return ctx(true);
+      typename Context::result_type r = fs[0];
+      for (std::size_t i = 1; i < fs.size(); ++i) {
+        r = ctx(logic::tag::and_tag{}, r, fs[i]);
+      }
+      return r;
+    }
+
+    /// disjunction of ps[begin], ..., ps[end-1], false if empty
+    template <typename Context>
+    typename Context::result_type any(Context &ctx, std::vector<typename Context::result_type> const &ps,
+                                      std::size_t begin, std::size_t end) {
+      if (begin == end) return ctx(false);
+      typename Context::result_type r = ps[begin];
+      for (std::size_t i = begin + 1; i < end; ++i) {
+        r = ctx(logic::tag::or_tag{}, r, ps[i]);
+      }
+      return r;
+    }
+
+    namespace pairwise {
+
+      /**
+       * Pairwise (binomial) encoding
+       *
+       *    AND_{i < j} not (ps[i] & ps[j])
+       *
+       * with n(n-1)/2 terms and no auxiliary formulas, the smallest for
+       * few inputs and the base case of the other encodings.
+       */
+      template <typename Context>
+      typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps,
+                                                std::size_t begin, std::size_t end) {
+        std::vector<typename Context::result_type> fs;
+        for (std::size_t i = begin; i < end; ++i) {
+          for (std::size_t j = i + 1; j < end; ++j) {
+            fs.push_back(ctx(logic::tag::not_tag{}, ctx(logic::tag::and_tag{}, ps[i], ps[j])));
+          }
+        }
+        return all(ctx, fs);
+      }
+
+      template <typename Context>
+      typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps) {
+        return at_most_one(ctx, ps, 0, ps.size());
+      }
+    }  // namespace pairwise
+  }    // namespace amo
+}  // namespace metaSMT
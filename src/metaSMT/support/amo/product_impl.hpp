@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../../tags/Logic.hpp"
+#include "pairwise_impl.hpp"
+
+namespace metaSMT {
+  namespace amo {
+    namespace product {
+
+      /**
+       * Product encoding by Chen [1]
+       *
+       * The inputs are arranged in a grid of about sqrt(n) x sqrt(n)
+       * cells. At most one input is true iff at most one row and at most
+       * one column contain a true input. Rows and columns, the
+       * disjunctions of their inputs, are constrained recursively, giving
+       * 2 sqrt(n) + O(n^(1/4)) constrained formulas.
+       *
+       * [1] J. Chen. A new SAT encoding of the at-most-one constraint. In
+       * Tenth International Workshop on Constraint Modelling and
+       * Reformulation (ModRef), 2010.
+       */
+      template <typename Context>
+      typename Context::result_type at_most_one(Context &ctx, std::vector<typename Context::result_type> const &ps) {
+        if (ps.size() <= 6) return pairwise::at_most_one(ctx, ps);
+
+        std::size_t const columns = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(ps.size()))));
+        std::size_t const rows = (ps.size() + columns - 1) / columns;
+
+        std::vector<std::vector<typename Context::result_type> > column_ps(columns);
+        std::vector<typename Context::result_type> row_fs, column_fs;
+        for (std::size_t r = 0; r < rows; ++r) {
+          std::size_t const begin = r * columns;
+          std::size_t const end = std::min(begin + columns, ps.size());
+          row_fs.push_back(any(ctx, ps, begin, end));
+          for (std::size_t i = begin; i < end; ++i) column_ps[i - begin].push_back(ps[i]);
+        }
+        for (std::vector<typename Context::result_type> const &column : column_ps) {
+          column_fs.push_back(any(ctx, column, 0, column.size()));
+        }
+        return ctx(logic::tag::and_tag{}, product::at_most_one(ctx, row_fs), product::at_most_one(ctx, column_fs));
+      }
+    }  // namespace product
+  }    // namespace amo
+}  // namespace metaSMT
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "amo/Evaluator.hpp"
+#include "amo/object.hpp"
+
+namespace metaSMT {
+
+  /**
+   * @brief at-most-one and exactly-one constraints
+   *
+   * at_most_one(ctx, ps) holds if at most one of ps is true,
+   * exactly_one(ctx, ps) if exactly one is. The encoding is taken from
+   * the "at_most_one" option or given per constraint:
+   *
+   * \code
+   *  assertion(ctx, exactly_one(ctx, slots));
+   *  assertion(ctx, evaluate(ctx, amo::at_most_one(ps, "bimander")));
+   * \endcode
+   *
+   * @ingroup Support
+   */
+  template <typename Context, typename Boolean>
+  typename Context::result_type at_most_one(Context &ctx, std::vector<Boolean> const &ps) {
+    return ctx(amo::at_most_one(ps));
+  }
+
+  template <typename Context, typename Boolean>
+  typename Context::result_type exactly_one(Context &ctx, std::vector<Boolean> const &ps) {
+    return ctx(amo::exactly_one(ps));
+  }
+}  // namespace metaSMT
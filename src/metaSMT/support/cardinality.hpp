@@ -2,6 +2,11 @@
 
 #include "cardinality/adder_impl.hpp"
 #include "cardinality/bdd_impl.hpp"
+#include "cardinality/modulo_totalizer_impl.hpp"
+#include "cardinality/native_impl.hpp"
 #include "cardinality/object.hpp"
+#include "cardinality/sequential_counter_impl.hpp"
+#include "cardinality/sorting_network_impl.hpp"
+#include "cardinality/totalizer_impl.hpp"
 //#include "cardinality/Evaluator.hpp"
 #include "cardinality/deprecated_api.hpp"
@@ -3,9 +3,17 @@
 #include <optional>
 
 #include "../../API/Evaluator.hpp"
+#include "../../API/Options.hpp"
+#include "../Options.hpp"
+#include "../amo/Evaluator.hpp"
 #include "adder_impl.hpp"
 #include "bdd_impl.hpp"
+#include "modulo_totalizer_impl.hpp"
+#include "native_impl.hpp"
 #include "object.hpp"
+#include "sequential_counter_impl.hpp"
+#include "sorting_network_impl.hpp"
+#include "totalizer_impl.hpp"
 
 namespace metaSMT {
   namespace cardinality {
@@ -49,7 +57,7 @@ namespace metaSMT {
       typename Context::result_type res = ctx(true);
 
       if (nps <= cardinality) {
-        return std::optional<typename Context::result_type>(ctx, false);
+        return std::optional<typename Context::result_type>(ctx(false));
       }
 
       if (nps == cardinality + 1) {
@@ -136,8 +144,51 @@ namespace metaSMT {
                                                                       cardinality::Cardinality<Tag, Boolean> const &) {
       return std::optional<typename Context::result_type>();
     }
+
+    /// bounds of one, i.e. <= 1, < 2, = 1 and > 1, as at-most-one constraints
+    template <typename Context, typename Tag, typename Boolean>
+    std::optional<typename Context::result_type> at_most_one(Context &,
+                                                             cardinality::Cardinality<Tag, Boolean> const &) {
+      return std::optional<typename Context::result_type>();
+    }
+
+    template <typename Context, typename Boolean>
+    std::optional<typename Context::result_type> at_most_one(
+        Context &ctx, cardinality::Cardinality<cardtags::le_tag, Boolean> const &c) {
+      if (c.cardinality != 1) return std::optional<typename Context::result_type>();
+      return std::optional<typename Context::result_type>(ctx(amo::at_most_one(c.ps)));
+    }
+
+    template <typename Context, typename Boolean>
+    std::optional<typename Context::result_type> at_most_one(
+        Context &ctx, cardinality::Cardinality<cardtags::lt_tag, Boolean> const &c) {
+      if (c.cardinality != 2) return std::optional<typename Context::result_type>();
+      return std::optional<typename Context::result_type>(ctx(amo::at_most_one(c.ps)));
+    }
+
+    template <typename Context, typename Boolean>
+    std::optional<typename Context::result_type> at_most_one(
+        Context &ctx, cardinality::Cardinality<cardtags::eq_tag, Boolean> const &c) {
+      if (c.cardinality != 1) return std::optional<typename Context::result_type>();
+      return std::optional<typename Context::result_type>(ctx(amo::exactly_one(c.ps)));
+    }
+
+    template <typename Context, typename Boolean>
+    std::optional<typename Context::result_type> at_most_one(
+        Context &ctx, cardinality::Cardinality<cardtags::gt_tag, Boolean> const &c) {
+      if (c.cardinality != 1) return std::optional<typename Context::result_type>();
+      return std::optional<typename Context::result_type>(ctx(logic::tag::not_tag{}, ctx(amo::at_most_one(c.ps))));
+    }
   }  // namespace cardinality
 
+  /**
+   * Evaluates cardinality constraints with the encoding given by the
+   * constraint or the "cardinality" option: "native", "bdd", "adder",
+   * "totalizer", "modulo_totalizer", "sequential_counter" or
+   * "sorting_network". The default is "native" for contexts supporting
+   * features::cardinality_api, else "bdd", where bounds of one use the
+   * at-most-one encodings of support/amo.
+   */
   template <typename Tag, typename Boolean>
   struct Evaluator<cardinality::Cardinality<Tag, Boolean> > : public std::true_type {
     template <typename Context>
@@ -147,17 +198,40 @@ namespace metaSMT {
         return *r;
       }
 
-      std::string enc = c.encoding;
-      if (enc == "") {
-        enc = get_option(ctx, "cardinality", /* default = */ "bdd");
+      option::cardinality_encoding enc = get_option(ctx, option::cardinality());
+      if (!c.encoding.empty()) {
+        option::parse(c.encoding, enc);
       }
-      if (enc == "adder") {
-        return cardinality::adder::cardinality(ctx, c);
-      } else if (enc == "bdd") {
-        return cardinality::bdd::cardinality(ctx, c);
-      } else {
-        assert(false && "Unknown cardinality implementation");
-        throw std::exception();
+      if (enc == option::cardinality_encoding::automatic) {
+        if constexpr (features::supports<Context, features::cardinality_api>::value) {
+          enc = option::cardinality_encoding::native;
+        } else {
+          r = cardinality::at_most_one(ctx, c);
+          if (r) {
+            return *r;
+          }
+          enc = option::cardinality_encoding::bdd;
+        }
+      }
+
+      switch (enc) {
+        case option::cardinality_encoding::native:
+          return cardinality::native::cardinality(ctx, c);
+        case option::cardinality_encoding::adder:
+          return cardinality::adder::cardinality(ctx, c);
+        case option::cardinality_encoding::bdd:
+          return cardinality::bdd::cardinality(ctx, c);
+        case option::cardinality_encoding::totalizer:
+          return cardinality::totalizer::cardinality(ctx, c);
+        case option::cardinality_encoding::modulo_totalizer:
+          return cardinality::modulo_totalizer::cardinality(ctx, c);
+        case option::cardinality_encoding::sequential_counter:
+          return cardinality::sequential_counter::cardinality(ctx, c);
+        case option::cardinality_encoding::sorting_network:
+          return cardinality::sorting_network::cardinality(ctx, c);
+        default:
+          assert(false && "Unknown cardinality implementation");
+          throw std::exception();
       }
     }
   };  // Evaluator
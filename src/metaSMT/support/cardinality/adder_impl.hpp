@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <queue>
 
 #include "../../tags/Cardinality.hpp"
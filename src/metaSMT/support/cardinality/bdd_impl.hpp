@@ -2,6 +2,13 @@
 
 #include <metaSMT/tags/Cardinality.hpp>
 
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../../API/SupportCache.hpp"
 #include "../../tags/Logic.hpp"
 #include "object.hpp"
 
@@ -24,79 +31,127 @@ namespace metaSMT {
        * Pseudo-Boolean Constraints to SAT, Journal on Satisfiability,
        * Boolean Modeling and Computation, volume 2, pages 191-200, 2006.
        *
-       * The tableau algorithm keeps only two rows of the tableau in
-       * memory which we call ``rails''.
+       * Cell (i, j) of the tableau is the formula for
        *
-       * The construction applies to all operator types (<, <=, =, >=, >).
-       * An operator is selected by assigning values to the arguments lt,
-       * eq, gt, e.g., the less equal operator corresponds to lt = True,
-       * eq = True, gt = False.
+       *    ps[i] + ... + ps[n-1] >= j
        *
-       * For instance, the constraint
+       * and is constructed with the ITE-operator from the cells below it
        *
-       *    ps[0] + ps[1] + ps[2] + ps[3] <=> 3 with <=> in {<, >, =, <=, >=}
+       *    cell(i, j) = ITE(ps[i], cell(i+1, j-1), cell(i+1, j))
        *
-       * corresponds to the following tableau
-       *       RAILS  |   0    1     2     3
-       *              |          lt    lt    lt
-       *     ---------|------------------------
-       *        0     |    eq ps[0] ps[1] ps[2]
-       *        1  gt | ps[0] ps[1] ps[2] ps[3]
+       * where cell(i, 0) = True and cell(i, j) = False for j > n - i.
+       * Constant children are folded into AND / OR. The query
+       * ps[0] + ... + ps[n-1] >= k reaches the (n-k+1) x k cells with
+       * k - i <= j <= k only.
        *
-       * From the bottom right node of the tableau a logic formula is
-       * constructed using the ITE-operator where the left neighbor node
-       * and the top neighbor node serve as the then and else part,
-       * respectively.
+       * The tableau memoizes its cells, so all constraints over the same
+       * literals built with one Tableau share their sub-tableaux. The
+       * evaluator takes the tableau from tableau(), which reuses it for
+       * constraints over the same literals, or it is built by hand, e.g.
        *
-       * Moreover, notice that cells with entries lt and gt are not
-       * explicitly saved in rails but are directly encoded when the
-       * formula is created.
+       * \code
+       *  cardinality::bdd::Tableau<Context> t(ctx, ps);
+       *  assertion(ctx, t.geq(2));
+       *  assertion(ctx, t.leq(3));
+       * \endcode
        *
-       * Precondition: ps.size > 0 && cardinality > 0 && ps.size() > cardinality
+       * The cells are plain terms without defining variables. Every backend
+       * represents a term by a handle, i.e. a DAG node, a BDD node or a
+       * Tseitin literal, so a cell used by several parents is encoded once.
        */
       template <typename Context>
-      typename Context::result_type formula(Context &ctx, unsigned n, typename Context::result_type r) {
-        using namespace metaSMT::logic;
-        unsigned const magic_number = 0;
-        if (n > magic_number) {
-          auto p = new_variable();
-          metaSMT::assertion(ctx, ctx(logic::tag::equal_tag{}, p, r));
-          return ctx(p);
-        } else {
+      class Tableau {
+       public:
+        typedef typename Context::result_type result_type;
+
+        template <typename Boolean>
+        Tableau(Context &ctx, std::vector<Boolean> const &ps) : ctx_(ctx) {
+          assert(ps.size() > 0 && "Cardinality constraint requires at least one input variable");
+          ps_.reserve(ps.size());
+          for (Boolean const &p : ps) ps_.push_back(ctx(p));
+        }
+
+        /// number of inputs
+        unsigned size() const { return ps_.size(); }
+
+        std::vector<result_type> const &inputs() const { return ps_; }
+
+        /// the formula for ps[0] + ... + ps[n-1] >= j
+        result_type at_least(unsigned j) { return cell(0, j); }
+
+        result_type lt(unsigned k) { return ctx_(logic::tag::not_tag{}, at_least(k)); }
+
+        result_type leq(unsigned k) { return ctx_(logic::tag::not_tag{}, at_least(k + 1)); }
+
+        result_type eq(unsigned k) { return ctx_(logic::tag::and_tag{}, at_least(k), leq(k)); }
+
+        result_type geq(unsigned k) { return at_least(k); }
+
+        result_type gt(unsigned k) { return at_least(k + 1); }
+
+       private:
+        result_type cell(unsigned i, unsigned j) {
+          unsigned const rest = size() - i;
+          if (j == 0) return ctx_(true);
+          if (j > rest) return ctx_(false);
+
+          typename std::map<std::pair<unsigned, unsigned>, result_type>::const_iterator it = cells_.find({i, j});
+          if (it != cells_.end()) return it->second;
+
+          result_type r = ps_[i];
+          if (j == 1 && rest > 1) {
+            r = ctx_(logic::tag::or_tag{}, ps_[i], cell(i + 1, 1));
+          } else if (j > 1 && j == rest) {
+            r = ctx_(logic::tag::and_tag{}, ps_[i], cell(i + 1, j - 1));
+          } else if (j > 1) {
+            r = ctx_(logic::tag::ite_tag{}, ps_[i], cell(i + 1, j - 1), cell(i + 1, j));
+          }
+          cells_.insert({{i, j}, r});
           return r;
         }
-      }
 
-      template <typename Context, typename Boolean, typename LT_Expr, typename EQ_Expr, typename GT_Expr>
-      typename Context::result_type cardinality_any(Context &ctx, std::vector<Boolean> const &ps, unsigned cardinality,
-                                                    LT_Expr lt, EQ_Expr eq, GT_Expr gt) {
-        using namespace metaSMT::logic;
-        assert(ps.size() > 0 && "Cardinality constraint requires at least one input variable");
-        assert(cardinality > 0 && "Unsatisfied precondition for tableau construction");
-
-        assert(ps.size() > cardinality);
-
-        unsigned const rail_size = cardinality + 1;
-        std::vector<typename Context::result_type> rails[2];
-        rails[0].resize(rail_size);
-        rails[1].resize(rail_size);
-
-        for (unsigned v = 0; v < ps.size() - cardinality + 1; ++v) {
-          for (unsigned u = 0; u < cardinality + 1; ++u) {
-            if (u == 0 && v == 0) {
-              rails[0][0] = formula(ctx, u + v, ctx(eq));
-            } else if (u == 0) {
-              rails[v % 2][0] =
-                  formula(ctx, u + v, ctx(logic::tag::ite_tag{}, ctx(ps[v - 1]), gt, rails[(v - 1) % 2][0]));
-            } else if (v == 0) {
-              rails[0][u] = formula(ctx, u + v, ctx(logic::tag::ite_tag{}, ctx(ps[u - 1]), rails[0][u - 1], lt));
-            } else {
-              rails[v % 2][u] = formula(
-                  ctx, u + v, ctx(logic::tag::ite_tag{}, ps[u + v - 1], rails[v % 2][u - 1], rails[(v - 1) % 2][u]));
-            }
+        Context &ctx_;
+        std::vector<result_type> ps_;
+        std::map<std::pair<unsigned, unsigned>, result_type> cells_;
+      };
+
+      /// the tableaux of the latest constraints of a context, most recent first
+      template <typename Context>
+      struct Tableau_Cache {
+        static unsigned const capacity = 16;
+        std::list<std::shared_ptr<Tableau<Context> > > tableaux;
+      };
+
+      /**
+       * The tableau over ps. Contexts supporting support_cache_cmd return
+       * the same tableau for the same literals while it is among the
+       * Tableau_Cache::capacity latest, so e.g. cardinality_leq(ps, k) and
+       * cardinality_geq(ps, k) share their cells.
+       */
+      template <typename Context, typename Boolean>
+      std::shared_ptr<Tableau<Context> > tableau(Context &ctx, std::vector<Boolean> const &ps) {
+        typedef typename Context::result_type result_type;
+        Tableau_Cache<Context> *cache = support_cache<Tableau_Cache<Context> >(ctx);
+        if (!cache) {
+          return std::make_shared<Tableau<Context> >(ctx, ps);
+        }
+
+        std::vector<result_type> xs;
+        xs.reserve(ps.size());
+        for (Boolean const &p : ps) xs.push_back(ctx(p));
+
+        auto &tableaux = cache->tableaux;
+        for (auto it = tableaux.begin(); it != tableaux.end(); ++it) {
+          if ((*it)->inputs() == xs) {
+            tableaux.splice(tableaux.begin(), tableaux, it);
+            return tableaux.front();
           }
         }
-        return rails[(ps.size() - cardinality) % 2][cardinality];
+        tableaux.push_front(std::make_shared<Tableau<Context> >(ctx, xs));
+        if (tableaux.size() > Tableau_Cache<Context>::capacity) {
+          tableaux.pop_back();
+        }
+        return tableaux.front();
       }
 
       template <typename Context, typename Tag, typename Boolean>
@@ -109,54 +164,36 @@ namespace metaSMT {
       template <typename Context, typename Boolean>
       typename Context::result_type cardinality(Context &ctx,
                                                 cardinality::Cardinality<cardtags::eq_tag, Boolean> const &c) {
-        std::vector<Boolean> const &ps = c.ps;
-        unsigned const cardinality = c.cardinality;
-
-        assert(ps.size() > 0 && "Equality cardinality constraint requires at least one input variable");
-
-        return cardinality_any(ctx, ps, cardinality, false, true, false);
+        assert(c.ps.size() > 0 && "Equality cardinality constraint requires at least one input variable");
+        return tableau(ctx, c.ps)->eq(c.cardinality);
       }
 
       template <typename Context, typename Boolean>
       typename Context::result_type cardinality(Context &ctx,
                                                 cardinality::Cardinality<cardtags::lt_tag, Boolean> const &c) {
-        std::vector<Boolean> const &ps = c.ps;
-        unsigned const cardinality = c.cardinality;
-
-        assert(ps.size() > 0 && "Lower than cardinality constraint requires at least one input variable");
-        return ctx(logic::tag::not_tag{}, cardinality_geq(ctx, ps, cardinality));
+        assert(c.ps.size() > 0 && "Lower than cardinality constraint requires at least one input variable");
+        return tableau(ctx, c.ps)->lt(c.cardinality);
       }
 
       template <typename Context, typename Boolean>
       typename Context::result_type cardinality(Context &ctx,
                                                 cardinality::Cardinality<cardtags::le_tag, Boolean> const &c) {
-        std::vector<Boolean> const &ps = c.ps;
-        unsigned const cardinality = c.cardinality;
-
-        assert(ps.size() > 0 && "Lower equal cardinality constraint requires at least one input variable");
-
-        return cardinality_any(ctx, ps, cardinality, true, true, false);
+        assert(c.ps.size() > 0 && "Lower equal cardinality constraint requires at least one input variable");
+        return tableau(ctx, c.ps)->leq(c.cardinality);
       }
 
       template <typename Context, typename Boolean>
       typename Context::result_type cardinality(Context &ctx,
                                                 cardinality::Cardinality<cardtags::ge_tag, Boolean> const &c) {
-        std::vector<Boolean> const &ps = c.ps;
-        unsigned const cardinality = c.cardinality;
-        assert(cardinality != 0);
-        assert(ps.size() > 0 && "Greater equal cardinality constraint requires at least one input variable");
-
-        return cardinality_any(ctx, ps, cardinality, false, true, true);
+        assert(c.ps.size() > 0 && "Greater equal cardinality constraint requires at least one input variable");
+        return tableau(ctx, c.ps)->geq(c.cardinality);
       }
 
       template <typename Context, typename Boolean>
       typename Context::result_type cardinality(Context &ctx,
                                                 cardinality::Cardinality<cardtags::gt_tag, Boolean> const &c) {
-        std::vector<Boolean> const &ps = c.ps;
-        unsigned const cardinality = c.cardinality;
-
-        assert(ps.size() > 0 && "Greater than cardinality constraint requires at least one input variable");
-        return ctx(logic::tag::not_tag{}, cardinality_leq(ctx, ps, cardinality));
+        assert(c.ps.size() > 0 && "Greater than cardinality constraint requires at least one input variable");
+        return tableau(ctx, c.ps)->gt(c.cardinality);
       }
     }  // namespace bdd
   }    // namespace cardinality
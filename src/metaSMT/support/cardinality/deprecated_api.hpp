@@ -9,20 +9,7 @@ namespace metaSMT {
   template <typename Context, typename Boolean>
   typename Context::result_type one_hot(Context &ctx, std::vector<Boolean> const &ps) {
     assert(ps.size() > 0 && "One hot encoding requires at least one input variable");
-
-    if (ps.size() == 1) {
-      return ctx(logic::tag::equal_tag{}, ps[0], ctx(true));
-    }
-
-    typename Context::result_type zero_rail = evaluate(ctx, ps[0]);
-    typename Context::result_type one_rail = evaluate(ctx, Not(ps[0]));
-
-    for (unsigned u = 1; u < ps.size() - 1; ++u) {
-      zero_rail = ctx(logic::tag::ite_tag{}, ps[u], one_rail, zero_rail);
-      one_rail = ctx(logic::tag::ite_tag{}, ps[u], ctx(false), one_rail);
-    }
-
-    return ctx(logic::tag::ite_tag{}, ps[ps.size() - 1], one_rail, zero_rail);
+    return ctx(amo::exactly_one(ps));
   }
 
   template <typename Context, typename Boolean>
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "object.hpp"
+#include "totalizer_impl.hpp"
+#include "unary.hpp"
+
+namespace metaSMT {
+  namespace cardinality {
+    namespace modulo_totalizer {
+      /**
+       * Modulo totalizer by Ogawa et al. [1].
+       *
+       * Like the totalizer, but each node counts with two unary digits:
+       * lower counts modulo p (outputs for >= 1, ..., >= p-1) and upper
+       * counts the multiples of p. Merging two nodes adds the lower digits,
+       * the carry (lower sum >= p) goes to the upper digit. This reduces the
+       * size of the encoding from O(n k) to O(n sqrt(k)).
+       *
+       * [1] T. Ogawa, Y. Liu, R. Hasegawa, M. Koshimura and H. Fujita.
+       * Modulo based CNF encoding of cardinality constraints and its
+       * application to MaxSAT solvers. In International Conference on Tools
+       * with Artificial Intelligence (ICTAI), pages 9-17, 2013.
+       */
+      template <typename Context>
+      struct Node {
+        std::vector<unary::Output<Context> > lower;
+        std::vector<unary::Output<Context> > upper;
+      };
+
+      template <typename Context>
+      Node<Context> merge(Context &ctx, Node<Context> const &a, Node<Context> const &b, unsigned p,
+                          unsigned upper_cap) {
+        typedef unary::Output<Context> Output;
+
+        // unary sum of the lower digits, at most 2p-2
+        std::vector<Output> const s = totalizer::merge(ctx, a.lower, b.lower, 2 * p - 2);
+        Output const carry = s.size() >= p ? s[p - 1] : Output();
+
+        Node<Context> n;
+        n.lower.resize(std::min<std::size_t>(s.size(), p - 1));
+        for (unsigned j = 1; j <= n.lower.size(); ++j) {
+          Output const below = carry ? unary::And(ctx, s[j - 1], ctx(logic::tag::not_tag{}, *carry)) : s[j - 1];
+          Output const wrapped = p + j <= s.size() ? s[p + j - 1] : Output();
+          n.lower[j - 1] = unary::Or(ctx, below, wrapped);
+        }
+
+        n.upper = totalizer::merge(ctx, a.upper, b.upper, upper_cap);
+        if (carry) {
+          n.upper = totalizer::merge(ctx, n.upper, std::vector<Output>(1, carry), upper_cap);
+        }
+        return n;
+      }
+
+      template <typename Context>
+      Node<Context> count(Context &ctx, std::vector<typename Context::result_type> const &xs, unsigned begin,
+                          unsigned end, unsigned p, unsigned upper_cap) {
+        if (end - begin == 1) {
+          Node<Context> leaf;
+          leaf.lower.push_back(xs[begin]);
+          return leaf;
+        }
+        unsigned const mid = begin + (end - begin) / 2;
+        return merge(ctx, count(ctx, xs, begin, mid, p, upper_cap), count(ctx, xs, mid, end, p, upper_cap), p,
+                     upper_cap);
+      }
+
+      template <typename Context>
+      typename Context::result_type digit(Context &ctx, std::vector<unary::Output<Context> > const &d, unsigned j) {
+        if (j == 0) return ctx(true);
+        if (j > d.size() || !d[j - 1]) return ctx(false);
+        return *d[j - 1];
+      }
+
+      template <typename Context, typename Tag, typename Boolean>
+      typename Context::result_type cardinality(Context &ctx, cardinality::Cardinality<Tag, Boolean> const &c) {
+        std::vector<Boolean> const &ps = c.ps;
+        assert(ps.size() > 0 && "Cardinality constraint requires at least one input variable");
+
+        unsigned const cap = std::max(unary::max_output(Tag(), c.cardinality), 1u);
+        unsigned const p = std::max(2u, static_cast<unsigned>(std::sqrt(static_cast<double>(cap))));
+        Node<Context> const n = count(ctx, unary::inputs(ctx, ps), 0, ps.size(), p, cap / p + 1);
+
+        // sum >= q p + r  <->  upper >= q + 1  |  (upper >= q & lower >= r)
+        return unary::compare(ctx, Tag(), c.cardinality, [&ctx, &n, p](unsigned j) {
+          unsigned const q = j / p;
+          unsigned const r = j % p;
+          if (r == 0) return digit(ctx, n.upper, q);
+          return ctx(logic::tag::or_tag{}, digit(ctx, n.upper, q + 1),
+                     ctx(logic::tag::and_tag{}, digit(ctx, n.upper, q), digit(ctx, n.lower, r)));
+        });
+      }
+    }  // namespace modulo_totalizer
+  }    // namespace cardinality
+}  // namespace metaSMT
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <metaSMT/tags/Cardinality.hpp>
+
+#include <cassert>
+#include <exception>
+#include <vector>
+
+#include "../../API/Cardinality.hpp"
+#include "../../Features.hpp"
+#include "object.hpp"
+
+namespace metaSMT {
+  namespace cardinality {
+    namespace native {
+
+      /**
+       * Forwards the constraint to the context, see API/Cardinality.hpp.
+       * Only available for contexts supporting features::cardinality_api.
+       */
+      template <typename Context, typename Tag, typename Boolean>
+      typename Context::result_type cardinality(Context &ctx, cardinality::Cardinality<Tag, Boolean> const &c) {
+        if constexpr (features::supports<Context, features::cardinality_api>::value) {
+          std::vector<typename Context::result_type> ps;
+          ps.reserve(c.ps.size());
+          for (Boolean const &p : c.ps) ps.push_back(ctx(p));
+          return ctx.command(cardinality_cmd(), Tag(), ps, c.cardinality);
+        } else {
+          assert(false && "Context does not support native cardinality constraints");
+          throw std::exception();
+        }
+      }
+    }  // namespace native
+  }    // namespace cardinality
+}  // namespace metaSMT
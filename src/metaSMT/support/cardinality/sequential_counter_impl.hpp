@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+
+#include "object.hpp"
+#include "unary.hpp"
+
+namespace metaSMT {
+  namespace cardinality {
+    namespace sequential_counter {
+      /**
+       * Sequential counter by Sinz [1].
+       *
+       * Counts the inputs one after the other in unary. After input i the
+       * registers are
+       *
+       *    s[j-1] <-> s'[j-1] | (ps[i] & s'[j-2])   with s'[-1] = true
+       *
+       * for the registers s' after input i-1. Only the first cap registers
+       * are built, which is sufficient for bounds below cap.
+       *
+       * [1] C. Sinz. Towards an optimal CNF encoding of Boolean cardinality
+       * constraints. In Principles and Practice of Constraint Programming
+       * (CP), pages 827-831, 2005.
+       */
+      template <typename Context>
+      std::vector<unary::Output<Context> > count(Context &ctx, std::vector<typename Context::result_type> const &xs,
+                                                 unsigned cap) {
+        typedef unary::Output<Context> Output;
+        std::vector<Output> s;
+        for (unsigned i = 0; i < xs.size(); ++i) {
+          if (s.size() < cap) s.push_back(Output());
+          for (unsigned j = s.size(); j > 0; --j) {
+            Output const carry = j == 1 ? Output(xs[i]) : unary::And(ctx, Output(xs[i]), s[j - 2]);
+            s[j - 1] = unary::Or(ctx, s[j - 1], carry);
+          }
+        }
+        return s;
+      }
+
+      template <typename Context, typename Tag, typename Boolean>
+      typename Context::result_type cardinality(Context &ctx, cardinality::Cardinality<Tag, Boolean> const &c) {
+        std::vector<Boolean> const &ps = c.ps;
+        assert(ps.size() > 0 && "Cardinality constraint requires at least one input variable");
+
+        unsigned const cap = std::max(unary::max_output(Tag(), c.cardinality), 1u);
+        std::vector<unary::Output<Context> > const s = count(ctx, unary::inputs(ctx, ps), cap);
+        return unary::compare_outputs(ctx, Tag(), c.cardinality, s);
+      }
+    }  // namespace sequential_counter
+  }    // namespace cardinality
+}  // namespace metaSMT
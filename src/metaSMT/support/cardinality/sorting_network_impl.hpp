@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+
+#include "object.hpp"
+#include "unary.hpp"
+
+namespace metaSMT {
+  namespace cardinality {
+    namespace sorting_network {
+      /**
+       * Cardinality network after As&iacute;n et al. [1], built from
+       * Batcher's odd-even merge sort.
+       *
+       * The inputs are padded with false to a power of two and sorted in
+       * descending order, so output j-1 is true iff at least j inputs are
+       * true. A comparator maps (a, b) to (a | b, a & b). Each sorted half
+       * is truncated to its first cap elements before merging, as only
+       * these can reach the first cap outputs. Comparators on the constant
+       * false are folded away.
+       *
+       * [1] R. As&iacute;n, R. Nieuwenhuis, A. Oliveras and E.
+       * Rodr&iacute;guez-Carbonell. Cardinality networks: a theoretical and
+       * empirical study. Constraints, volume 16, pages 195-221, 2011.
+       */
+      template <typename Context>
+      void comparator(Context &ctx, unary::Output<Context> &a, unary::Output<Context> &b) {
+        unary::Output<Context> const max = unary::Or(ctx, a, b);
+        unary::Output<Context> const min = unary::And(ctx, a, b);
+        a = max;
+        b = min;
+      }
+
+      /// merges the sorted sequences a and b of equal power of two length
+      template <typename Context>
+      std::vector<unary::Output<Context> > merge(Context &ctx, std::vector<unary::Output<Context> > const &a,
+                                                 std::vector<unary::Output<Context> > const &b) {
+        typedef unary::Output<Context> Output;
+        if (a.size() == 1) {
+          std::vector<Output> c(2);
+          c[0] = a[0];
+          c[1] = b[0];
+          comparator(ctx, c[0], c[1]);
+          return c;
+        }
+
+        std::vector<Output> a_even, a_odd, b_even, b_odd;
+        for (unsigned i = 0; i < a.size(); ++i) {
+          (i % 2 ? a_odd : a_even).push_back(a[i]);
+          (i % 2 ? b_odd : b_even).push_back(b[i]);
+        }
+        std::vector<Output> const even = merge(ctx, a_even, b_even);
+        std::vector<Output> const odd = merge(ctx, a_odd, b_odd);
+
+        std::vector<Output> c(2 * a.size());
+        c[0] = even[0];
+        for (unsigned i = 1; i < even.size(); ++i) {
+          c[2 * i - 1] = even[i];
+          c[2 * i] = odd[i - 1];
+          comparator(ctx, c[2 * i - 1], c[2 * i]);
+        }
+        c[c.size() - 1] = odd[odd.size() - 1];
+        return c;
+      }
+
+      template <typename Context>
+      std::vector<unary::Output<Context> > sort(Context &ctx, std::vector<unary::Output<Context> > const &xs,
+                                                unsigned cap) {
+        typedef unary::Output<Context> Output;
+        if (xs.size() == 1) return xs;
+
+        std::size_t const half = xs.size() / 2;
+        std::vector<Output> a = sort(ctx, std::vector<Output>(xs.begin(), xs.begin() + half), cap);
+        std::vector<Output> b = sort(ctx, std::vector<Output>(xs.begin() + half, xs.end()), cap);
+        for (unsigned i = cap; i < half; ++i) {
+          a[i] = Output();
+          b[i] = Output();
+        }
+        return merge(ctx, a, b);
+      }
+
+      template <typename Context>
+      std::vector<unary::Output<Context> > count(Context &ctx, std::vector<typename Context::result_type> const &xs,
+                                                 unsigned cap) {
+        std::size_t n = 1;
+        while (n < xs.size()) n *= 2;
+        std::vector<unary::Output<Context> > padded(xs.begin(), xs.end());
+        padded.resize(n);
+
+        std::vector<unary::Output<Context> > sorted = sort(ctx, padded, cap);
+        sorted.resize(std::min<std::size_t>(sorted.size(), std::max(cap, 1u)));
+        return sorted;
+      }
+
+      template <typename Context, typename Tag, typename Boolean>
+      typename Context::result_type cardinality(Context &ctx, cardinality::Cardinality<Tag, Boolean> const &c) {
+        std::vector<Boolean> const &ps = c.ps;
+        assert(ps.size() > 0 && "Cardinality constraint requires at least one input variable");
+
+        unsigned const cap = std::max(unary::max_output(Tag(), c.cardinality), 1u);
+        std::vector<unary::Output<Context> > const o = count(ctx, unary::inputs(ctx, ps), cap);
+        return unary::compare_outputs(ctx, Tag(), c.cardinality, o);
+      }
+    }  // namespace sorting_network
+  }    // namespace cardinality
+}  // namespace metaSMT
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+
+#include "object.hpp"
+#include "unary.hpp"
+
+namespace metaSMT {
+  namespace cardinality {
+    namespace totalizer {
+      /**
+       * Totalizer by Bailleux and Boufkhad [1].
+       *
+       * A balanced binary tree over the inputs, where each node counts the
+       * true inputs below it in unary. The outputs of a node are
+       *
+       *    o[j-1] <-> OR_{i + l = j} (a[i-1] & b[l-1])   with a[-1] = b[-1] = true
+       *
+       * for the outputs a and b of its children. Only the first cap outputs
+       * of each node are built, which is sufficient for bounds below cap.
+       *
+       * [1] O. Bailleux and Y. Boufkhad. Efficient CNF encoding of Boolean
+       * cardinality constraints. In Principles and Practice of Constraint
+       * Programming (CP), pages 108-122, 2003.
+       */
+      template <typename Context>
+      std::vector<unary::Output<Context> > merge(Context &ctx, std::vector<unary::Output<Context> > const &a,
+                                                 std::vector<unary::Output<Context> > const &b, unsigned cap) {
+        typedef unary::Output<Context> Output;
+        unsigned const m = std::min<unsigned>(a.size() + b.size(), cap);
+        std::vector<Output> o(m);
+        for (unsigned j = 1; j <= m; ++j) {
+          unsigned const lo = j > b.size() ? j - b.size() : 0;
+          unsigned const hi = std::min<unsigned>(j, a.size());
+          for (unsigned i = lo; i <= hi; ++i) {
+            Output term;
+            if (i == 0) {
+              term = b[j - 1];
+            } else if (i == j) {
+              term = a[i - 1];
+            } else {
+              term = unary::And(ctx, a[i - 1], b[j - i - 1]);
+            }
+            o[j - 1] = unary::Or(ctx, o[j - 1], term);
+          }
+        }
+        return o;
+      }
+
+      template <typename Context>
+      std::vector<unary::Output<Context> > count(Context &ctx, std::vector<typename Context::result_type> const &xs,
+                                                 unsigned begin, unsigned end, unsigned cap) {
+        if (end - begin == 1) {
+          return std::vector<unary::Output<Context> >(1, xs[begin]);
+        }
+        unsigned const mid = begin + (end - begin) / 2;
+        return merge(ctx, count(ctx, xs, begin, mid, cap), count(ctx, xs, mid, end, cap), cap);
+      }
+
+      template <typename Context, typename Tag, typename Boolean>
+      typename Context::result_type cardinality(Context &ctx, cardinality::Cardinality<Tag, Boolean> const &c) {
+        std::vector<Boolean> const &ps = c.ps;
+        assert(ps.size() > 0 && "Cardinality constraint requires at least one input variable");
+
+        unsigned const cap = std::max(unary::max_output(Tag(), c.cardinality), 1u);
+        std::vector<unary::Output<Context> > const o = count(ctx, unary::inputs(ctx, ps), 0, ps.size(), cap);
+        return unary::compare_outputs(ctx, Tag(), c.cardinality, o);
+      }
+    }  // namespace totalizer
+
+    /**
+     * @brief incremental totalizer
+     *
+     * Encodes the totalizer of ps once and returns bounds on its outputs
+     * without further encoding. Useful when the bound is tightened
+     * repeatedly, e.g. with assumptions in a minimization loop:
+     *
+     * \code
+     *  cardinality::Totalizer<Context> t(ctx, ps, k);
+     *  while (k > 0) {
+     *    assumption(ctx, t.leq(k - 1));
+     *    if (!solve(ctx)) break;
+     *    --k;
+     *  }
+     * \endcode
+     *
+     * Bounds up to max_bound are supported, i.e. the outputs for
+     * sum >= 1, ..., sum >= max_bound + 1 are built.
+     **/
+    template <typename Context>
+    class Totalizer {
+     public:
+      typedef typename Context::result_type result_type;
+
+      template <typename Boolean>
+      Totalizer(Context &ctx, std::vector<Boolean> const &ps, unsigned max_bound)
+          : ctx_(ctx), max_bound_(max_bound), size_(ps.size()) {
+        assert(ps.size() > 0 && "Totalizer requires at least one input variable");
+        outputs_ = totalizer::count(ctx, unary::inputs(ctx, ps), 0, ps.size(), max_bound + 1);
+      }
+
+      template <typename Boolean>
+      Totalizer(Context &ctx, std::vector<Boolean> const &ps) : Totalizer(ctx, ps, ps.size()) {}
+
+      /// number of inputs
+      unsigned size() const { return size_; }
+
+      unsigned max_bound() const { return max_bound_; }
+
+      /// the formula for ps[0] + ... + ps[n-1] >= j, j <= max_bound() + 1
+      result_type at_least(unsigned j) {
+        assert(j <= max_bound_ + 1 && "bound exceeds the encoded outputs of the totalizer");
+        if (j == 0) return ctx_(true);
+        if (j > outputs_.size() || !outputs_[j - 1]) return ctx_(false);
+        return *outputs_[j - 1];
+      }
+
+      result_type leq(unsigned k) { return compare(logic::cardinality::tag::le_tag(), k); }
+
+      result_type lt(unsigned k) { return compare(logic::cardinality::tag::lt_tag(), k); }
+
+      result_type eq(unsigned k) { return compare(logic::cardinality::tag::eq_tag(), k); }
+
+      result_type geq(unsigned k) { return compare(logic::cardinality::tag::ge_tag(), k); }
+
+      result_type gt(unsigned k) { return compare(logic::cardinality::tag::gt_tag(), k); }
+
+     private:
+      template <typename Tag>
+      result_type compare(Tag const &tag, unsigned k) {
+        return unary::compare(ctx_, tag, k, [this](unsigned j) { return at_least(j); });
+      }
+
+      Context &ctx_;
+      unsigned max_bound_;
+      unsigned size_;
+      std::vector<unary::Output<Context> > outputs_;
+    };
+  }  // namespace cardinality
+}  // namespace metaSMT
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "../../tags/Cardinality.hpp"
+#include "../../tags/Logic.hpp"
+
+namespace metaSMT {
+  namespace cardinality {
+    namespace unary {
+      namespace cardtags = metaSMT::logic::cardinality::tag;
+
+      /**
+       * Helpers for encodings that count in unary, i.e. compute outputs
+       * o[j-1] <-> (ps[0] + ... + ps[n-1] >= j). An empty optional stands
+       * for the constant false and is folded when building the formula.
+       */
+      template <typename Context>
+      using Output = std::optional<typename Context::result_type>;
+
+      template <typename Context>
+      Output<Context> Or(Context &ctx, Output<Context> const &a, Output<Context> const &b) {
+        if (!a) return b;
+        if (!b) return a;
+        return ctx(logic::tag::or_tag{}, *a, *b);
+      }
+
+      template <typename Context>
+      Output<Context> And(Context &ctx, Output<Context> const &a, Output<Context> const &b) {
+        if (!a || !b) return Output<Context>();
+        return ctx(logic::tag::and_tag{}, *a, *b);
+      }
+
+      /**
+       * Largest j for which (sum >= j) is needed to decide the operator
+       * with bound k, i.e. the number of outputs an encoding has to build.
+       */
+      inline unsigned max_output(cardtags::lt_tag const &, unsigned k) { return k; }
+      inline unsigned max_output(cardtags::le_tag const &, unsigned k) { return k + 1; }
+      inline unsigned max_output(cardtags::eq_tag const &, unsigned k) { return k + 1; }
+      inline unsigned max_output(cardtags::ge_tag const &, unsigned k) { return k; }
+      inline unsigned max_output(cardtags::gt_tag const &, unsigned k) { return k + 1; }
+
+      /**
+       * Expresses the operator with bound k by at_least(j), which returns
+       * the formula for (sum >= j) for 0 < j <= max_output(tag, k).
+       */
+      template <typename Context, typename AtLeast>
+      typename Context::result_type compare(Context &ctx, cardtags::lt_tag const &, unsigned k, AtLeast at_least) {
+        if (k == 0) return ctx(false);
+        return ctx(logic::tag::not_tag{}, at_least(k));
+      }
+
+      template <typename Context, typename AtLeast>
+      typename Context::result_type compare(Context &ctx, cardtags::le_tag const &, unsigned k, AtLeast at_least) {
+        return ctx(logic::tag::not_tag{}, at_least(k + 1));
+      }
+
+      template <typename Context, typename AtLeast>
+      typename Context::result_type compare(Context &ctx, cardtags::eq_tag const &, unsigned k, AtLeast at_least) {
+        typename Context::result_type const not_more = ctx(logic::tag::not_tag{}, at_least(k + 1));
+        if (k == 0) return not_more;
+        return ctx(logic::tag::and_tag{}, at_least(k), not_more);
+      }
+
+      template <typename Context, typename AtLeast>
+      typename Context::result_type compare(Context &ctx, cardtags::ge_tag const &, unsigned k, AtLeast at_least) {
+        if (k == 0) return ctx(true);
+        return at_least(k);
+      }
+
+      template <typename Context, typename AtLeast>
+      typename Context::result_type compare(Context &, cardtags::gt_tag const &, unsigned k, AtLeast at_least) {
+        return at_least(k + 1);
+      }
+
+      /// compare() for encodings that provide all outputs in a vector
+      template <typename Context, typename Tag>
+      typename Context::result_type compare_outputs(Context &ctx, Tag const &tag, unsigned k,
+                                                    std::vector<Output<Context> > const &outputs) {
+        return compare(ctx, tag, k, [&ctx, &outputs](unsigned j) {
+          if (j > outputs.size() || !outputs[j - 1]) return ctx(false);
+          return *outputs[j - 1];
+        });
+      }
+
+      template <typename Context, typename Boolean>
+      std::vector<typename Context::result_type> inputs(Context &ctx, std::vector<Boolean> const &ps) {
+        std::vector<typename Context::result_type> xs;
+        xs.reserve(ps.size());
+        for (unsigned u = 0; u < ps.size(); ++u) {
+          xs.push_back(ctx(ps[u]));
+        }
+        return xs;
+      }
+    }  // namespace unary
+  }    // namespace cardinality
+}  // namespace metaSMT
@@ -1,34 +1,124 @@
 #pragma once
 
-#include <iostream>
-#include <metaSMT/support/cardinality.hpp>
+#include <algorithm>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "cardinality.hpp"
+#include "mus.hpp"
+#include "parallel_mus.hpp"
 
-using namespace metaSMT::logic;
 namespace metaSMT {
 
+  namespace detail {
+    /**
+     * One level of the cardinality search. enabled and conflict index into
+     * selectors, conflict is extended and restored in place. A totalizer
+     * counts the disabled selectors and serves every bound of the level.
+     * It only encodes the counts up to its bound, which doubles when the
+     * search passes it, so levels that disable few constraints stay linear
+     * in the number of selectors.
+     **/
+    template <typename Context>
+    void analyze_multiple_conflict(Context &ctx, std::vector<typename Context::result_type> const &selectors,
+                                   std::vector<unsigned> const &enabled, std::vector<unsigned> &conflict,
+                                   std::vector<std::vector<unsigned> > &results) {
+      typedef typename Context::result_type result_type;
+
+      // conflict alone is complete
+      for (unsigned i : conflict) {
+        assumption(ctx, selectors[i]);
+      }
+      if (!solve(ctx)) {
+        results.push_back(conflict);
+        std::sort(results.back().begin(), results.back().end());
+        return;
+      }
+      if (enabled.empty()) return;
+
+      std::vector<result_type> disabled;
+      disabled.reserve(enabled.size());
+      for (unsigned i : enabled) {
+        disabled.push_back(ctx(logic::tag::not_tag(), selectors[i]));
+      }
+      std::optional<cardinality::Totalizer<Context> > count;
+
+      // the largest satisfiable selection of the enabled constraints
+      unsigned const size = enabled.size();
+      for (unsigned j = 1; j <= size; ++j) {
+        if (!count || count->max_bound() < j) {
+          count.emplace(ctx, disabled, std::min(2 * j - 1, size));
+        }
+        for (unsigned i : conflict) {
+          assumption(ctx, selectors[i]);
+        }
+        assumption(ctx, count->eq(j));
+        if (!solve(ctx)) continue;
+
+        // every disabled constraint takes part in a conflict
+        std::vector<unsigned> still_enabled;
+        std::vector<unsigned> conflicting;
+        still_enabled.reserve(size - j);
+        conflicting.reserve(j);
+        for (unsigned i : enabled) {
+          if (static_cast<bool>(read_value(ctx, selectors[i]))) {
+            still_enabled.push_back(i);
+          } else {
+            conflicting.push_back(i);
+          }
+        }
+        for (unsigned i : conflicting) {
+          conflict.push_back(i);
+          analyze_multiple_conflict(ctx, selectors, still_enabled, conflict, results);
+          conflict.pop_back();
+        }
+        break;
+      }
+    }
+  }  // namespace detail
+
   /**
-   * @brief Implications are evaluated by using a Context and added to
-   * a map.
+   * @brief the cardinality based analysis behind contradiction_analysis()
    *
-   * \tparam Context a metaSMT context, i.e. DirectSolver_Context<...>
+   * Searches the largest satisfiable selections with cardinality
+   * constraints over the selector variables and recurses on the disabled
+   * constraints. The conflicts are not necessarily minimal and may be
+   * reported more than once.
    **/
   template <typename Context>
-  struct InsertImplications {
-    Context &ctx;
-    typename Context::result_type &c;
-    std::map<unsigned, bool> &s;
-    InsertImplications(Context &ctx, std::map<unsigned, bool> &s, typename Context::result_type &c)
-        : ctx(ctx), c(c), s(s) {}
-
-    /*
-    template <typename Expr>
-    void operator()(Expr e) const {
-      bool si = new_variable();
-      c = ctx(tag::and_tag{}, c, implies(si, e));
-      s.insert(std::make_pair(s.size(), si));
+  std::vector<std::vector<unsigned> > contradiction_analysis_cardinality(
+      Context &ctx, std::vector<typename Context::result_type> const &t) {
+    typedef typename Context::result_type result_type;
+    std::vector<std::vector<unsigned> > results;
+
+    std::vector<result_type> s;
+    std::vector<unsigned> enabled;
+    for (unsigned i = 0; i < t.size(); ++i) {
+      result_type si = ctx(logic::new_variable());
+      assertion(ctx, ctx(logic::tag::implies_tag(), si, t[i]));
+      s.push_back(si);
+      enabled.push_back(i);
+    }
+
+    for (result_type const &si : s) {
+      assumption(ctx, si);
+    }
+    if (solve(ctx)) {
+      // satisfiable, no conflict
+      return results;
     }
-    */
-  }; /* detail */
+
+    if (s.size() == 1) {
+      // the only constraint is the reason for the conflict
+      results.push_back(std::vector<unsigned>(1, 0));
+      return results;
+    }
+
+    std::vector<unsigned> conflict;
+    detail::analyze_multiple_conflict(ctx, s, enabled, conflict, results);
+    return results;
+  }
 
   /**
    * @brief Analyze contradictions of constraints
@@ -36,8 +126,19 @@ namespace metaSMT {
    * contradiction_analysis takes several constraints given in a Tuple
    * or in a vector and analyzes them for conflicts
    *
-   * If no conflicts exist, an empty vector of vector is returned. Otherwise the conflicts are handled separately and
-   *dependecies between them are detected. These are also returned in a vector of vectors.
+   * If no conflicts exist, an empty vector of vector is returned. Otherwise
+   * the conflicts found by contradiction_analysis_cardinality() are
+   * returned.
+   *
+   * The constraints are added to ctx as implications of fresh selector
+   * variables and stay asserted.
+   *
+   * all_mus() returns exactly the minimal conflicts, enumerated with
+   * marco() on the assumption cores of the context, and parallel_all_mus()
+   * spreads that enumeration over several worker contexts. marco() also
+   * enumerates the minimal correction sets and stays slower than the
+   * cardinality search, which therefore remains the default. Compare both
+   * with tests/bench_contradiction_analysis.cpp.
    *
    * \param ctx is a metaSMT Context
    * \param t a tuple of constraints, instead of the tuple you can take a vector
@@ -50,128 +151,19 @@ namespace metaSMT {
    *
    */
 
-  /**
-   * @brief ...
-   */
-  template <typename Context, typename Tuple>
-  std::vector<std::vector<unsigned> > contradiction_analysis(Context &ctx, Tuple t) {
-    std::vector<std::vector<unsigned> > results;  // Fürs Endergebnis
-    std::map<unsigned, bool> s;                   // Vector für si's 1.version
-    std::vector<bool> sv;                         // s im vector sv
-
-    typename Context::result_type c = ctx(true);
-
-    InsertImplications<Context> impl(ctx, s, c);
-    for_each(t, impl);
-    return analyze_conflicts(ctx, s, c, results);
-  }  // end of method contradiction_analysis with tuple
-
   template <typename Context>
   std::vector<std::vector<unsigned> > contradiction_analysis(Context &ctx,
-                                                             std::vector<typename Context::result_type> t) {
-    std::vector<std::vector<unsigned> > results;  // Fürs Endergebnis
-    std::map<unsigned, bool> s;                   // Vector für si's 1.version
-
-    typename Context::result_type c = ctx(true);
-
-    InsertImplications<Context> impl(ctx, s, c);
-    std::for_each(t.begin(), t.end(), impl);
-
-    return analyze_conflicts(ctx, s, c, results);
+                                                             std::vector<typename Context::result_type> const &t) {
+    return contradiction_analysis_cardinality(ctx, t);
   }  // end of method contradiction_analysis with vector
 
-  template <typename Context, typename BooleanType>
-  std::vector<std::vector<unsigned> > analyze_conflicts(Context &ctx, std::map<unsigned, BooleanType> s,
-                                                        typename Context::result_type c,
-                                                        std::vector<std::vector<unsigned> > results) {
-    typedef std::pair<unsigned, BooleanType> Si_Pair;
-    std::vector<BooleanType> sv;
-    metaSMT::assumption(ctx, c);
-    for (Si_Pair si : s) {
-      metaSMT::assumption(ctx, si.second);
-    }
-
-    if (solve(ctx)) {  // problem is unsat, no conflict
-      return results;
-    }
-
-    // insert from map into vector
-    for (unsigned it = 0; it < s.size(); it++) {
-      sv.push_back(s[it]);  // ::iterator
-    }
-
-    if (sv.size() == 1) {
-      // the only constraint is the reasons for the conflict
-      results.push_back(std::vector<unsigned>(1 /*size*/, 0 /*constraint*/));
-      return results;
-    }
-
-    std::map<unsigned, BooleanType> conflicts;
-    analyze_multiple_conflict(ctx, c, s, conflicts, results);
-
-    return results;
-  }
-
-  template <typename Context, typename BooleanType>
-  void analyze_multiple_conflict(Context &ctx, typename Context::result_type c,
-                                 std::map<unsigned, BooleanType> const &enable_vars,
-                                 std::map<unsigned, BooleanType> const &confl_vars,
-                                 std::vector<std::vector<unsigned> > &results) {
-    typedef std::pair<unsigned, BooleanType> Si_Pair;
-
-    std::vector<BooleanType> sv;
-
-    for (Si_Pair si : enable_vars) {
-      sv.push_back(si.second);
-    }
-
-    typename Context::result_type custom_c = c;
-    for (Si_Pair si : confl_vars) {
-      custom_c = ctx(tag::and_tag{}, custom_c, si.second);
-    }
-
-    // check custom_c is SATISFIABLE
-    assumption(ctx, custom_c);
-    if (!solve(ctx)) {
-      // confl_vars is a complete conflict
-      std::vector<unsigned> result;
-      for (Si_Pair si : confl_vars) {
-        result.push_back(si.first);
-      }
-      results.push_back(result);
-      return;
-    }
-
-    const unsigned size = enable_vars.size();
-
-    for (unsigned j = 1; j <= size; j++) {
-      // prüfe ob diese formel erfüllbar ist
-      metaSMT::assumption(ctx, ctx(tag::and_tag{}, cardinality_eq(ctx, sv, size - j), custom_c));
-
-      if (!solve(ctx)) continue;
-
-      std::map<unsigned, BooleanType> custom_enab = enable_vars;
-      std::map<unsigned, BooleanType> custom_conf = confl_vars;
-
-      // sammel alle abgeschalteten si in conflicting
-      std::map<unsigned, BooleanType> conflicting;
-      for (Si_Pair si : enable_vars) {
-        bool tmp = read_value(ctx, si.second);
-        if (!tmp) {
-          conflicting.insert(si);
-          custom_enab.erase(si.first);
-        }
-      }
-      for (Si_Pair si : conflicting) {
-        custom_conf.insert(si);
-        analyze_multiple_conflict(ctx, c, custom_enab, custom_conf, results);
-        custom_conf.erase(si.first);
-      }
-      // found at least one conflict
-      break;
-    }  // KLammer für for-schleife
+  template <typename Context, typename... Exprs>
+  std::vector<std::vector<unsigned> > contradiction_analysis(Context &ctx, std::tuple<Exprs...> const &t) {
+    std::vector<typename Context::result_type> constraints = std::apply(
+        [&ctx](Exprs const &... e) { return std::vector<typename Context::result_type>{ctx(e)...}; }, t);
+    return contradiction_analysis(ctx, constraints);
+  }  // end of method contradiction_analysis with tuple
 
-  }  // end of method analyse_multiple_conflict
   /**@}*/
 }  // namespace metaSMT
 // vim: ts=2 sw=2 et
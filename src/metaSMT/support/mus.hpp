@@ -0,0 +1,337 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../API/Assertion.hpp"
+#include "../API/Assumption.hpp"
+#include "../API/UnsatCore.hpp"
+#include "../Features.hpp"
+#include "../tags/Logic.hpp"
+
+namespace metaSMT {
+
+  /**
+   * @brief a set of soft constraints that can be enabled by assumptions
+   *
+   * Every constraint c_i gets a fresh selector variable s_i and the
+   * implication s_i -> c_i is asserted in the context. A subset of the
+   * constraints is checked by assuming its selectors. If the context
+   * supports get_unsat_core_cmd, unsatisfiable checks return the native
+   * assumption core, otherwise the checked subset.
+   *
+   * Subsets are vectors of constraint indices.
+   *
+   * \tparam Context a metaSMT context, i.e. DirectSolver_Context<...>
+   *
+   * @ingroup Support
+   **/
+  template <typename Context>
+  class Soft_Constraints {
+   public:
+    typedef typename Context::result_type result_type;
+    typedef std::vector<unsigned> Subset;
+
+    explicit Soft_Constraints(Context &ctx) : ctx_(ctx), checks_(0) {}
+
+    Soft_Constraints(Context &ctx, std::vector<result_type> const &constraints) : ctx_(ctx), checks_(0) {
+      for (result_type const &c : constraints) {
+        add(c);
+      }
+    }
+
+    /// add a constraint, returns its index
+    unsigned add(result_type const &c) {
+      result_type s = ctx_(logic::new_variable());
+      metaSMT::assertion(ctx_, ctx_(logic::tag::implies_tag(), s, c));
+      selectors_.push_back(s);
+      constraints_.push_back(c);
+      return constraints_.size() - 1;
+    }
+
+    unsigned size() const { return constraints_.size(); }
+
+    Context &context() { return ctx_; }
+
+    /// number of solver calls so far
+    unsigned checks() const { return checks_; }
+
+    /**
+     * @brief check the constraints of subset together
+     *
+     * @param core if the subset is unsatisfiable, receives an
+     *        unsatisfiable subset of it
+     **/
+    bool satisfiable(Subset const &subset, Subset *core = 0) {
+      ++checks_;
+      for (unsigned i : subset) {
+        metaSMT::assumption(ctx_, selectors_[i]);
+      }
+      if (solve(ctx_)) {
+        return true;
+      }
+
+      if (core) {
+        if constexpr (features::supports<Context, get_unsat_core_cmd>::value) {
+          core->clear();
+          for (unsigned j : get_unsat_core(ctx_)) {
+            core->push_back(subset[j]);
+          }
+        } else {
+          *core = subset;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * @brief constraints satisfied by the model of the last satisfiable check
+     *
+     * @pre the last call to satisfiable() returned true
+     **/
+    void satisfied(std::vector<bool> &in) {
+      for (unsigned i = 0; i < constraints_.size(); ++i) {
+        if (!in[i] && static_cast<bool>(read_value(ctx_, constraints_[i]))) {
+          in[i] = true;
+        }
+      }
+    }
+
+   private:
+    Context &ctx_;
+    std::vector<result_type> selectors_;
+    std::vector<result_type> constraints_;
+    unsigned checks_;
+  };
+
+  /**
+   * @brief Minimal unsatisfiable subsets (MUS) and minimal correction sets (MCS)
+   *
+   * A MUS is an unsatisfiable subset of the constraints where every proper
+   * subset is satisfiable. A MCS is a minimal set of constraints whose
+   * removal makes the remaining constraints satisfiable, its complement is
+   * a maximal satisfiable subset (MSS).
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< SAT_Clause< solver::MiniSAT > > > ctx;
+   *  Soft_Constraints< DirectSolver_Context< ... > > sc(ctx, constraints);
+   *
+   *  std::vector<unsigned> all(sc.size());
+   *  std::iota(all.begin(), all.end(), 0);
+   *  std::vector<unsigned> mus = shrink(sc, all);
+   * \endcode
+   *
+   *@ingroup Support
+   *@defgroup MUS Minimal unsatisfiable subsets
+   *@{
+   */
+
+  /**
+   * @brief deletion-based MUS extraction with clause-set refinement
+   *
+   * Removes one constraint at a time. If the rest stays unsatisfiable, the
+   * candidates are reduced to the core of that check, otherwise the
+   * constraint is part of the MUS.
+   *
+   * @param seed an unsatisfiable subset
+   * @returns a MUS contained in seed, sorted
+   **/
+  template <typename Context>
+  std::vector<unsigned> shrink(Soft_Constraints<Context> &sc, std::vector<unsigned> seed) {
+    std::vector<unsigned> crit;
+    std::vector<unsigned> test;
+    std::vector<unsigned> core;
+    std::vector<bool> in_core(sc.size());
+
+    while (!seed.empty()) {
+      unsigned const c = seed.back();
+      seed.pop_back();
+
+      test = crit;
+      test.insert(test.end(), seed.begin(), seed.end());
+      if (sc.satisfiable(test, &core)) {
+        crit.push_back(c);
+        continue;
+      }
+
+      // refinement, critical constraints are always part of the core
+      std::fill(in_core.begin(), in_core.end(), false);
+      for (unsigned i : core) in_core[i] = true;
+      seed.erase(std::remove_if(seed.begin(), seed.end(), [&in_core](unsigned i) { return !in_core[i]; }),
+                 seed.end());
+    }
+
+    std::sort(crit.begin(), crit.end());
+    return crit;
+  }
+
+  namespace detail {
+    template <typename Context>
+    std::vector<unsigned> quickxplain(Soft_Constraints<Context> &sc, std::vector<unsigned> const &background,
+                                      bool has_delta, std::vector<unsigned> const &candidates) {
+      if (has_delta && !sc.satisfiable(background)) {
+        return std::vector<unsigned>();
+      }
+      if (candidates.size() == 1) {
+        return candidates;
+      }
+
+      std::size_t const half = candidates.size() / 2;
+      std::vector<unsigned> const c1(candidates.begin(), candidates.begin() + half);
+      std::vector<unsigned> const c2(candidates.begin() + half, candidates.end());
+
+      std::vector<unsigned> b1 = background;
+      b1.insert(b1.end(), c1.begin(), c1.end());
+      std::vector<unsigned> d2 = quickxplain(sc, b1, !c1.empty(), c2);
+
+      std::vector<unsigned> b2 = background;
+      b2.insert(b2.end(), d2.begin(), d2.end());
+      std::vector<unsigned> d1 = quickxplain(sc, b2, !d2.empty(), c1);
+
+      d1.insert(d1.end(), d2.begin(), d2.end());
+      return d1;
+    }
+  }  // namespace detail
+
+  /**
+   * @brief MUS extraction with QuickXplain
+   *
+   * Divide and conquer, needs few checks if the MUS is small compared to
+   * the seed.
+   *
+   * @param seed a subset of the constraints
+   * @returns a MUS contained in seed, sorted, or an empty vector if seed is
+   *          satisfiable
+   **/
+  template <typename Context>
+  std::vector<unsigned> quickxplain(Soft_Constraints<Context> &sc, std::vector<unsigned> const &seed) {
+    std::vector<unsigned> core;
+    if (sc.satisfiable(seed, &core) || core.empty()) {
+      return std::vector<unsigned>();
+    }
+    std::vector<unsigned> mus = detail::quickxplain(sc, std::vector<unsigned>(), false, core);
+    std::sort(mus.begin(), mus.end());
+    return mus;
+  }
+
+  /**
+   * @brief extend a satisfiable subset to a maximal satisfiable subset
+   *
+   * Constraints that are satisfied by the model of a check are added
+   * without a solver call.
+   *
+   * @pre the last check of sc was seed and satisfiable
+   * @param seed a satisfiable subset
+   * @returns the MSS containing seed, sorted
+   **/
+  template <typename Context>
+  std::vector<unsigned> grow(Soft_Constraints<Context> &sc, std::vector<unsigned> const &seed) {
+    std::vector<bool> in(sc.size(), false);
+    for (unsigned i : seed) in[i] = true;
+    sc.satisfied(in);
+
+    std::vector<unsigned> mss;
+    for (unsigned i = 0; i < sc.size(); ++i) {
+      if (in[i]) continue;
+      mss.clear();
+      for (unsigned j = 0; j < sc.size(); ++j) {
+        if (in[j] || j == i) mss.push_back(j);
+      }
+      if (sc.satisfiable(mss)) {
+        in[i] = true;
+        sc.satisfied(in);
+      }
+    }
+
+    mss.clear();
+    for (unsigned i = 0; i < sc.size(); ++i) {
+      if (in[i]) mss.push_back(i);
+    }
+    return mss;
+  }
+
+  /// the constraints not contained in subset
+  inline std::vector<unsigned> complement(std::vector<unsigned> const &subset, unsigned size) {
+    std::vector<bool> in(size, false);
+    for (unsigned i : subset) in[i] = true;
+    std::vector<unsigned> ret;
+    for (unsigned i = 0; i < size; ++i) {
+      if (!in[i]) ret.push_back(i);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief enumerate all MUSes and MCSes with MARCO
+   *
+   * The map context tracks the explored part of the power set of the
+   * constraints with one Boolean variable per constraint. Each model of
+   * the map is a seed. Satisfiable seeds are grown to an MSS and everything
+   * below it is blocked, unsatisfiable seeds are shrunk to a MUS and
+   * everything above it is blocked.
+   *
+   * \param sc the constraints
+   * \param map an empty context used to store the explored seeds
+   * \param on_mus called with each MUS, return false to stop
+   * \param on_mcs called with each MCS, return false to stop
+   **/
+  template <typename Context, typename MapContext, typename MUSCallback, typename MCSCallback>
+  void marco(Soft_Constraints<Context> &sc, MapContext &map, MUSCallback on_mus, MCSCallback on_mcs) {
+    typedef typename MapContext::result_type MapExpr;
+
+    std::vector<MapExpr> m;
+    for (unsigned i = 0; i < sc.size(); ++i) {
+      m.push_back(map(logic::new_variable()));
+    }
+
+    std::vector<unsigned> seed;
+    std::vector<unsigned> core;
+    while (solve(map)) {
+      seed.clear();
+      for (unsigned i = 0; i < m.size(); ++i) {
+        if (static_cast<bool>(read_value(map, m[i]))) seed.push_back(i);
+      }
+
+      if (sc.satisfiable(seed, &core)) {
+        std::vector<unsigned> const mcs = complement(grow(sc, seed), sc.size());
+        if (mcs.empty()) return;  // all constraints are satisfiable together
+
+        MapExpr block = map(false);
+        for (unsigned i : mcs) block = map(logic::tag::or_tag(), block, m[i]);
+        metaSMT::assertion(map, block);
+        if (!on_mcs(mcs)) return;
+      } else {
+        std::vector<unsigned> const mus = shrink(sc, core);
+
+        MapExpr block = map(false);
+        for (unsigned i : mus) block = map(logic::tag::or_tag(), block, map(logic::tag::not_tag(), m[i]));
+        metaSMT::assertion(map, block);
+        if (!on_mus(mus) || mus.empty()) return;
+      }
+    }
+  }
+
+  /**
+   * @brief enumerate all MUSes of the constraints
+   *
+   * Uses a fresh Context as map for marco().
+   *
+   * @returns all MUSes, each sorted
+   **/
+  template <typename Context>
+  std::vector<std::vector<unsigned> > all_mus(Soft_Constraints<Context> &sc) {
+    std::vector<std::vector<unsigned> > result;
+    Context map;
+    marco(
+        sc, map,
+        [&result](std::vector<unsigned> const &mus) {
+          result.push_back(mus);
+          return true;
+        },
+        [](std::vector<unsigned> const &) { return true; });
+    return result;
+  }
+  /**@}*/
+}  // namespace metaSMT
+
+// vim: ts=2 sw=2 et
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "../API/Assertion.hpp"
+#include "../API/Assumption.hpp"
+#include "../API/Optimize.hpp"
+#include "../API/UnsatCore.hpp"
+#include "../Features.hpp"
+#include "../tags/Logic.hpp"
+#include "../tags/QF_BV.hpp"
+#include "cardinality.hpp"
+#include "pseudo_boolean.hpp"
+
+namespace metaSMT {
+
+  /**
+   * @brief search strategies of minimize(), maximize() and maxsat()
+   *
+   * - automatic: native if supported, else binary for objectives and
+   *   core_guided (with get_unsat_core_cmd) or linear for MaxSAT
+   * - native: the optimizer of the backend (minimize_cmd, maximize_cmd,
+   *   maxsat_cmd), falls back to automatic
+   * - linear: SAT-UNSAT search, each model bounds the next solve
+   * - binary: binary search on the cost, for objectives bit by bit from
+   *   the most significant bit
+   * - core_guided: WPM1 (weighted Fu-Malik) on the unsatisfiable cores,
+   *   MaxSAT only, objectives use binary
+   **/
+  enum class search_strategy { automatic, native, linear, binary, core_guided };
+
+  namespace detail {
+    /// removes the pending assumptions, the strategies repeat them for every solve
+    template <typename Context>
+    std::vector<typename Context::result_type> take_assumptions(Context &ctx) {
+      typedef typename Context::result_type result_type;
+      if constexpr (features::supports<Context, pending_assumptions_cmd<result_type> >::value) {
+        return ctx.command(pending_assumptions_cmd<result_type>());
+      } else {
+        return std::vector<result_type>();
+      }
+    }
+
+    template <typename Context>
+    void assume(Context &ctx, std::vector<typename Context::result_type> const &assumptions) {
+      for (typename Context::result_type const &a : assumptions) metaSMT::assumption(ctx, a);
+    }
+
+    /// sum of the weights of the soft constraints violated by the model
+    template <typename Context>
+    uint64_t violated_weight(Context &ctx, std::vector<typename Context::result_type> const &soft,
+                             std::vector<uint64_t> const &weights) {
+      uint64_t cost = 0;
+      for (std::size_t i = 0; i < soft.size(); ++i) {
+        if (!static_cast<bool>(read_value(ctx, soft[i]))) cost += weights[i];
+      }
+      return cost;
+    }
+
+    /**
+     * Bounds sum(weights[i] * relax[i]) <= k for k <= max_bound, encoded
+     * once: a totalizer for unit weights, else a pseudo-Boolean BDD
+     * whose nodes are shared between the bounds.
+     */
+    template <typename Context>
+    class Cost_Bound {
+     public:
+      typedef typename Context::result_type result_type;
+
+      Cost_Bound(Context &ctx, std::vector<result_type> const &relax, std::vector<uint64_t> const &weights,
+                 uint64_t max_bound)
+          : ctx_(ctx), relax_(relax), weights_(weights) {
+        if (std::all_of(weights_.begin(), weights_.end(), [](uint64_t w) { return w == 1; })) {
+          totalizer_.emplace(ctx, relax_, static_cast<unsigned>(max_bound));
+        } else {
+          for (uint64_t &w : weights_) w = std::min(w, max_bound + 1);
+          bdd_.emplace(ctx, relax_, weights_, max_bound + 1);
+        }
+      }
+
+      result_type leq(uint64_t k) {
+        if (totalizer_) return totalizer_->leq(static_cast<unsigned>(k));
+        return ctx_(logic::tag::not_tag{}, bdd_->at_least(k + 1));
+      }
+
+     private:
+      Context &ctx_;
+      std::vector<result_type> relax_;
+      std::vector<uint64_t> weights_;
+      std::optional<cardinality::Totalizer<Context> > totalizer_;
+      std::optional<pseudo_boolean::bdd::Encoder<Context> > bdd_;
+    };
+
+    /// minimal value of the unsigned objective, bit by bit from the MSB
+    template <typename Context>
+    std::optional<uint64_t> minimize_binary(Context &ctx, typename Context::result_type const &objective) {
+      typedef typename Context::result_type result_type;
+      namespace bvtags = logic::QF_BV::tag;
+
+      unsigned const width = ctx.get_bv_width(objective);
+      assert(width <= 64 && "objectives are limited to 64 bit");
+
+      std::vector<result_type> const hard = take_assumptions(ctx);
+      assume(ctx, hard);
+      if (!solve(ctx)) return std::nullopt;
+      uint64_t value = read_value(ctx, objective);
+
+      bool model = true;
+      std::vector<result_type> fixed;
+      for (unsigned i = width; i-- > 0;) {
+        result_type const zero =
+            ctx(logic::tag::equal_tag{}, ctx(bvtags::extract_tag{}, i, i, objective), ctx(bvtags::bit0_tag{}));
+        if (((value >> i) & 1) == 0) {
+          fixed.push_back(zero);
+          continue;
+        }
+
+        assume(ctx, hard);
+        assume(ctx, fixed);
+        metaSMT::assumption(ctx, zero);
+        model = solve(ctx);
+        if (model) {
+          value = read_value(ctx, objective);
+          fixed.push_back(zero);
+        } else {
+          fixed.push_back(ctx(logic::tag::not_tag{}, zero));
+        }
+      }
+
+      if (!model) {
+        assume(ctx, hard);
+        assume(ctx, fixed);
+        solve(ctx);
+      }
+      return value;
+    }
+
+    /// minimal value of the unsigned objective, SAT-UNSAT search
+    template <typename Context>
+    std::optional<uint64_t> minimize_linear(Context &ctx, typename Context::result_type const &objective) {
+      namespace bvtags = logic::QF_BV::tag;
+
+      unsigned const width = ctx.get_bv_width(objective);
+      assert(width <= 64 && "objectives are limited to 64 bit");
+
+      std::vector<typename Context::result_type> const hard = take_assumptions(ctx);
+      assume(ctx, hard);
+      if (!solve(ctx)) return std::nullopt;
+      uint64_t value = read_value(ctx, objective);
+
+      bool model = true;
+      while (value > 0) {
+        assume(ctx, hard);
+        metaSMT::assumption(ctx, ctx(bvtags::bvult_tag{}, objective, ctx(bvtags::bvuint_tag{}, value, width)));
+        model = solve(ctx);
+        if (!model) break;
+        value = read_value(ctx, objective);
+      }
+
+      if (!model) {
+        assume(ctx, hard);
+        metaSMT::assumption(ctx, ctx(bvtags::bvule_tag{}, objective, ctx(bvtags::bvuint_tag{}, value, width)));
+        solve(ctx);
+      }
+      return value;
+    }
+
+    /// SAT-UNSAT or binary search with a relaxation variable per soft constraint
+    template <typename Context>
+    std::optional<uint64_t> maxsat_relaxed(Context &ctx, std::vector<typename Context::result_type> const &soft,
+                                           std::vector<uint64_t> const &weights, bool binary) {
+      typedef typename Context::result_type result_type;
+
+      std::vector<result_type> const hard = take_assumptions(ctx);
+      std::vector<result_type> relax;
+      for (result_type const &s : soft) {
+        result_type const r = ctx(logic::new_variable());
+        metaSMT::assertion(ctx, ctx(logic::tag::or_tag{}, s, r));
+        relax.push_back(r);
+      }
+
+      assume(ctx, hard);
+      if (!solve(ctx)) return std::nullopt;
+      uint64_t cost = violated_weight(ctx, soft, weights);
+      if (cost == 0 || relax.empty()) return cost;
+
+      Cost_Bound<Context> bound(ctx, relax, weights, cost);
+      bool model = true;
+      uint64_t lower = 0;
+      while (lower < cost) {
+        uint64_t const k = binary ? lower + (cost - lower - 1) / 2 : cost - 1;
+        assume(ctx, hard);
+        metaSMT::assumption(ctx, bound.leq(k));
+        model = solve(ctx);
+        if (model) {
+          cost = violated_weight(ctx, soft, weights);
+        } else {
+          lower = k + 1;
+        }
+      }
+
+      if (!model) {
+        assume(ctx, hard);
+        metaSMT::assumption(ctx, bound.leq(cost));
+        solve(ctx);
+      }
+      return cost;
+    }
+
+    /// WPM1 by Ans&oacute;tegui, Bonet and Levy, relaxes each core by an exactly-one constraint
+    template <typename Context>
+    std::optional<uint64_t> maxsat_core_guided(Context &ctx, std::vector<typename Context::result_type> const &soft,
+                                               std::vector<uint64_t> const &weights) {
+      typedef typename Context::result_type result_type;
+
+      std::vector<result_type> const hard = take_assumptions(ctx);
+      struct Soft {
+        result_type formula;
+        uint64_t weight;
+        result_type selector;
+      };
+      std::vector<Soft> softs;
+      auto add = [&ctx, &softs](result_type const &f, uint64_t w) {
+        result_type const a = ctx(logic::new_variable());
+        metaSMT::assertion(ctx, ctx(logic::tag::implies_tag{}, a, f));
+        softs.push_back(Soft{f, w, a});
+      };
+      for (std::size_t i = 0; i < soft.size(); ++i) {
+        if (weights[i] > 0) add(soft[i], weights[i]);
+      }
+
+      // the core indices count the hard assumptions first, then the selectors of assumed
+      std::vector<std::size_t> assumed;
+      std::vector<std::size_t> core;
+      while (true) {
+        assume(ctx, hard);
+        assumed.clear();
+        for (std::size_t j = 0; j < softs.size(); ++j) {
+          if (softs[j].weight == 0) continue;
+          metaSMT::assumption(ctx, softs[j].selector);
+          assumed.push_back(j);
+        }
+        if (solve(ctx)) break;
+
+        core.clear();
+        if constexpr (features::supports<Context, get_unsat_core_cmd>::value) {
+          for (unsigned c : get_unsat_core(ctx)) {
+            if (c >= hard.size()) core.push_back(assumed[c - hard.size()]);
+          }
+        } else {
+          core = assumed;
+        }
+        if (core.empty()) return std::nullopt;
+
+        uint64_t wmin = softs[core[0]].weight;
+        for (std::size_t j : core) wmin = std::min(wmin, softs[j].weight);
+
+        std::vector<result_type> bs;
+        for (std::size_t j : core) {
+          result_type const f = softs[j].formula;
+          uint64_t const w = softs[j].weight;
+          softs[j].weight = 0;
+          if (w > wmin) add(f, w - wmin);
+
+          result_type const b = ctx(logic::new_variable());
+          bs.push_back(b);
+          add(ctx(logic::tag::or_tag{}, f, b), wmin);
+        }
+        metaSMT::assertion(ctx, cardinality_eq(ctx, bs, 1));
+      }
+      return violated_weight(ctx, soft, weights);
+    }
+  }  // namespace detail
+
+  /**
+   * @brief Optimization of unsigned bit-vector objectives and MaxSAT
+   *
+   * \code
+   *  DirectSolver_Context< BitBlast< SAT_Clause< solver::MiniSAT > > > ctx;
+   *  ...
+   *  std::optional<uint64_t> cost = minimize(ctx, evaluate(ctx, costs));
+   *  if (cost) {
+   *    // the model is optimal
+   *    read_value(ctx, x);
+   *  }
+   * \endcode
+   *
+   * All functions solve the assertions of the context repeatedly with
+   * assumptions, so learnt clauses are kept between the iterations. Bounds
+   * on the cost are encoded once and tightened by assumptions. Pending
+   * assumptions are hard constraints of every solve. Auxiliary variables and definitions are added to the
+   * context, they do not restrict the original variables.
+   *
+   * If the context supports the native commands of API/Optimize.hpp, they
+   * are used by default.
+   *
+   * @returns the optimum, or nothing if the assertions are unsatisfiable.
+   *          Afterwards read_value() returns an optimal model.
+   *
+   * @ingroup Support
+   * @defgroup Optimize Optimization
+   * @{
+   **/
+
+  /// minimal value of the unsigned bit-vector objective (at most 64 bit)
+  template <typename Context>
+  std::optional<uint64_t> minimize(Context &ctx, typename Context::result_type const &objective,
+                                   search_strategy strategy = search_strategy::automatic) {
+    if constexpr (features::supports<Context, minimize_cmd>::value) {
+      if (strategy == search_strategy::automatic || strategy == search_strategy::native) {
+        if (!ctx.command(minimize_cmd(), objective)) return std::nullopt;
+        return static_cast<uint64_t>(read_value(ctx, objective));
+      }
+    }
+    if (strategy == search_strategy::linear) {
+      return detail::minimize_linear(ctx, objective);
+    }
+    return detail::minimize_binary(ctx, objective);
+  }
+
+  /// maximal value of the unsigned bit-vector objective (at most 64 bit)
+  template <typename Context>
+  std::optional<uint64_t> maximize(Context &ctx, typename Context::result_type const &objective,
+                                   search_strategy strategy = search_strategy::automatic) {
+    if constexpr (features::supports<Context, maximize_cmd>::value) {
+      if (strategy == search_strategy::automatic || strategy == search_strategy::native) {
+        if (!ctx.command(maximize_cmd(), objective)) return std::nullopt;
+        return static_cast<uint64_t>(read_value(ctx, objective));
+      }
+    }
+    // max(x) = mask - min(~x)
+    unsigned const width = ctx.get_bv_width(objective);
+    uint64_t const mask = width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+    std::optional<uint64_t> const inverted =
+        minimize(ctx, ctx(logic::QF_BV::tag::bvnot_tag{}, objective),
+                 strategy == search_strategy::native ? search_strategy::automatic : strategy);
+    if (!inverted) return std::nullopt;
+    return mask - *inverted;
+  }
+
+  /**
+   * @brief weighted MaxSAT
+   *
+   * @returns the minimal sum of the weights of the violated soft
+   *          constraints, or nothing if the assertions are unsatisfiable
+   **/
+  template <typename Context>
+  std::optional<uint64_t> maxsat(Context &ctx, std::vector<typename Context::result_type> const &soft,
+                                 std::vector<uint64_t> const &weights,
+                                 search_strategy strategy = search_strategy::automatic) {
+    assert(soft.size() == weights.size() && "MaxSAT requires one weight per soft constraint");
+
+    if constexpr (features::supports<Context, maxsat_cmd>::value) {
+      if (strategy == search_strategy::automatic || strategy == search_strategy::native) {
+        if (!ctx.command(maxsat_cmd(), soft, weights)) return std::nullopt;
+        return detail::violated_weight(ctx, soft, weights);
+      }
+    }
+    if (strategy == search_strategy::automatic || strategy == search_strategy::native) {
+      strategy = features::supports<Context, get_unsat_core_cmd>::value ? search_strategy::core_guided
+                                                                        : search_strategy::linear;
+    }
+
+    if (strategy == search_strategy::core_guided) {
+      return detail::maxsat_core_guided(ctx, soft, weights);
+    }
+    return detail::maxsat_relaxed(ctx, soft, weights, strategy == search_strategy::binary);
+  }
+
+  /// unweighted MaxSAT, the number of violated soft constraints
+  template <typename Context>
+  std::optional<uint64_t> maxsat(Context &ctx, std::vector<typename Context::result_type> const &soft,
+                                 search_strategy strategy = search_strategy::automatic) {
+    return maxsat(ctx, soft, std::vector<uint64_t>(soft.size(), 1), strategy);
+  }
+  /**@}*/
+}  // namespace metaSMT
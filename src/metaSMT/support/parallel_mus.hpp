@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "mus.hpp"
+
+namespace metaSMT {
+
+  namespace detail {
+    /**
+     * @brief the explored seeds shared by the workers of parallel_marco
+     *
+     * Blocking clauses are stored as signed indices: +(i+1) for "constraint
+     * i is in the seed", -(i+1) for "constraint i is not in the seed".
+     * Workers add the new clauses to their own map context before each
+     * check.
+     **/
+    template <typename MUSCallback, typename MCSCallback>
+    class Shared_Seed_Map {
+     public:
+      Shared_Seed_Map(MUSCallback &on_mus, MCSCallback &on_mcs) : on_mus_(on_mus), on_mcs_(on_mcs), stop_(false) {}
+
+      bool stopped() const { return stop_; }
+
+      void stop() { stop_ = true; }
+
+      /// copy the clauses added since index synced
+      void sync(std::size_t &synced, std::vector<std::vector<int> > &out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.assign(blocks_.begin() + synced, blocks_.end());
+        synced = blocks_.size();
+      }
+
+      void add_mus(std::vector<unsigned> const &mus) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || !found_mus_.insert(mus).second) return;
+
+        std::vector<int> block;
+        for (unsigned i : mus) block.push_back(-static_cast<int>(i) - 1);
+        blocks_.push_back(block);
+        if (!on_mus_(mus) || mus.empty()) stop_ = true;
+      }
+
+      void add_mcs(std::vector<unsigned> const &mcs) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || !found_mcs_.insert(mcs).second) return;
+
+        std::vector<int> block;
+        for (unsigned i : mcs) block.push_back(static_cast<int>(i) + 1);
+        blocks_.push_back(block);
+        if (!on_mcs_(mcs)) stop_ = true;
+      }
+
+      void fail(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) error_ = e;
+        stop_ = true;
+      }
+
+      void rethrow() {
+        if (error_) std::rethrow_exception(error_);
+      }
+
+     private:
+      MUSCallback &on_mus_;
+      MCSCallback &on_mcs_;
+      std::atomic<bool> stop_;
+
+      std::mutex mutex_;
+      std::vector<std::vector<int> > blocks_;
+      std::set<std::vector<unsigned> > found_mus_;
+      std::set<std::vector<unsigned> > found_mcs_;
+      std::exception_ptr error_;
+    };
+
+    template <typename Context, typename Factory, typename SharedMap>
+    void parallel_marco_worker(Factory &factory, SharedMap &shared, unsigned self, unsigned partition_bits) {
+      typedef typename Context::result_type Expr;
+
+      Context ctx;
+      Soft_Constraints<Context> sc(ctx, factory(ctx));
+
+      Context map;
+      std::vector<Expr> m;
+      for (unsigned i = 0; i < sc.size(); ++i) {
+        m.push_back(map(logic::new_variable()));
+      }
+
+      // the worker starts in its own part of the lattice, given by the
+      // membership of the first partition_bits constraints, and joins the
+      // others when that part is exhausted
+      bool partitioned = partition_bits > 0 && partition_bits <= sc.size();
+
+      std::size_t synced = 0;
+      std::vector<std::vector<int> > blocks;
+      std::vector<unsigned> seed;
+      std::vector<unsigned> core;
+      while (!shared.stopped()) {
+        shared.sync(synced, blocks);
+        for (std::vector<int> const &b : blocks) {
+          Expr block = map(false);
+          for (int l : b) {
+            Expr const v = m[std::abs(l) - 1];
+            block = map(logic::tag::or_tag(), block, l > 0 ? v : map(logic::tag::not_tag(), v));
+          }
+          metaSMT::assertion(map, block);
+        }
+
+        if (partitioned) {
+          for (unsigned j = 0; j < partition_bits; ++j) {
+            metaSMT::assumption(map, (self >> j) & 1 ? m[j] : map(logic::tag::not_tag(), m[j]));
+          }
+        }
+        if (!solve(map)) {
+          if (partitioned) {
+            partitioned = false;
+            continue;
+          }
+          // every seed is blocked, all MUSes and MCSes are known
+          shared.stop();
+          return;
+        }
+
+        seed.clear();
+        for (unsigned i = 0; i < m.size(); ++i) {
+          if (static_cast<bool>(read_value(map, m[i]))) seed.push_back(i);
+        }
+
+        if (sc.satisfiable(seed, &core)) {
+          std::vector<unsigned> const mcs = complement(grow(sc, seed), sc.size());
+          if (mcs.empty()) {
+            // all constraints are satisfiable together
+            shared.stop();
+            return;
+          }
+          shared.add_mcs(mcs);
+        } else {
+          shared.add_mus(shrink(sc, core));
+        }
+      }
+    }
+  }  // namespace detail
+
+  /**
+   * @brief enumerate all MUSes and MCSes with several worker threads
+   *
+   * Parallel version of marco(). Each worker owns a Context with its own
+   * copy of the constraints, created by factory, and a map context. The
+   * workers share the blocking clauses of all results found so far and
+   * start in disjoint parts of the power set, given by the membership of
+   * the first log2(threads) constraints.
+   *
+   * Results are streamed to the callbacks as they are found. The callbacks
+   * are called from the worker threads, one call at a time, and every
+   * result is reported once.
+   *
+   * \code
+   *  typedef DirectSolver_Context< BitBlast< SAT_Clause< solver::MiniSAT > > > Context;
+   *
+   *  parallel_marco<Context>(
+   *      [](Context &ctx) { return build_constraints(ctx); }, 8,
+   *      [](std::vector<unsigned> const &mus) { print(mus); return true; },
+   *      [](std::vector<unsigned> const &mcs) { return true; });
+   * \endcode
+   *
+   * \param factory called concurrently, once per worker, as
+   *        factory(Context &); returns a
+   *        std::vector<Context::result_type> of the constraints, the same
+   *        constraints in the same order for every worker
+   * \param threads number of workers, 0 selects the hardware concurrency
+   * \param on_mus called with each MUS, return false to stop
+   * \param on_mcs called with each MCS, return false to stop
+   * \throws the first exception thrown by a worker
+   *
+   * @ingroup MUS
+   **/
+  template <typename Context, typename Factory, typename MUSCallback, typename MCSCallback>
+  void parallel_marco(Factory factory, unsigned threads, MUSCallback on_mus, MCSCallback on_mcs) {
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    unsigned partition_bits = 0;
+    while ((2u << partition_bits) <= threads) ++partition_bits;
+
+    detail::Shared_Seed_Map<MUSCallback, MCSCallback> shared(on_mus, on_mcs);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+      workers.emplace_back([&factory, &shared, i, partition_bits] {
+        try {
+          detail::parallel_marco_worker<Context>(factory, shared, i, partition_bits);
+        } catch (...) {
+          shared.fail(std::current_exception());
+        }
+      });
+    }
+    for (std::thread &t : workers) {
+      t.join();
+    }
+    shared.rethrow();
+  }
+
+  /**
+   * @brief enumerate all MUSes with several worker threads
+   *
+   * @returns all MUSes, each sorted, in the order they were found
+   * @ingroup MUS
+   **/
+  template <typename Context, typename Factory>
+  std::vector<std::vector<unsigned> > parallel_all_mus(Factory factory, unsigned threads = 0) {
+    std::vector<std::vector<unsigned> > result;
+    parallel_marco<Context>(
+        factory, threads,
+        [&result](std::vector<unsigned> const &mus) {
+          result.push_back(mus);
+          return true;
+        },
+        [](std::vector<unsigned> const &) { return true; });
+    return result;
+  }
+}  // namespace metaSMT
+
+// vim: ts=2 sw=2 et
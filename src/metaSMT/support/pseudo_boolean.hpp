@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pseudo_boolean/Evaluator.hpp"
+#include "pseudo_boolean/object.hpp"
+
+namespace metaSMT {
+
+  namespace cardtags = metaSMT::logic::cardinality::tag;
+
+  /**
+   * @brief weighted linear constraints over Boolean variables
+   *
+   * pb_leq(ctx, ps, weights, k) is weights[0] * ps[0] + ... + weights[n-1] * ps[n-1] <= k.
+   * Weights may be negative. The encoding is taken from the "pseudo_boolean"
+   * option or given per constraint:
+   *
+   * \code
+   *  assertion(ctx, pb_leq(ctx, ps, weights, 100));
+   *  assertion(ctx, evaluate(ctx, pseudo_boolean::pseudo_boolean(cardtags::ge_tag(), ps, weights, 7, "gte")));
+   * \endcode
+   *
+   * @ingroup Support
+   */
+  template <typename Context, typename Boolean>
+  typename Context::result_type pb_eq(Context &ctx, std::vector<Boolean> const &ps,
+                                      std::vector<int64_t> const &weights, int64_t bound) {
+    return ctx(pseudo_boolean::pseudo_boolean(cardtags::eq_tag(), ps, weights, bound));
+  }
+
+  template <typename Context, typename Boolean>
+  typename Context::result_type pb_geq(Context &ctx, std::vector<Boolean> const &ps,
+                                       std::vector<int64_t> const &weights, int64_t bound) {
+    return ctx(pseudo_boolean::pseudo_boolean(cardtags::ge_tag(), ps, weights, bound));
+  }
+
+  template <typename Context, typename Boolean>
+  typename Context::result_type pb_leq(Context &ctx, std::vector<Boolean> const &ps,
+                                       std::vector<int64_t> const &weights, int64_t bound) {
+    return ctx(pseudo_boolean::pseudo_boolean(cardtags::le_tag(), ps, weights, bound));
+  }
+
+  template <typename Context, typename Boolean>
+  typename Context::result_type pb_gt(Context &ctx, std::vector<Boolean> const &ps,
+                                      std::vector<int64_t> const &weights, int64_t bound) {
+    return ctx(pseudo_boolean::pseudo_boolean(cardtags::gt_tag(), ps, weights, bound));
+  }
+
+  template <typename Context, typename Boolean>
+  typename Context::result_type pb_lt(Context &ctx, std::vector<Boolean> const &ps,
+                                      std::vector<int64_t> const &weights, int64_t bound) {
+    return ctx(pseudo_boolean::pseudo_boolean(cardtags::lt_tag(), ps, weights, bound));
+  }
+}  // namespace metaSMT
@@ -0,0 +1,159 @@
+#pragma once
+#include <metaSMT/tags/Cardinality.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+
+#include "../../API/Evaluator.hpp"
+#include "../../API/Options.hpp"
+#include "../Options.hpp"
+#include "adder_impl.hpp"
+#include "bdd_impl.hpp"
+#include "binary_merge_impl.hpp"
+#include "gte_impl.hpp"
+#include "native_impl.hpp"
+#include "object.hpp"
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+    namespace cardtags = metaSMT::logic::cardinality::tag;
+
+    /**
+     * The constraint with positive weights only, sorted by decreasing
+     * weight. A negative weight w of p is replaced by -w for not p, which
+     * adds -w to the bound.
+     */
+    template <typename Context>
+    struct Normalized {
+      std::vector<typename Context::result_type> xs;
+      std::vector<uint64_t> ws;
+      int64_t bound;
+      uint64_t total;
+    };
+
+    template <typename Context, typename Tag, typename Boolean>
+    Normalized<Context> normalize(Context &ctx, PseudoBoolean<Tag, Boolean> const &c) {
+      assert(c.ps.size() == c.weights.size() && "Pseudo-Boolean constraint requires one weight per input variable");
+
+      std::vector<std::size_t> order(c.ps.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&c](std::size_t a, std::size_t b) {
+        return std::abs(c.weights[a]) > std::abs(c.weights[b]);
+      });
+
+      Normalized<Context> n;
+      n.bound = c.bound;
+      n.total = 0;
+      for (std::size_t i : order) {
+        int64_t const w = c.weights[i];
+        if (w == 0) continue;
+        if (w > 0) {
+          n.xs.push_back(ctx(c.ps[i]));
+        } else {
+          n.xs.push_back(ctx(logic::tag::not_tag{}, c.ps[i]));
+          n.bound -= w;
+        }
+        n.ws.push_back(std::abs(w));
+        n.total += std::abs(w);
+      }
+      return n;
+    }
+
+    /// largest j for which (sum >= j) is needed to decide the operator with bound k
+    inline int64_t max_query(cardtags::lt_tag const &, int64_t k) { return k; }
+    inline int64_t max_query(cardtags::le_tag const &, int64_t k) { return k + 1; }
+    inline int64_t max_query(cardtags::eq_tag const &, int64_t k) { return k + 1; }
+    inline int64_t max_query(cardtags::ge_tag const &, int64_t k) { return k; }
+    inline int64_t max_query(cardtags::gt_tag const &, int64_t k) { return k + 1; }
+
+    template <typename Context, typename AtLeast>
+    typename Context::result_type compare(Context &ctx, cardtags::lt_tag const &, int64_t k, AtLeast at_least) {
+      return ctx(logic::tag::not_tag{}, at_least(k));
+    }
+
+    template <typename Context, typename AtLeast>
+    typename Context::result_type compare(Context &ctx, cardtags::le_tag const &, int64_t k, AtLeast at_least) {
+      return ctx(logic::tag::not_tag{}, at_least(k + 1));
+    }
+
+    template <typename Context, typename AtLeast>
+    typename Context::result_type compare(Context &ctx, cardtags::eq_tag const &, int64_t k, AtLeast at_least) {
+      return ctx(logic::tag::and_tag{}, at_least(k), ctx(logic::tag::not_tag{}, at_least(k + 1)));
+    }
+
+    template <typename Context, typename AtLeast>
+    typename Context::result_type compare(Context &, cardtags::ge_tag const &, int64_t k, AtLeast at_least) {
+      return at_least(k);
+    }
+
+    template <typename Context, typename AtLeast>
+    typename Context::result_type compare(Context &, cardtags::gt_tag const &, int64_t k, AtLeast at_least) {
+      return at_least(k + 1);
+    }
+
+    /**
+     * Encodes the normalized constraint with Encoder. Weights are clipped
+     * to the largest queried bound, which does not change the constraint
+     * but keeps large coefficients from blowing up the encoding. Trivial
+     * bounds are decided without encoding.
+     */
+    template <template <typename> class Encoder, typename Context, typename Tag>
+    typename Context::result_type encode(Context &ctx, Tag const &tag, Normalized<Context> &n) {
+      int64_t const jmax = max_query(tag, n.bound);
+      uint64_t const cap = jmax <= 0 ? 1 : std::min<uint64_t>(jmax, n.total + 1);
+      for (uint64_t &w : n.ws) {
+        w = std::min(w, cap);
+      }
+
+      std::optional<Encoder<Context> > encoder;
+      return compare(ctx, tag, n.bound, [&ctx, &n, &encoder, cap](int64_t j) {
+        if (j <= 0) return ctx(true);
+        if (static_cast<uint64_t>(j) > n.total) return ctx(false);
+        if (!encoder) encoder.emplace(ctx, n.xs, n.ws, cap);
+        return encoder->at_least(j);
+      });
+    }
+  }  // namespace pseudo_boolean
+
+  /**
+   * Evaluates pseudo-Boolean constraints with the encoding given by the
+   * constraint or the "pseudo_boolean" option: "native", "bdd", "gte"
+   * (generalized totalizer), "binary_merge" or "adder". The default is
+   * "native" for contexts supporting features::cardinality_api if the
+   * coefficients fit, else "bdd".
+   */
+  template <typename Tag, typename Boolean>
+  struct Evaluator<pseudo_boolean::PseudoBoolean<Tag, Boolean> > : public std::true_type {
+    template <typename Context>
+    static typename Context::result_type eval(Context &ctx, pseudo_boolean::PseudoBoolean<Tag, Boolean> const &c) {
+      option::pseudo_boolean_encoding enc = get_option(ctx, option::pseudo_boolean());
+      if (!c.encoding.empty()) {
+        option::parse(c.encoding, enc);
+      }
+      if (enc == option::pseudo_boolean_encoding::automatic) {
+        bool const native =
+            features::supports<Context, features::cardinality_api>::value && pseudo_boolean::native::representable(c);
+        enc = native ? option::pseudo_boolean_encoding::native : option::pseudo_boolean_encoding::bdd;
+      }
+      if (enc == option::pseudo_boolean_encoding::native) {
+        return pseudo_boolean::native::pseudo_boolean(ctx, c);
+      }
+
+      pseudo_boolean::Normalized<Context> n = pseudo_boolean::normalize(ctx, c);
+      switch (enc) {
+        case option::pseudo_boolean_encoding::bdd:
+          return pseudo_boolean::encode<pseudo_boolean::bdd::Encoder>(ctx, Tag(), n);
+        case option::pseudo_boolean_encoding::gte:
+          return pseudo_boolean::encode<pseudo_boolean::gte::Encoder>(ctx, Tag(), n);
+        case option::pseudo_boolean_encoding::binary_merge:
+          return pseudo_boolean::encode<pseudo_boolean::binary_merge::Encoder>(ctx, Tag(), n);
+        case option::pseudo_boolean_encoding::adder:
+          return pseudo_boolean::encode<pseudo_boolean::adder::Encoder>(ctx, Tag(), n);
+        default:
+          assert(false && "Unknown pseudo-Boolean implementation");
+          throw std::exception();
+      }
+    }
+  };  // Evaluator
+}  // namespace metaSMT
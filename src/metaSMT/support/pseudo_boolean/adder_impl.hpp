@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../../tags/Logic.hpp"
+#include "../../tags/QF_BV.hpp"
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+    namespace adder {
+
+      /**
+       * Adds the weights of the true inputs as bit-vectors, wide enough
+       * for the sum of all weights, and compares the sum with the bound.
+       */
+      template <typename Context>
+      class Encoder {
+       public:
+        typedef typename Context::result_type result_type;
+
+        Encoder(Context &ctx, std::vector<result_type> const &xs, std::vector<uint64_t> const &ws, uint64_t cap)
+            : ctx_(ctx), width_(width(ws, cap)), sum_(bv(0)) {
+          for (std::size_t u = 0; u < xs.size(); ++u) {
+            sum_ = ctx(logic::QF_BV::tag::bvadd_tag{}, sum_, ctx(logic::tag::ite_tag{}, xs[u], bv(ws[u]), bv(0)));
+          }
+        }
+
+        result_type at_least(uint64_t j) { return ctx_(logic::QF_BV::tag::bvuge_tag{}, sum_, bv(j)); }
+
+       private:
+        /// bits for the sum of all weights and the bound cap
+        static unsigned width(std::vector<uint64_t> const &ws, uint64_t cap) {
+          uint64_t total = cap;
+          for (uint64_t w : ws) total += w;
+          unsigned width = 1;
+          while (width < 64 && (total >> width) != 0) ++width;
+          return width;
+        }
+
+        result_type bv(uint64_t value) { return ctx_(logic::QF_BV::tag::bvuint_tag{}, value, width_); }
+
+        Context &ctx_;
+        unsigned width_;
+        result_type sum_;
+      };
+    }  // namespace adder
+  }    // namespace pseudo_boolean
+}  // namespace metaSMT
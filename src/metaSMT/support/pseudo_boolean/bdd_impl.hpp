@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "../../tags/Logic.hpp"
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+    namespace bdd {
+
+      /**
+       * Reduced BDD for w[i] * xs[i] + ... + w[n-1] * xs[n-1] >= j after
+       * E&eacute;n and S&ouml;rensson [1], with the interval sharing of
+       * Ab&iacute;o et al. [2].
+       *
+       * Each node stores the interval of bounds j for which it represents
+       * the same function, so nodes are shared between all bounds of that
+       * interval and between all queries of one Encoder. Constant children
+       * are folded into AND / OR instead of ITE.
+       *
+       * [1] N. E&eacute;n and N. S&ouml;rensson. Translating
+       * pseudo-boolean constraints into SAT. In Journal on Satisfiability,
+       * Boolean Modeling and Computation, volume 2, pages 1-26, 2006.
+       *
+       * [2] I. Ab&iacute;o, R. Nieuwenhuis, A. Oliveras and E.
+       * Rodr&iacute;guez-Carbonell. BDDs for pseudo-Boolean constraints -
+       * revisited. In Theory and Applications of Satisfiability Testing
+       * (SAT), pages 61-75, 2011.
+       */
+      template <typename Context>
+      class Encoder {
+       public:
+        typedef typename Context::result_type result_type;
+
+        Encoder(Context &ctx, std::vector<result_type> const &xs, std::vector<uint64_t> const &ws, uint64_t)
+            : ctx_(ctx), xs_(xs), ws_(ws), rest_(xs.size() + 1, 0), nodes_(xs.size()) {
+          for (std::size_t i = xs.size(); i > 0; --i) {
+            rest_[i - 1] = rest_[i] + static_cast<int64_t>(ws[i - 1]);
+          }
+        }
+
+        result_type at_least(uint64_t j) {
+          Node const n = build(0, static_cast<int64_t>(j));
+          if (n.kind == Node::TRUE) return ctx_(true);
+          if (n.kind == Node::FALSE) return ctx_(false);
+          return *n.expr;
+        }
+
+       private:
+        struct Node {
+          enum Kind { FALSE, TRUE, EXPR };
+
+          Kind kind;
+          std::optional<result_type> expr;
+          /// the node represents the bounds lo, ..., hi
+          int64_t lo, hi;
+        };
+
+        static constexpr int64_t min_bound = std::numeric_limits<int64_t>::min() / 2;
+        static constexpr int64_t max_bound = std::numeric_limits<int64_t>::max() / 2;
+
+        Node build(std::size_t i, int64_t j) {
+          if (j <= 0) return Node{Node::TRUE, std::nullopt, min_bound, 0};
+          if (j > rest_[i]) return Node{Node::FALSE, std::nullopt, rest_[i] + 1, max_bound};
+
+          typename std::map<int64_t, Node>::iterator it = nodes_[i].upper_bound(j);
+          if (it != nodes_[i].begin()) {
+            --it;
+            if (it->second.hi >= j) return it->second;
+          }
+
+          int64_t const w = static_cast<int64_t>(ws_[i]);
+          Node const hi = build(i + 1, j - w);
+          Node const lo = build(i + 1, j);
+
+          Node n = ite(xs_[i], hi, lo);
+          n.lo = std::max(hi.lo + w, lo.lo);
+          n.hi = std::min(hi.hi == max_bound ? max_bound : hi.hi + w, lo.hi);
+          nodes_[i].insert(std::make_pair(n.lo, n));
+          return n;
+        }
+
+        Node ite(result_type const &x, Node const &t, Node const &e) {
+          Node n = t;
+          if (t.kind == e.kind && t.kind != Node::EXPR) {
+            return n;
+          } else if (t.kind == Node::TRUE && e.kind == Node::FALSE) {
+            n.expr = x;
+          } else if (t.kind == Node::TRUE) {
+            n.expr = ctx_(logic::tag::or_tag{}, x, *e.expr);
+          } else if (t.kind == Node::FALSE) {
+            // the bound is monotone, the then-branch is never weaker
+            n.kind = Node::FALSE;
+            return n;
+          } else if (e.kind == Node::FALSE) {
+            n.expr = ctx_(logic::tag::and_tag{}, x, *t.expr);
+          } else {
+            n.expr = ctx_(logic::tag::ite_tag{}, x, *t.expr, *e.expr);
+          }
+          n.kind = Node::EXPR;
+          return n;
+        }
+
+        Context &ctx_;
+        std::vector<result_type> const &xs_;
+        std::vector<uint64_t> const &ws_;
+        std::vector<int64_t> rest_;
+        std::vector<std::map<int64_t, Node> > nodes_;
+      };
+    }  // namespace bdd
+  }    // namespace pseudo_boolean
+}  // namespace metaSMT
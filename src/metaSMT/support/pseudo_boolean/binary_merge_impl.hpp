@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../cardinality/sorting_network_impl.hpp"
+#include "../cardinality/unary.hpp"
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+    namespace binary_merge {
+
+      /**
+       * Sorter based encoding after E&eacute;n and S&ouml;rensson [1] in
+       * base 2, similar to the binary merge of Manthey et al. [2].
+       *
+       * Bucket i holds the inputs whose weight has bit i set and the carries
+       * of bucket i-1. Each bucket is sorted with the odd-even merge sort of
+       * cardinality::sorting_network, every second output of a sorted bucket
+       * is a carry into the next bucket. The sum is then
+       *
+       *    2^top * count(bucket top) + sum_{i < top} 2^i * parity(bucket i)
+       *
+       * and sum >= j is decided on these digits. The size grows with the
+       * number of bits of the weights instead of their value.
+       *
+       * [1] N. E&eacute;n and N. S&ouml;rensson. Translating
+       * pseudo-boolean constraints into SAT. In Journal on Satisfiability,
+       * Boolean Modeling and Computation, volume 2, pages 1-26, 2006.
+       *
+       * [2] N. Manthey, T. Philipp and P. Steinke. A more compact
+       * translation of pseudo-Boolean constraints into CNF such that
+       * generalized arc consistency is maintained. In KI 2014: Advances in
+       * Artificial Intelligence, pages 123-134, 2014.
+       */
+      template <typename Context>
+      class Encoder {
+       public:
+        typedef typename Context::result_type result_type;
+        typedef cardinality::unary::Output<Context> Output;
+
+        Encoder(Context &ctx, std::vector<result_type> const &xs, std::vector<uint64_t> const &ws, uint64_t)
+            : ctx_(ctx) {
+          uint64_t max_weight = 0;
+          for (uint64_t w : ws) max_weight = std::max(max_weight, w);
+          unsigned top = 0;
+          while ((max_weight >> top) > 1) ++top;
+
+          std::vector<Output> carries;
+          for (unsigned i = 0; i <= top; ++i) {
+            std::vector<Output> bucket = carries;
+            for (std::size_t u = 0; u < xs.size(); ++u) {
+              if ((ws[u] >> i) & 1) bucket.push_back(xs[u]);
+            }
+            std::vector<Output> const sorted = sort(bucket);
+
+            carries.clear();
+            for (std::size_t k = 1; k < sorted.size(); k += 2) {
+              carries.push_back(sorted[k]);
+            }
+
+            if (i < top) {
+              // parity: an odd number of inputs are true
+              Output parity;
+              for (std::size_t k = 0; k < sorted.size(); k += 2) {
+                Output odd = sorted[k];
+                if (k + 1 < sorted.size() && sorted[k + 1]) {
+                  odd = cardinality::unary::And(ctx, odd, Output(ctx(logic::tag::not_tag{}, *sorted[k + 1])));
+                }
+                parity = cardinality::unary::Or(ctx, parity, odd);
+              }
+              digits_.push_back(parity);
+            } else {
+              top_ = sorted;
+            }
+          }
+        }
+
+        result_type at_least(uint64_t j) {
+          unsigned const top = digits_.size();
+          uint64_t const q = j >> top;
+          uint64_t const r = j & ((uint64_t(1) << top) - 1);
+
+          // count >= q + 1  |  (count >= q & lower digits >= r)
+          result_type const lower = ctx_(logic::tag::and_tag{}, count_at_least(q), digits_at_least(top, r));
+          return ctx_(logic::tag::or_tag{}, count_at_least(q + 1), lower);
+        }
+
+       private:
+        std::vector<Output> sort(std::vector<Output> const &bucket) {
+          if (bucket.empty()) return bucket;
+          std::size_t n = 1;
+          while (n < bucket.size()) n *= 2;
+          std::vector<Output> padded = bucket;
+          padded.resize(n);
+          std::vector<Output> sorted = cardinality::sorting_network::sort(ctx_, padded, n);
+          sorted.resize(bucket.size());
+          return sorted;
+        }
+
+        result_type count_at_least(uint64_t q) {
+          if (q == 0) return ctx_(true);
+          if (q > top_.size() || !top_[q - 1]) return ctx_(false);
+          return *top_[q - 1];
+        }
+
+        /// digits_[0..i-1] >= r
+        result_type digits_at_least(unsigned i, uint64_t r) {
+          if (r == 0) return ctx_(true);
+          Output const &d = digits_[i - 1];
+          uint64_t const bit = uint64_t(1) << (i - 1);
+          if (r >= bit) {
+            if (!d) return ctx_(false);
+            return ctx_(logic::tag::and_tag{}, *d, digits_at_least(i - 1, r - bit));
+          }
+          if (!d) return digits_at_least(i - 1, r);
+          return ctx_(logic::tag::or_tag{}, *d, digits_at_least(i - 1, r));
+        }
+
+        Context &ctx_;
+        std::vector<Output> digits_;
+        std::vector<Output> top_;
+      };
+    }  // namespace binary_merge
+  }    // namespace pseudo_boolean
+}  // namespace metaSMT
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "../cardinality/unary.hpp"
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+    namespace gte {
+
+      /**
+       * Generalized totalizer by Joshi et al. [1].
+       *
+       * Like the totalizer, but each node has one output per sum of weights
+       * that its inputs can reach, o[s] <-> (sum >= s). Sums above cap are
+       * merged into cap. A node computes its outputs from the outputs a and
+       * b of its children as
+       *
+       *    e[s] = OR_{min(i + l, cap) = s} (a[i] & b[l])   with a[0] = b[0] = true
+       *    o[s] = e[s] | o[s']                             for the next larger sum s'
+       *
+       * The size depends on the number of distinct sums, not on the size of
+       * the weights.
+       *
+       * [1] S. Joshi, R. Martins and V. Manquinho. Generalized totalizer
+       * encoding for pseudo-Boolean constraints. In Principles and Practice
+       * of Constraint Programming (CP), pages 200-209, 2015.
+       */
+      template <typename Context>
+      class Encoder {
+       public:
+        typedef typename Context::result_type result_type;
+        typedef std::map<uint64_t, cardinality::unary::Output<Context> > Sums;
+
+        Encoder(Context &ctx, std::vector<result_type> const &xs, std::vector<uint64_t> const &ws, uint64_t cap)
+            : ctx_(ctx), cap_(cap) {
+          if (!xs.empty()) root_ = count(xs, ws, 0, xs.size());
+        }
+
+        result_type at_least(uint64_t j) {
+          typename Sums::const_iterator it = root_.lower_bound(j);
+          if (it == root_.end() || !it->second) return ctx_(false);
+          return *it->second;
+        }
+
+       private:
+        Sums count(std::vector<result_type> const &xs, std::vector<uint64_t> const &ws, std::size_t begin,
+                   std::size_t end) {
+          if (end - begin == 1) {
+            Sums leaf;
+            leaf[std::min(ws[begin], cap_)] = xs[begin];
+            return leaf;
+          }
+          std::size_t const mid = begin + (end - begin) / 2;
+          return merge(count(xs, ws, begin, mid), count(xs, ws, mid, end));
+        }
+
+        Sums merge(Sums const &a, Sums const &b) {
+          using cardinality::unary::And;
+          using cardinality::unary::Or;
+
+          Sums e;
+          for (typename Sums::const_iterator i = a.begin(); i != a.end(); ++i) {
+            e[i->first] = Or(ctx_, e[i->first], i->second);
+          }
+          for (typename Sums::const_iterator l = b.begin(); l != b.end(); ++l) {
+            e[l->first] = Or(ctx_, e[l->first], l->second);
+          }
+          for (typename Sums::const_iterator i = a.begin(); i != a.end(); ++i) {
+            for (typename Sums::const_iterator l = b.begin(); l != b.end(); ++l) {
+              uint64_t const s = std::min(i->first + l->first, cap_);
+              e[s] = Or(ctx_, e[s], And(ctx_, i->second, l->second));
+            }
+          }
+
+          // o[s] = e[s] | o[s'], from the largest sum downwards
+          cardinality::unary::Output<Context> above;
+          for (typename Sums::reverse_iterator s = e.rbegin(); s != e.rend(); ++s) {
+            s->second = Or(ctx_, s->second, above);
+            above = s->second;
+          }
+          return e;
+        }
+
+        Context &ctx_;
+        uint64_t cap_;
+        Sums root_;
+      };
+    }  // namespace gte
+  }    // namespace pseudo_boolean
+}  // namespace metaSMT
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <metaSMT/tags/Cardinality.hpp>
+
+#include <cassert>
+#include <exception>
+#include <limits>
+#include <vector>
+
+#include "../../API/Cardinality.hpp"
+#include "../../Features.hpp"
+#include "object.hpp"
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+    namespace native {
+
+      /// whether the weights and the bound fit into pseudo_boolean_cmd
+      template <typename Tag, typename Boolean>
+      bool representable(PseudoBoolean<Tag, Boolean> const &c) {
+        int64_t const lo = std::numeric_limits<int>::min() + 1;
+        int64_t const hi = std::numeric_limits<int>::max() - 1;
+        for (int64_t w : c.weights) {
+          if (w < lo || w > hi) return false;
+        }
+        return c.bound >= lo && c.bound <= hi;
+      }
+
+      /**
+       * Forwards the constraint to the context, see API/Cardinality.hpp.
+       * Only available for contexts supporting features::cardinality_api.
+       */
+      template <typename Context, typename Tag, typename Boolean>
+      typename Context::result_type pseudo_boolean(Context &ctx, PseudoBoolean<Tag, Boolean> const &c) {
+        if constexpr (features::supports<Context, features::cardinality_api>::value) {
+          assert(c.ps.size() == c.weights.size() && "Pseudo-Boolean constraint requires one weight per input variable");
+          if (!representable(c)) {
+            assert(false && "Pseudo-Boolean coefficient exceeds int");
+            throw std::exception();
+          }
+          std::vector<typename Context::result_type> ps;
+          ps.reserve(c.ps.size());
+          for (Boolean const &p : c.ps) ps.push_back(ctx(p));
+          return ctx.command(pseudo_boolean_cmd(), Tag(), ps, c.weights, c.bound);
+        } else {
+          assert(false && "Context does not support native pseudo-Boolean constraints");
+          throw std::exception();
+        }
+      }
+    }  // namespace native
+  }    // namespace pseudo_boolean
+}  // namespace metaSMT
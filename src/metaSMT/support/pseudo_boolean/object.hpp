@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace metaSMT {
+  namespace pseudo_boolean {
+
+    /**
+     * A pseudo-Boolean constraint
+     *
+     *    weights[0] * ps[0] + ... + weights[n-1] * ps[n-1] <=> bound
+     *
+     * with an operator Tag from logic::cardinality::tag.
+     */
+    template <typename Tag, typename Boolean>
+    struct PseudoBoolean {
+      PseudoBoolean(std::vector<Boolean> const &ps, std::vector<int64_t> const &weights, int64_t const bound,
+                    std::string const encoding = "")
+          : ps(ps), weights(weights), bound(bound), encoding(encoding) {}
+
+      std::vector<Boolean> const &ps;
+      std::vector<int64_t> const &weights;
+      int64_t const bound;
+      std::string const encoding;
+    };  // PseudoBoolean
+
+    template <typename Tag, typename Boolean>
+    PseudoBoolean<Tag, Boolean> pseudo_boolean(Tag const &, std::vector<Boolean> const &ps,
+                                               std::vector<int64_t> const &weights, int64_t const bound,
+                                               std::string const encoding = "") {
+      return PseudoBoolean<Tag, Boolean>(ps, weights, bound, encoding);
+    }
+
+  }  // namespace pseudo_boolean
+}  // namespace metaSMT
@@ -19,6 +19,7 @@ namespace metaSMT {
           return out;
         }
         bool operator<(lit_tag const& other) const { return id < other.id; }
+        bool operator==(lit_tag const& other) const { return id == other.id; }
         lit_tag operator-() const {
           lit_tag l = {-id};
           return l;
@@ -45,7 +46,7 @@ namespace metaSMT {
       };
 
       // tag variant SAT
-      Using SAT_Tag = std::variant<lit_tag, c_tag>;
+      using SAT_Tag = std::variant<lit_tag, c_tag>;
     }  // namespace tag
   }    // namespace SAT
 }  // namespace metaSMT
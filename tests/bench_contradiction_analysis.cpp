@@ -0,0 +1,135 @@
+/**
+ * Compares all_mus() (MUS enumeration with marco) against the cardinality
+ * based contradiction_analysis(), which stays the default until marco wins.
+ *
+ *   bench_contradiction_analysis [constraints] [instances] [variables]
+ *
+ * Every instance is a random set of bounds and differences over some
+ * 4-bit variables. With few variables nearly every pair of constraints
+ * conflicts, more variables give the sparse conflicts of large instances.
+ * Both routines run on fresh Z3 contexts. The MUSes are checked for
+ * unsatisfiability and minimality, every conflict of
+ * contradiction_analysis() must be unsatisfiable and contain one of the
+ * MUSes. The default is 12 constraints, 10 instances and 3 variables.
+ */
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#include <metaSMT/support/contradiction_analysis.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef DirectSolver_Context<solver::Z3_Backend> Context;
+  typedef std::vector<std::vector<unsigned> > Conflicts;
+
+  unsigned num_vars = 3;
+
+  /// the constraints of instance seed, the same for every context
+  std::vector<Context::result_type> constraints(Context &ctx, unsigned size, unsigned seed) {
+    std::vector<Context::result_type> vars;
+    for (unsigned i = 0; i < num_vars; ++i) {
+      vars.push_back(ctx(logic::QF_BV::new_bitvector(4)));
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<Context::result_type> ret;
+    for (unsigned i = 0; i < size; ++i) {
+      Context::result_type const x = vars[rng() % num_vars];
+      Context::result_type const y = vars[rng() % num_vars];
+      Context::result_type const c = ctx(bvtags::bvuint_tag(), uint64_t(rng() % 16), 4u);
+      switch (rng() % 4) {
+        case 0:
+          ret.push_back(ctx(bvtags::bvult_tag(), x, c));
+          break;
+        case 1:
+          ret.push_back(ctx(bvtags::bvugt_tag(), x, c));
+          break;
+        case 2:
+          ret.push_back(ctx(predtags::equal_tag(), x, ctx(bvtags::bvadd_tag(), y, c)));
+          break;
+        default:
+          ret.push_back(ctx(bvtags::bvult_tag(), x, y));
+          break;
+      }
+    }
+    return ret;
+  }
+
+  template <typename F>
+  Conflicts timed(char const *name, unsigned size, unsigned seed, double &total, F f) {
+    Context ctx;
+    std::vector<Context::result_type> const cs = constraints(ctx, size, seed);
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    Conflicts ret = f(ctx, cs);
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    total += elapsed.count();
+    std::cout << "  " << name << ": " << ret.size() << " conflicts in " << elapsed.count() << " s" << std::endl;
+    return ret;
+  }
+
+  bool contains(std::vector<unsigned> const &conflict, std::vector<unsigned> const &mus) {
+    return std::all_of(mus.begin(), mus.end(), [&conflict](unsigned i) {
+      return std::find(conflict.begin(), conflict.end(), i) != conflict.end();
+    });
+  }
+
+  bool check(unsigned size, unsigned seed, Conflicts const &muses, Conflicts const &conflicts) {
+    Context ctx;
+    Soft_Constraints<Context> sc(ctx, constraints(ctx, size, seed));
+    bool ok = true;
+
+    for (std::vector<unsigned> const &mus : muses) {
+      ok &= !sc.satisfiable(mus);
+      for (unsigned i = 0; i < mus.size(); ++i) {
+        std::vector<unsigned> smaller = mus;
+        smaller.erase(smaller.begin() + i);
+        ok &= sc.satisfiable(smaller);
+      }
+    }
+    for (std::vector<unsigned> const &conflict : conflicts) {
+      ok &= !sc.satisfiable(conflict);
+      ok &= std::any_of(muses.begin(), muses.end(),
+                        [&conflict](std::vector<unsigned> const &mus) { return contains(conflict, mus); });
+    }
+    ok &= muses.empty() == conflicts.empty();
+    return ok;
+  }
+}  // namespace
+
+int main(int argc, char **argv) {
+  unsigned const size = argc > 1 ? std::atoi(argv[1]) : 12;
+  unsigned const instances = argc > 2 ? std::atoi(argv[2]) : 10;
+  num_vars = argc > 3 ? std::atoi(argv[3]) : 3;
+
+  double marco_time = 0.0;
+  double cardinality_time = 0.0;
+  unsigned failures = 0;
+  for (unsigned seed = 0; seed < instances; ++seed) {
+    std::cout << "instance " << seed << std::endl;
+    Conflicts const muses = timed("marco", size, seed, marco_time, [](Context &ctx, auto const &cs) {
+      Soft_Constraints<Context> sc(ctx, cs);
+      return all_mus(sc);
+    });
+    Conflicts const conflicts = timed("cardinality", size, seed, cardinality_time, [](Context &ctx, auto const &cs) {
+      return contradiction_analysis(ctx, cs);
+    });
+    if (!check(size, seed, muses, conflicts)) {
+      std::cout << "  FAILED" << std::endl;
+      ++failures;
+    }
+  }
+
+  std::cout << instances << " instances of " << size << " constraints over " << num_vars << " variables: marco "
+            << marco_time << " s, cardinality " << cardinality_time << " s, " << failures << " failures" << std::endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
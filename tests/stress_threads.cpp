@@ -0,0 +1,109 @@
+/**
+ * Stress benchmark for independent contexts on concurrent threads.
+ *
+ *   stress_threads [threads] [rounds]
+ *
+ * Every thread creates a fresh context per round, factors a product of
+ * two primes and checks the model and the unsatisfiability of the other
+ * factorisations. Backends with process-global state corrupt each other's
+ * results or crash. The default is one thread per core and 20 rounds.
+ */
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/SAT_Clause.hpp>
+#ifdef metaSMT_HAVE_MiniSat
+#include <metaSMT/backend/MiniSAT.hpp>
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+#include <metaSMT/backend/PicoSAT.hpp>
+#endif
+#ifdef metaSMT_HAVE_Z3
+#include <metaSMT/backend/Z3_Backend.hpp>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  unsigned const primes[] = {131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181,
+                             191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241};
+  unsigned const num_primes = sizeof(primes) / sizeof(primes[0]);
+
+  /// factors p * q with 8-bit factors x <= y, returns false on a wrong answer
+  template <typename Context>
+  bool factor(unsigned p, unsigned q) {
+    Context ctx;
+    typename Context::result_type x = ctx(logic::QF_BV::new_bitvector(16));
+    typename Context::result_type y = ctx(logic::QF_BV::new_bitvector(16));
+    typename Context::result_type const one = ctx(bvtags::bvuint_tag(), uint64_t(1), 16u);
+    typename Context::result_type const bound = ctx(bvtags::bvuint_tag(), uint64_t(256), 16u);
+    typename Context::result_type const product = ctx(bvtags::bvuint_tag(), uint64_t(p * q), 16u);
+
+    assertion(ctx, ctx(predtags::equal_tag(), ctx(bvtags::bvmul_tag(), x, y), product));
+    assertion(ctx, ctx(bvtags::bvult_tag(), one, x));
+    assertion(ctx, ctx(bvtags::bvule_tag(), x, y));
+    assertion(ctx, ctx(bvtags::bvult_tag(), y, bound));
+
+    if (!solve(ctx)) return false;
+    unsigned const vx = read_value(ctx, x);
+    unsigned const vy = read_value(ctx, y);
+    if (vx != p || vy != q) return false;
+
+    // the factorisation is unique
+    assumption(ctx, ctx(predtags::nequal_tag(), x, ctx(bvtags::bvuint_tag(), uint64_t(p), 16u)));
+    return !solve(ctx);
+  }
+
+  template <typename Context>
+  bool stress(char const *name, unsigned threads, unsigned rounds) {
+    std::atomic<unsigned> failures(0);
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([t, rounds, &failures] {
+        for (unsigned r = 0; r < rounds; ++r) {
+          unsigned p = primes[(t + r) % num_primes];
+          unsigned q = primes[(3 * t + 7 * r + 1) % num_primes];
+          if (p > q) std::swap(p, q);
+          if (!factor<Context>(p, q)) ++failures;
+        }
+      });
+    }
+    for (std::thread &w : workers) {
+      w.join();
+    }
+
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << threads << " threads x " << rounds << " rounds in " << elapsed.count() << " s, "
+              << failures << " failures" << std::endl;
+    return failures == 0;
+  }
+}  // namespace
+
+int main(int argc, char **argv) {
+  unsigned threads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+  unsigned const rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+  if (threads == 0) threads = 2;
+
+  bool ok = true;
+#ifdef metaSMT_HAVE_PicoSAT
+  ok &= stress<DirectSolver_Context<BitBlast<SAT_Clause<solver::PicoSAT> > > >("PicoSAT", threads, rounds);
+#endif
+#ifdef metaSMT_HAVE_MiniSat
+  ok &= stress<DirectSolver_Context<BitBlast<SAT_Clause<solver::MiniSAT> > > >("MiniSAT", threads, rounds);
+#endif
+#ifdef metaSMT_HAVE_Z3
+  ok &= stress<DirectSolver_Context<solver::Z3_Backend> >("Z3", threads, rounds);
+#endif
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
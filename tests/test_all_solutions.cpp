@@ -0,0 +1,223 @@
+#define BOOST_TEST_MODULE test_all_solutions
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/Portfolio_Context.hpp>
+#include <metaSMT/backend/SAT_Clause.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#include <metaSMT/support/all_solutions.hpp>
+#ifdef metaSMT_HAVE_MiniSat
+#include <metaSMT/backend/MiniSAT.hpp>
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+#include <metaSMT/backend/PicoSAT.hpp>
+#endif
+
+#include <boost/mpl/list.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  /**
+   * A clause solver for SAT_Clause on top of Z3, so SAT_Clause is tested
+   * without MiniSat or PicoSAT. With Lift it keeps its clauses and supports
+   * lift_cmd like MiniSat. Counts the calls of solve().
+   */
+  template <bool Lift>
+  class Z3_Clauses {
+   public:
+    typedef SAT::tag::lit_tag result_type;
+
+    Z3_Clauses() : solver_(ctx_) {}
+
+    void clause(std::vector<result_type> const &c) {
+      if (Lift) clauses_.push_back(c);
+      z3::expr_vector es(ctx_);
+      for (result_type const &lit : c) {
+        es.push_back(expr(lit));
+      }
+      solver_.add(z3::mk_or(es));
+    }
+
+    void assertion(result_type lit) { clause(std::vector<result_type>(1, lit)); }
+
+    void assumption(result_type lit) { assumptions_.push_back(lit); }
+
+    bool solve() {
+      ++solves;
+      z3::expr_vector as(ctx_);
+      for (result_type const &lit : assumptions_) {
+        as.push_back(expr(lit));
+      }
+      assumptions_.clear();
+      model_.clear();
+      if (solver_.check(as) != z3::sat) return false;
+      z3::model const m = solver_.get_model();
+      for (std::size_t v = 0; v < vars_.size(); ++v) {
+        model_.push_back(m.eval(vars_[v], true).is_true());
+      }
+      return true;
+    }
+
+    result_wrapper read_value(result_type lit) { return result_wrapper(value(lit)); }
+
+    lift_cmd::result_type command(lift_cmd const &, std::vector<result_type> const &candidates) {
+      metaSMT::detail::Lifter lifter(candidates);
+      std::vector<result_type> true_lits;
+      for (std::vector<result_type> const &c : clauses_) {
+        true_lits.clear();
+        for (result_type const &lit : c) {
+          if (value(lit)) true_lits.push_back(lit);
+        }
+        lifter.satisfied_by(true_lits);
+      }
+      return lifter.droppable(candidates);
+    }
+
+    static inline unsigned solves = 0;
+
+   private:
+    z3::expr expr(result_type lit) {
+      while (vars_.size() <= std::size_t(lit.var())) {
+        vars_.push_back(ctx_.bool_const(("v" + std::to_string(vars_.size())).c_str()));
+      }
+      return lit.id < 0 ? !vars_[lit.var()] : vars_[lit.var()];
+    }
+
+    bool value(result_type lit) const {
+      bool const v = std::size_t(lit.var()) < model_.size() && model_[lit.var()];
+      return lit.id < 0 ? !v : v;
+    }
+
+    z3::context ctx_;
+    z3::solver solver_;
+    std::vector<z3::expr> vars_;
+    std::vector<std::vector<result_type> > clauses_;
+    std::vector<result_type> assumptions_;
+    std::vector<bool> model_;
+  };
+
+  typedef DirectSolver_Context<BitBlast<SAT_Clause<Z3_Clauses<true> > > > Lifting_Context;
+}  // namespace
+
+namespace metaSMT {
+  namespace features {
+    template <>
+    struct supports<Z3_Clauses<true>, lift_cmd> : std::true_type {};
+  }  // namespace features
+}  // namespace metaSMT
+
+namespace {
+  typedef boost::mpl::list<DirectSolver_Context<solver::Z3_Backend>,
+                           DirectSolver_Context<BitBlast<solver::Z3_Backend> >,
+                           Portfolio_Context<solver::Z3_Backend, BitBlast<solver::Z3_Backend> >,
+                           DirectSolver_Context<BitBlast<SAT_Clause<Z3_Clauses<false> > > >, Lifting_Context
+#ifdef metaSMT_HAVE_MiniSat
+                           ,
+                           DirectSolver_Context<BitBlast<SAT_Clause<solver::MiniSAT> > >
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+                           ,
+                           DirectSolver_Context<BitBlast<SAT_Clause<solver::PicoSAT> > >
+#endif
+                           >
+      Contexts;
+
+  /// two 4-bit variables with a < b, i.e. 120 solutions
+  template <typename Context>
+  struct Fixture {
+    typedef typename Context::result_type result_type;
+
+    Fixture() : a(ctx(logic::QF_BV::new_bitvector(4))), b(ctx(logic::QF_BV::new_bitvector(4))) {
+      assertion(ctx, ctx(bvtags::bvult_tag(), a, b));
+    }
+
+    result_type value(unsigned v) { return ctx(bvtags::bvuint_tag(), uint64_t(v), 4u); }
+
+    /// enumerates the projection onto a and b, the solutions must be distinct and satisfy a < b
+    std::uint64_t enumerate(std::uint64_t limit = std::numeric_limits<std::uint64_t>::max()) {
+      std::set<std::pair<unsigned, unsigned> > seen;
+      std::uint64_t const n = for_each_solution(ctx, {a, b}, [&] {
+        unsigned const va = read_value(ctx, a);
+        unsigned const vb = read_value(ctx, b);
+        BOOST_CHECK_LT(va, vb);
+        BOOST_CHECK(seen.insert(std::make_pair(va, vb)).second);
+        last_a = va;
+      }, limit);
+      BOOST_CHECK_EQUAL(seen.size(), n);
+      return n;
+    }
+
+    Context ctx;
+    result_type const a;
+    result_type const b;
+    unsigned last_a;
+  };
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(all_solutions)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(count, Context, Contexts) {
+  Fixture<Context> f;
+  BOOST_CHECK_EQUAL(f.enumerate(), 120u);
+  // the blocking clauses do not outlive the enumeration
+  BOOST_CHECK_EQUAL(f.enumerate(), 120u);
+  BOOST_CHECK_EQUAL(f.enumerate(7), 7u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(projection, Context, Contexts) {
+  Fixture<Context> f;
+  std::uint64_t const n = for_each_solution(f.ctx, {f.a}, [] {});
+  BOOST_CHECK_EQUAL(n, 15u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(assumptions_restrict_every_solution, Context, Contexts) {
+  Fixture<Context> f;
+  assumption(f.ctx, f.ctx(predtags::equal_tag(), f.a, f.value(3)));
+  assumption(f.ctx, f.ctx(bvtags::bvule_tag(), f.b, f.value(10)));
+  f.last_a = 0;
+  BOOST_CHECK_EQUAL(f.enumerate(), 7u);
+  BOOST_CHECK_EQUAL(f.last_a, 3u);
+
+  // consumed by the enumeration
+  BOOST_CHECK_EQUAL(f.enumerate(), 120u);
+  assumption(f.ctx, f.ctx(predtags::equal_tag(), f.a, f.value(15)));
+  BOOST_CHECK_EQUAL(f.enumerate(), 0u);
+  BOOST_CHECK(solve(f.ctx));
+}
+
+BOOST_AUTO_TEST_CASE(cubes_save_solver_calls) {
+  Fixture<Lifting_Context> f;
+  Lifting_Context::result_type const c = f.ctx(logic::QF_BV::new_bitvector(4));
+
+  // c is unconstrained, one model covers all its values
+  std::set<unsigned> seen;
+  unsigned solves = Z3_Clauses<true>::solves;
+  BOOST_CHECK_EQUAL(for_each_solution(f.ctx, {c}, [&] { seen.insert(static_cast<unsigned>(read_value(f.ctx, c))); }), 16u);
+  BOOST_CHECK_EQUAL(seen.size(), 16u);
+  BOOST_CHECK_EQUAL(Z3_Clauses<true>::solves - solves, 2u);
+
+  std::set<std::vector<unsigned> > all;
+  solves = Z3_Clauses<true>::solves;
+  std::uint64_t const n = for_each_solution(f.ctx, {f.a, f.b, c}, [&] {
+    unsigned const va = read_value(f.ctx, f.a);
+    unsigned const vb = read_value(f.ctx, f.b);
+    BOOST_CHECK_LT(va, vb);
+    all.insert({va, vb, static_cast<unsigned>(read_value(f.ctx, c))});
+  });
+  BOOST_CHECK_EQUAL(n, 120u * 16u);
+  BOOST_CHECK_EQUAL(all.size(), n);
+  BOOST_CHECK_LE(Z3_Clauses<true>::solves - solves, 121u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
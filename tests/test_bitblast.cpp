@@ -0,0 +1,73 @@
+#define BOOST_TEST_MODULE test_bitblast
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+
+#include <string>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef DirectSolver_Context<BitBlast<solver::Z3_Backend> > Context;
+
+  unsigned const width = 4;
+  unsigned const mask = (1u << width) - 1;
+
+  int to_signed(unsigned v) { return v & (1u << (width - 1)) ? static_cast<int>(v) - (1 << width) : v; }
+
+  /// SMT-LIB results, division by zero included
+  unsigned udiv(unsigned a, unsigned b) { return b ? a / b : mask; }
+  unsigned urem(unsigned a, unsigned b) { return b ? a % b : a; }
+  unsigned sdiv(unsigned a, unsigned b) {
+    if (!b) return to_signed(a) < 0 ? 1 : mask;
+    return static_cast<unsigned>(to_signed(a) / to_signed(b)) & mask;
+  }
+  unsigned srem(unsigned a, unsigned b) { return b ? static_cast<unsigned>(to_signed(a) % to_signed(b)) & mask : a; }
+
+  /// all operations of the circuits selected by the options over all pairs of 4-bit values
+  void check_all_pairs(std::string const &multiplier, std::string const &divider) {
+    Options opt;
+    opt.set("multiplier", multiplier);
+    opt.set("divider", divider);
+    Context ctx(opt);
+
+    Context::result_type const x = ctx(logic::QF_BV::new_bitvector(width));
+    Context::result_type const y = ctx(logic::QF_BV::new_bitvector(width));
+    Context::result_type const mul = ctx(bvtags::bvmul_tag(), x, y);
+    Context::result_type const q = ctx(bvtags::bvudiv_tag(), x, y);
+    Context::result_type const r = ctx(bvtags::bvurem_tag(), x, y);
+    Context::result_type const sq = ctx(bvtags::bvsdiv_tag(), x, y);
+    Context::result_type const sr = ctx(bvtags::bvsrem_tag(), x, y);
+
+    for (unsigned a = 0; a <= mask; ++a) {
+      for (unsigned b = 0; b <= mask; ++b) {
+        BOOST_TEST_CONTEXT(multiplier << ", " << divider << ": a = " << a << ", b = " << b) {
+          assumption(ctx, ctx(predtags::equal_tag(), x, ctx(bvtags::bvuint_tag(), uint64_t(a), width)));
+          assumption(ctx, ctx(predtags::equal_tag(), y, ctx(bvtags::bvuint_tag(), uint64_t(b), width)));
+          BOOST_REQUIRE(solve(ctx));
+          BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, mul)), (a * b) & mask);
+          BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, q)), udiv(a, b));
+          BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, r)), urem(a, b));
+          BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, sq)), sdiv(a, b));
+          BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, sr)), srem(a, b));
+        }
+      }
+    }
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(bitblast)
+
+BOOST_AUTO_TEST_CASE(shift_add_shift_subtract) { check_all_pairs("shift_add", "shift_subtract"); }
+
+BOOST_AUTO_TEST_CASE(shift_add_restoring) { check_all_pairs("shift_add", "restoring"); }
+
+BOOST_AUTO_TEST_CASE(wallace_shift_subtract) { check_all_pairs("wallace", "shift_subtract"); }
+
+BOOST_AUTO_TEST_CASE(wallace_restoring) { check_all_pairs("wallace", "restoring"); }
+
+BOOST_AUTO_TEST_SUITE_END()
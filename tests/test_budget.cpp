@@ -0,0 +1,77 @@
+#define BOOST_TEST_MODULE test_budget
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/API/Async.hpp>
+#include <metaSMT/API/Budget.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef DirectSolver_Context<solver::Z3_Backend> Context;
+
+  /// factoring a 62-bit semiprime, far beyond the budgets of these tests
+  void assert_hard(Context &ctx) {
+    Context::result_type const x = ctx(bvtags::zero_extend_tag(), 32, ctx(logic::QF_BV::new_bitvector(32)));
+    Context::result_type const y = ctx(bvtags::zero_extend_tag(), 32, ctx(logic::QF_BV::new_bitvector(32)));
+    Context::result_type const one = ctx(bvtags::bvuint_tag(), uint64_t(1), 64u);
+    Context::result_type const n = ctx(bvtags::bvuint_tag(), uint64_t(2147483647ull * 2147483629ull), 64u);
+    assertion(ctx, ctx(predtags::equal_tag(), ctx(bvtags::bvmul_tag(), x, y), n));
+    assertion(ctx, ctx(bvtags::bvult_tag(), one, x));
+    assertion(ctx, ctx(bvtags::bvult_tag(), one, y));
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(budget_api)
+
+BOOST_AUTO_TEST_CASE(definite_results) {
+  Context ctx;
+  Context::result_type const p = ctx(logic::new_variable());
+  budget b;
+  b.timeout = std::chrono::seconds(10);
+  assertion(ctx, p);
+  BOOST_CHECK(static_cast<bool>(solve_limited(ctx, b)));
+  assumption(ctx, ctx(predtags::not_tag(), p));
+  BOOST_CHECK(static_cast<bool>(!solve_limited(ctx, b)));
+}
+
+BOOST_AUTO_TEST_CASE(timeout_is_indeterminate) {
+  Context ctx;
+  assert_hard(ctx);
+  budget b;
+  b.timeout = std::chrono::milliseconds(100);
+  BOOST_CHECK(indeterminate(solve_limited(ctx, b)));
+
+  // the context stays usable
+  Context::result_type const p = ctx(logic::new_variable());
+  assumption(ctx, ctx(predtags::and_tag(), p, ctx(predtags::not_tag(), p)));
+  BOOST_CHECK(static_cast<bool>(!solve_limited(ctx, b)));
+}
+
+BOOST_AUTO_TEST_CASE(cancel_is_indeterminate) {
+  Context ctx;
+  assert_hard(ctx);
+  solve_future<Context> f = async_solve(ctx);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  f.cancel();
+  BOOST_CHECK(indeterminate(f.get()));
+}
+
+BOOST_AUTO_TEST_CASE(cancel_before_search_is_indeterminate) {
+  // the first interrupts may arrive before the search started
+  for (unsigned i = 0; i < 10; ++i) {
+    Context ctx;
+    assert_hard(ctx);
+    solve_future<Context> f = async_solve(ctx);
+    f.cancel();
+    BOOST_CHECK(indeterminate(f.get()));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
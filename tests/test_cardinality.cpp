@@ -0,0 +1,206 @@
+#define BOOST_TEST_MODULE test_cardinality
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#include <metaSMT/support/at_most_one.hpp>
+#include <metaSMT/support/cardinality.hpp>
+#include <metaSMT/support/pseudo_boolean.hpp>
+
+#include <boost/mpl/list.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace cardtags = logic::cardinality::tag;
+
+namespace {
+  typedef boost::mpl::list<DirectSolver_Context<solver::Z3_Backend>,
+                           DirectSolver_Context<BitBlast<solver::Z3_Backend> > >
+      Contexts;
+
+  /// inputs of up to max_inputs variables are checked under all assignments
+  unsigned const max_inputs = 4;
+
+  bool holds(cardtags::lt_tag const &, int64_t lhs, int64_t k) { return lhs < k; }
+  bool holds(cardtags::le_tag const &, int64_t lhs, int64_t k) { return lhs <= k; }
+  bool holds(cardtags::eq_tag const &, int64_t lhs, int64_t k) { return lhs == k; }
+  bool holds(cardtags::ge_tag const &, int64_t lhs, int64_t k) { return lhs >= k; }
+  bool holds(cardtags::gt_tag const &, int64_t lhs, int64_t k) { return lhs > k; }
+
+  template <typename F>
+  void for_each_tag(F f) {
+    f(cardtags::lt_tag());
+    f(cardtags::le_tag());
+    f(cardtags::eq_tag());
+    f(cardtags::ge_tag());
+    f(cardtags::gt_tag());
+  }
+
+  template <typename Context>
+  struct Inputs {
+    typedef typename Context::result_type result_type;
+
+    explicit Inputs(unsigned n) {
+      for (unsigned i = 0; i < n; ++i) {
+        ps.push_back(ctx(logic::new_variable()));
+      }
+    }
+
+    /**
+     * c must be equivalent to expected(assignment) for every assignment of
+     * the inputs, given as bit mask. Auxiliary variables of an encoding
+     * are free, so both c and its negation are checked.
+     **/
+    template <typename Expected>
+    void check(result_type const &c, Expected expected) {
+      for (unsigned mask = 0; mask < (1u << ps.size()); ++mask) {
+        BOOST_TEST_CONTEXT("assignment " << mask) {
+          bool const e = expected(mask);
+          assume(mask);
+          assumption(ctx, c);
+          BOOST_CHECK_EQUAL(solve(ctx), e);
+          assume(mask);
+          assumption(ctx, ctx(predtags::not_tag(), c));
+          BOOST_CHECK_EQUAL(solve(ctx), !e);
+        }
+      }
+    }
+
+    void assume(unsigned mask) {
+      for (unsigned i = 0; i < ps.size(); ++i) {
+        assumption(ctx, mask & (1u << i) ? ps[i] : ctx(predtags::not_tag(), ps[i]));
+      }
+    }
+
+    Context ctx;
+    std::vector<result_type> ps;
+  };
+
+  unsigned ones(unsigned mask) {
+    unsigned n = 0;
+    for (; mask; mask &= mask - 1) ++n;
+    return n;
+  }
+
+  /// every operator and bound of the cardinality encoding over 1 to max_inputs inputs
+  template <typename Context>
+  void check_cardinality(std::string const &encoding) {
+    for (unsigned n = 1; n <= max_inputs; ++n) {
+      for (unsigned k = 0; k <= n + 1; ++k) {
+        for_each_tag([&](auto tag) {
+          BOOST_TEST_CONTEXT(encoding << ": n = " << n << ", k = " << k) {
+            Inputs<Context> in(n);
+            typename Context::result_type const c = in.ctx(cardinality::cardinality(tag, in.ps, k, encoding));
+            in.check(c, [&](unsigned mask) { return holds(tag, ones(mask), k); });
+          }
+        });
+      }
+    }
+  }
+
+  /// every operator of the pseudo-Boolean encoding with mixed weights, the bounds cover all sums
+  template <typename Context>
+  void check_pseudo_boolean(std::string const &encoding) {
+    std::vector<int64_t> const all_weights = {3, -2, 5, 1};
+    for (unsigned n = 1; n <= max_inputs; ++n) {
+      std::vector<int64_t> const weights(all_weights.begin(), all_weights.begin() + n);
+      for (int64_t k = -3; k <= 10; ++k) {
+        for_each_tag([&](auto tag) {
+          BOOST_TEST_CONTEXT(encoding << ": n = " << n << ", k = " << k) {
+            Inputs<Context> in(n);
+            typename Context::result_type const c =
+                in.ctx(pseudo_boolean::pseudo_boolean(tag, in.ps, weights, k, encoding));
+            in.check(c, [&](unsigned mask) {
+              int64_t sum = 0;
+              for (unsigned i = 0; i < n; ++i) {
+                if (mask & (1u << i)) sum += weights[i];
+              }
+              return holds(tag, sum, k);
+            });
+          }
+        });
+      }
+    }
+  }
+
+  /// at-most-one and exactly-one with the encoding, up to 8 inputs for several groups
+  template <typename Context>
+  void check_at_most_one(std::string const &encoding) {
+    for (unsigned n = 1; n <= 8; ++n) {
+      BOOST_TEST_CONTEXT(encoding << ": n = " << n) {
+        Inputs<Context> in(n);
+        in.check(in.ctx(amo::at_most_one(in.ps, encoding)), [](unsigned mask) { return ones(mask) <= 1; });
+        in.check(in.ctx(amo::exactly_one(in.ps, encoding)), [](unsigned mask) { return ones(mask) == 1; });
+      }
+    }
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(encodings)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(cardinality, Context, Contexts) {
+  char const *const encodings[] = {"bdd", "adder", "totalizer", "modulo_totalizer", "sequential_counter",
+                                   "sorting_network"};
+  for (char const *encoding : encodings) {
+    check_cardinality<Context>(encoding);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(pseudo_boolean, Context, Contexts) {
+  for (char const *encoding : {"bdd", "gte", "binary_merge", "adder"}) {
+    check_pseudo_boolean<Context>(encoding);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(at_most_one, Context, Contexts) {
+  for (char const *encoding : {"pairwise", "ladder", "commander", "product", "bimander"}) {
+    check_at_most_one<Context>(encoding);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(native)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(cardinality, Context, Contexts) { check_cardinality<Context>("native"); }
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(pseudo_boolean, Context, Contexts) { check_pseudo_boolean<Context>("native"); }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(bdd_tableau)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(constraints_share_the_tableau, Context, Contexts) {
+  Inputs<Context> in(4);
+  auto const t = cardinality::bdd::tableau(in.ctx, in.ps);
+  BOOST_CHECK(cardinality::bdd::tableau(in.ctx, in.ps) == t);
+  std::vector<typename Context::result_type> const fewer(in.ps.begin(), in.ps.end() - 1);
+  BOOST_CHECK(cardinality::bdd::tableau(in.ctx, fewer) != t);
+  BOOST_CHECK(cardinality::bdd::tableau(in.ctx, in.ps) == t);
+
+  // the latest capacity tableaux are kept
+  for (unsigned i = 0; i < cardinality::bdd::Tableau_Cache<Context>::capacity; ++i) {
+    cardinality::bdd::tableau(in.ctx, std::vector<typename Context::result_type>(1, in.ctx(logic::new_variable())));
+  }
+  BOOST_CHECK(cardinality::bdd::tableau(in.ctx, in.ps) != t);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(shared_cells_stay_correct, Context, Contexts) {
+  // every operator and bound over the same inputs in one context
+  Inputs<Context> in(max_inputs);
+  for (unsigned k = 0; k <= max_inputs + 1; ++k) {
+    for_each_tag([&](auto tag) {
+      BOOST_TEST_CONTEXT("k = " << k) {
+        typename Context::result_type const c = in.ctx(cardinality::cardinality(tag, in.ps, k, "bdd"));
+        in.check(c, [&](unsigned mask) { return holds(tag, ones(mask), k); });
+      }
+    });
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#define BOOST_TEST_MODULE test_cube_and_conquer
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/CubeAndConquer.hpp>
+#include <metaSMT/backend/SAT_Clause.hpp>
+#ifdef metaSMT_HAVE_MiniSat
+#include <metaSMT/backend/MiniSAT.hpp>
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+#include <metaSMT/backend/PicoSAT.hpp>
+#endif
+
+#include <boost/mpl/list.hpp>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+#if defined(metaSMT_HAVE_MiniSat) && defined(metaSMT_HAVE_PicoSAT)
+  typedef boost::mpl::list<solver::MiniSAT, solver::PicoSAT> SatSolvers;
+#elif defined(metaSMT_HAVE_MiniSat)
+  typedef boost::mpl::list<solver::MiniSAT> SatSolvers;
+#else
+  typedef boost::mpl::list<solver::PicoSAT> SatSolvers;
+#endif
+
+  template <typename SatSolver>
+  struct Fixture {
+    typedef DirectSolver_Context<BitBlast<SAT_Clause<solver::CubeAndConquer<SatSolver> > > > Context;
+
+    /// x * y == 143 with 1 < x <= y, i.e. x == 11 and y == 13
+    Fixture() : x(logic::QF_BV::new_bitvector(8)), y(logic::QF_BV::new_bitvector(8)) {
+      typename Context::result_type const ex = ctx(bvtags::zero_extend_tag(), 8, ctx(x));
+      typename Context::result_type const ey = ctx(bvtags::zero_extend_tag(), 8, ctx(y));
+      assertion(ctx, ctx(bvtags::bvult_tag(), ctx(bvtags::bvuint_tag(), uint64_t(1), 16u), ex));
+      assertion(ctx, ctx(bvtags::bvule_tag(), ex, ey));
+      assertion(ctx, ctx(predtags::equal_tag(), ctx(bvtags::bvmul_tag(), ex, ey),
+                         ctx(bvtags::bvuint_tag(), uint64_t(143), 16u)));
+    }
+
+    void configure(unsigned threads) {
+      cube_config cfg;
+      cfg.threads = threads;
+      ctx.command(set_cube_config_cmd(), cfg);
+    }
+
+    typename Context::result_type x_is(unsigned v) {
+      return ctx(predtags::equal_tag(), ctx(x), ctx(bvtags::bvuint_tag(), uint64_t(v), 8u));
+    }
+
+    Context ctx;
+    logic::QF_BV::tag::var_tag const x;
+    logic::QF_BV::tag::var_tag const y;
+  };
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(cube_and_conquer)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(repeated_solves, SatSolver, SatSolvers) {
+  Fixture<SatSolver> f;
+  // the worker threads are kept between the calls and restarted on a new thread count
+  for (unsigned i = 0; i < 20; ++i) {
+    f.configure(i < 10 ? 2 : 3);
+    BOOST_REQUIRE(solve(f.ctx));
+    unsigned const vx = read_value(f.ctx, f.ctx(f.x));
+    unsigned const vy = read_value(f.ctx, f.ctx(f.y));
+    BOOST_REQUIRE_EQUAL(vx, 11u);
+    BOOST_REQUIRE_EQUAL(vy, 13u);
+
+    assumption(f.ctx, f.x_is(11));
+    BOOST_REQUIRE(solve(f.ctx));
+    assumption(f.ctx, f.x_is(12));
+    BOOST_REQUIRE(!solve(f.ctx));
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(single_thread, SatSolver, SatSolvers) {
+  Fixture<SatSolver> f;
+  f.configure(1);
+  BOOST_REQUIRE(solve(f.ctx));
+  assumption(f.ctx, f.x_is(13));
+  BOOST_REQUIRE(!solve(f.ctx));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,228 @@
+#define BOOST_TEST_MODULE test_cudd
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/API/LiteralWeights.hpp>
+#include <metaSMT/API/ModelCount.hpp>
+#include <metaSMT/API/Options.hpp>
+#include <metaSMT/API/Sample.hpp>
+#include <metaSMT/API/VariableOrder.hpp>
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/CUDD_Distributed.hpp>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef DirectSolver_Context<BitBlast<solver::CUDD_Distributed> > Context;
+
+  Context::result_type value(Context &ctx, uint64_t v, unsigned width) { return ctx(bvtags::bvuint_tag(), v, width); }
+
+  /// x + y == z and x < y over width-bit vectors, 2^(2 width - 1) - 2^(width - 1) solutions
+  std::vector<Context::result_type> sum(Context &ctx, unsigned width) {
+    Context::result_type const x = ctx(logic::QF_BV::new_bitvector(width));
+    Context::result_type const y = ctx(logic::QF_BV::new_bitvector(width));
+    Context::result_type const z = ctx(logic::QF_BV::new_bitvector(width));
+    assertion(ctx, ctx(predtags::equal_tag(), ctx(bvtags::bvadd_tag(), x, y), z));
+    assertion(ctx, ctx(bvtags::bvult_tag(), x, y));
+    return {x, y, z};
+  }
+
+  /**
+   * Six independent components: a_k + b_k == k + 10 and a_k < b_k over
+   * 6-bit vectors. Returns the a_k and b_k alternately.
+   */
+  std::vector<Context::result_type> components(Context &ctx) {
+    std::vector<Context::result_type> vars;
+    for (unsigned k = 0; k < 6; ++k) {
+      Context::result_type const a = ctx(logic::QF_BV::new_bitvector(6));
+      Context::result_type const b = ctx(logic::QF_BV::new_bitvector(6));
+      assertion(ctx, ctx(predtags::equal_tag(), ctx(bvtags::bvadd_tag(), a, b), value(ctx, k + 10, 6)));
+      assertion(ctx, ctx(bvtags::bvult_tag(), a, b));
+      vars.push_back(a);
+      vars.push_back(b);
+    }
+    return vars;
+  }
+
+  void check_components(Context &ctx, std::vector<Context::result_type> const &vars) {
+    for (unsigned k = 0; k < 6; ++k) {
+      unsigned const a = read_value(ctx, vars[2 * k]);
+      unsigned const b = read_value(ctx, vars[2 * k + 1]);
+      BOOST_CHECK_EQUAL((a + b) % 64, k + 10);
+      BOOST_CHECK_LT(a, b);
+    }
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(cudd)
+
+BOOST_AUTO_TEST_CASE(exact_count_beyond_64_bits) {
+  Context ctx;
+  set_option(ctx, "counting", "exact");
+  Context::result_type const x = ctx(logic::QF_BV::new_bitvector(64));
+  Context::result_type const y = ctx(logic::QF_BV::new_bitvector(64));
+  ctx(logic::QF_BV::new_bitvector(16));
+  assertion(ctx, ctx(bvtags::bvult_tag(), x, y));
+
+  // the pairs x < y times the free 16 bits
+  boost::multiprecision::cpp_int const expected = ((boost::multiprecision::cpp_int(1) << 127) -
+                                                   (boost::multiprecision::cpp_int(1) << 63))
+                                                  << 16;
+  solution_count const c = count_solutions(ctx);
+  BOOST_CHECK_EQUAL(c.exact, expected.str());
+  BOOST_CHECK_CLOSE(c.log2, std::log2(expected.convert_to<double>()), 1e-9);
+
+  assertion(ctx, ctx(predtags::equal_tag(), x, y));
+  solution_count const none = count_solutions(ctx);
+  BOOST_CHECK_EQUAL(none.exact, "0");
+  BOOST_CHECK(std::isinf(none.log2) && none.log2 < 0);
+}
+
+BOOST_AUTO_TEST_CASE(log_space_count) {
+  Context ctx;
+  sum(ctx, 24);
+  solution_count const c = count_solutions(ctx);
+  BOOST_CHECK(c.exact.empty());
+  BOOST_CHECK_CLOSE(c.log2, std::log2(std::ldexp(1.0, 47) - std::ldexp(1.0, 23)), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(sample_is_uniform) {
+  // x != 0 and x != 5 leave 6 solutions
+  Context ctx;
+  Context::result_type const x = ctx(logic::QF_BV::new_bitvector(3));
+  assertion(ctx, ctx(predtags::nequal_tag(), x, value(ctx, 0, 3)));
+  assertion(ctx, ctx(predtags::nequal_tag(), x, value(ctx, 5, 3)));
+
+  unsigned const n = 60000;
+  // chi-squared with 5 degrees of freedom, p = 0.001
+  double const critical = 20.52;
+
+  std::map<unsigned, unsigned> values;
+  BOOST_REQUIRE(sample(ctx, n, [&] { ++values[static_cast<unsigned>(read_value(ctx, x))]; }));
+  BOOST_REQUIRE_EQUAL(values.size(), 6u);
+  double chi2 = 0;
+  for (auto const &v : values) {
+    BOOST_CHECK(v.first != 0 && v.first != 5);
+    chi2 += (v.second - n / 6.0) * (v.second - n / 6.0) / (n / 6.0);
+  }
+  BOOST_CHECK_LT(chi2, critical);
+
+  // the rows of the matrix, by the bits of x whatever their columns
+  for (unsigned threads : {1u, 4u}) {
+    sample_matrix m;
+    BOOST_REQUIRE(sample(ctx, n, m, threads));
+    BOOST_REQUIRE_EQUAL(m.rows(), n);
+    BOOST_REQUIRE_EQUAL(m.columns(), 3u);
+    std::map<std::uint64_t, unsigned> rows;
+    for (unsigned r = 0; r < n; ++r) ++rows[m.row(r)[0]];
+    BOOST_REQUIRE_EQUAL(rows.size(), 6u);
+    chi2 = 0;
+    for (auto const &row : rows) chi2 += (row.second - n / 6.0) * (row.second - n / 6.0) / (n / 6.0);
+    BOOST_CHECK_LT(chi2, critical);
+  }
+
+  assertion(ctx, ctx(predtags::equal_tag(), x, value(ctx, 0, 3)));
+  sample_matrix m;
+  BOOST_CHECK(!sample(ctx, 10, m));
+  BOOST_CHECK_EQUAL(m.rows(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(weighted_count_matches_brute_force) {
+  Context ctx;
+  Context::result_type const x = ctx(logic::QF_BV::new_bitvector(5));
+  assertion(ctx, ctx(bvtags::bvugt_tag(), x, value(ctx, 6, 5)));
+  assertion(ctx, ctx(predtags::nequal_tag(), x, value(ctx, 19, 5)));
+  std::vector<double> const w_true = {3, 0.5, 1, 2, 0.25};
+  std::vector<double> const w_false = {1, 2, 4, 1, 1};
+  for (unsigned i = 0; i < 5; ++i) {
+    set_literal_weight(ctx, ctx(bvtags::extract_tag(), i, i, x), w_true[i], w_false[i]);
+  }
+
+  double expected = 0;
+  for (unsigned v = 7; v < 32; ++v) {
+    if (v == 19) continue;
+    double w = 1;
+    for (unsigned i = 0; i < 5; ++i) w *= (v >> i) & 1 ? w_true[i] : w_false[i];
+    expected += w;
+  }
+  BOOST_CHECK_CLOSE(count_solutions(ctx).log2, std::log2(expected), 1e-9);
+
+  // sampled with probabilities proportional to the weights
+  unsigned const n = 100000;
+  std::map<unsigned, unsigned> values;
+  BOOST_REQUIRE(sample(ctx, n, [&] { ++values[static_cast<unsigned>(read_value(ctx, x))]; }));
+  double chi2 = 0;
+  for (unsigned v = 7; v < 32; ++v) {
+    if (v == 19) continue;
+    double w = 1;
+    for (unsigned i = 0; i < 5; ++i) w *= (v >> i) & 1 ? w_true[i] : w_false[i];
+    double const e = n * w / expected;
+    chi2 += (values[v] - e) * (values[v] - e) / e;
+  }
+  BOOST_CHECK_EQUAL(values.size(), 24u);
+  // chi-squared with 23 degrees of freedom, p = 0.001
+  BOOST_CHECK_LT(chi2, 49.73);
+}
+
+BOOST_AUTO_TEST_CASE(partitioned_equals_eager) {
+  Context eager;
+  Context partitioned;
+  set_option(eager, "counting", "exact");
+  set_option(partitioned, "counting", "exact");
+  set_option(partitioned, "cudd.conjunction", "partitioned");
+  std::vector<Context::result_type> const ve = components(eager);
+  std::vector<Context::result_type> const vp = components(partitioned);
+
+  BOOST_REQUIRE(solve(eager));
+  BOOST_REQUIRE(solve(partitioned));
+  check_components(eager, ve);
+  check_components(partitioned, vp);
+  BOOST_CHECK_EQUAL(count_solutions(eager).exact, count_solutions(partitioned).exact);
+
+  // a_0 == b_0 contradicts a_0 < b_0, for the next solve only
+  assumption(eager, eager(predtags::equal_tag(), ve[0], ve[1]));
+  assumption(partitioned, partitioned(predtags::equal_tag(), vp[0], vp[1]));
+  BOOST_CHECK(!solve(eager));
+  BOOST_CHECK(!solve(partitioned));
+  BOOST_REQUIRE(solve(partitioned));
+  check_components(partitioned, vp);
+
+  // switching the mode keeps the assertions
+  set_option(partitioned, "cudd.conjunction", "eager");
+  BOOST_REQUIRE(solve(partitioned));
+  check_components(partitioned, vp);
+  BOOST_CHECK_EQUAL(count_solutions(eager).exact, count_solutions(partitioned).exact);
+}
+
+BOOST_AUTO_TEST_CASE(variable_orders_keep_the_count) {
+  for (std::string const order : {"creation", "interleave", "force"}) {
+    BOOST_TEST_CONTEXT("cudd.order = " << order) {
+      Context ctx;
+      set_option(ctx, "counting", "exact");
+      set_option(ctx, "cudd.order", order);
+      std::vector<Context::result_type> const vars = sum(ctx, 16);
+      BOOST_CHECK_EQUAL(count_solutions(ctx).exact, "2147450880");
+      reorder(ctx);
+      BOOST_CHECK_EQUAL(count_solutions(ctx).exact, "2147450880");
+
+      BOOST_REQUIRE(solve(ctx));
+      unsigned const x = read_value(ctx, vars[0]);
+      unsigned const y = read_value(ctx, vars[1]);
+      unsigned const z = read_value(ctx, vars[2]);
+      BOOST_CHECK_EQUAL((x + y) % 65536, z);
+      BOOST_CHECK_LT(x, y);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+#define BOOST_TEST_MODULE test_optimize
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#include <metaSMT/support/optimize.hpp>
+
+#include <boost/mpl/list.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+// only declared by the backends of this tree
+namespace metaSMT {
+  struct stack_push {
+    typedef void result_type;
+  };
+  struct stack_pop {
+    typedef void result_type;
+  };
+}  // namespace metaSMT
+
+namespace {
+  typedef DirectSolver_Context<solver::Z3_Backend> Context;
+  typedef boost::mpl::list<Context, DirectSolver_Context<BitBlast<solver::Z3_Backend> > > Contexts;
+
+  unsigned const instances = 8;
+
+  /// random bounds over three 8-bit variables, the same for every context
+  template <typename Ctx>
+  struct Instance {
+    typedef typename Ctx::result_type result_type;
+
+    /// with assumed, two bounds are pending assumptions instead of assertions
+    Instance(unsigned seed, bool assumed) : rng(seed) {
+      for (unsigned i = 0; i < 3; ++i) {
+        vars.push_back(ctx(logic::QF_BV::new_bitvector(8)));
+      }
+      assertion(ctx, ctx(bvtags::bvugt_tag(), vars[0], value(rng() % 100)));
+      assertion(ctx, ctx(bvtags::bvult_tag(), vars[0], vars[1]));
+      assertion(ctx, ctx(bvtags::bvult_tag(), vars[1], value(150 + rng() % 100)));
+      assertion(ctx, ctx(bvtags::bvugt_tag(), vars[2], value(rng() % 200)));
+      assertion(ctx, ctx(predtags::nequal_tag(), vars[2], ctx(bvtags::bvadd_tag(), vars[0], value(rng() % 256))));
+      // every fourth instance is unsatisfiable
+      if (seed % 4 == 3) assertion(ctx, ctx(bvtags::bvult_tag(), vars[0], value(0)));
+      // the sum of the variables without overflow
+      objective = ctx(bvtags::zero_extend_tag(), 2, vars[0]);
+      for (unsigned i = 1; i < 3; ++i) {
+        objective = ctx(bvtags::bvadd_tag(), objective, ctx(bvtags::zero_extend_tag(), 2, vars[i]));
+      }
+      for (unsigned i = 0; i < 6; ++i) {
+        result_type const v = vars[rng() % 3];
+        soft.push_back(rng() % 2 ? ctx(predtags::equal_tag(), v, value(rng() % 256))
+                                 : ctx(bvtags::bvult_tag(), v, value(rng() % 128)));
+        weights.push_back(1 + rng() % 5);
+      }
+      if (assumed) {
+        hard.push_back(ctx(bvtags::bvuge_tag(), vars[0], value(100 + 16 * seed)));
+        hard.push_back(ctx(bvtags::bvult_tag(), vars[2], value(230)));
+        for (result_type const &h : hard) assumption(ctx, h);
+      }
+    }
+
+    result_type value(unsigned v) { return ctx(bvtags::bvuint_tag(), uint64_t(v), 8u); }
+
+    std::mt19937 rng;
+    Ctx ctx;
+    std::vector<result_type> vars;
+    result_type objective;
+    std::vector<result_type> soft;
+    std::vector<uint64_t> weights;
+    std::vector<result_type> hard;
+  };
+
+  /// the result of a strategy is the native optimum and the model attains it
+  template <typename Ctx, typename F, typename G>
+  void check_strategy(char const *name, search_strategy strategy, F optimize, G cost) {
+    for (unsigned seed = 0; seed < instances; ++seed) {
+      for (bool assumed : {false, true}) {
+        BOOST_TEST_CONTEXT(name << ": instance " << seed << (assumed ? " with assumptions" : "")) {
+          Instance<Context> native(seed, assumed);
+          std::optional<uint64_t> const expected = optimize(native, search_strategy::native);
+
+          Instance<Ctx> in(seed, assumed);
+          std::optional<uint64_t> const r = optimize(in, strategy);
+          BOOST_REQUIRE_EQUAL(r.has_value(), expected.has_value());
+          if (r) {
+            BOOST_CHECK_EQUAL(*r, *expected);
+            BOOST_CHECK_EQUAL(cost(in), *r);
+            for (auto const &h : in.hard) BOOST_CHECK(static_cast<bool>(read_value(in.ctx, h)));
+          }
+        }
+      }
+    }
+  }
+
+  struct Fixture {
+    Fixture() : x(ctx(logic::QF_BV::new_bitvector(8))) {}
+
+    Context::result_type value(unsigned v) { return ctx(bvtags::bvuint_tag(), uint64_t(v), 8u); }
+
+    Context ctx;
+    Context::result_type const x;
+  };
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(native_optimize, Fixture)
+
+BOOST_AUTO_TEST_CASE(scopes_are_respected) {
+  assertion(ctx, ctx(bvtags::bvuge_tag(), x, value(10)));
+  BOOST_CHECK_EQUAL(*minimize(ctx, x), 10u);
+
+  ctx.command(stack_push(), 1);
+  assertion(ctx, ctx(bvtags::bvuge_tag(), x, value(20)));
+  BOOST_CHECK_EQUAL(*minimize(ctx, x), 20u);
+  assertion(ctx, ctx(bvtags::bvule_tag(), x, value(15)));
+  BOOST_CHECK(!minimize(ctx, x));
+  ctx.command(stack_pop(), 1);
+
+  BOOST_CHECK_EQUAL(*minimize(ctx, x), 10u);
+  BOOST_CHECK_EQUAL(*maximize(ctx, x), 255u);
+}
+
+BOOST_AUTO_TEST_CASE(objectives_and_assumptions_apply_once) {
+  assumption(ctx, ctx(bvtags::bvule_tag(), x, value(5)));
+  BOOST_CHECK_EQUAL(*maximize(ctx, x), 5u);
+  BOOST_CHECK_EQUAL(*maximize(ctx, x), 255u);
+  BOOST_CHECK_EQUAL(*minimize(ctx, x), 0u);
+  BOOST_CHECK(solve(ctx));
+}
+
+BOOST_AUTO_TEST_CASE(maxsat_in_scope) {
+  std::vector<Context::result_type> const soft = {ctx(predtags::equal_tag(), x, value(1)),
+                                                  ctx(predtags::equal_tag(), x, value(2)),
+                                                  ctx(predtags::equal_tag(), x, value(2))};
+  BOOST_CHECK_EQUAL(*maxsat(ctx, soft), 1u);
+  BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, x)), 2u);
+
+  ctx.command(stack_push(), 1);
+  assertion(ctx, ctx(predtags::nequal_tag(), x, value(2)));
+  BOOST_CHECK_EQUAL(*maxsat(ctx, soft), 2u);
+  BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(ctx, x)), 1u);
+  ctx.command(stack_pop(), 1);
+
+  BOOST_CHECK_EQUAL(*maxsat(ctx, soft), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(strategies)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(minimize_and_maximize, Ctx, Contexts) {
+  auto const value = [](auto &in) { return static_cast<uint64_t>(read_value(in.ctx, in.objective)); };
+  for (search_strategy strategy : {search_strategy::native, search_strategy::linear, search_strategy::binary}) {
+    check_strategy<Ctx>("minimize", strategy, [](auto &in, search_strategy s) {
+      return minimize(in.ctx, in.objective, s);
+    }, value);
+    check_strategy<Ctx>("maximize", strategy, [](auto &in, search_strategy s) {
+      return maximize(in.ctx, in.objective, s);
+    }, value);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(maxsat_unit_weights, Ctx, Contexts) {
+  for (search_strategy strategy : {search_strategy::native, search_strategy::linear, search_strategy::binary,
+                                   search_strategy::core_guided}) {
+    check_strategy<Ctx>("maxsat", strategy, [](auto &in, search_strategy s) {
+      return maxsat(in.ctx, in.soft, s);
+    }, [](auto &in) {
+      return detail::violated_weight(in.ctx, in.soft, std::vector<uint64_t>(in.soft.size(), 1));
+    });
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(maxsat_weighted, Ctx, Contexts) {
+  for (search_strategy strategy : {search_strategy::native, search_strategy::linear, search_strategy::binary,
+                                   search_strategy::core_guided}) {
+    check_strategy<Ctx>("weighted maxsat", strategy, [](auto &in, search_strategy s) {
+      return maxsat(in.ctx, in.soft, in.weights, s);
+    }, [](auto &in) {
+      return detail::violated_weight(in.ctx, in.soft, in.weights);
+    });
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
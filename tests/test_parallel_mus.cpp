@@ -0,0 +1,124 @@
+#define BOOST_TEST_MODULE test_parallel_mus
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#include <metaSMT/support/mus.hpp>
+#include <metaSMT/support/parallel_mus.hpp>
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef DirectSolver_Context<solver::Z3_Backend> Context;
+  typedef std::set<std::vector<unsigned> > MUSes;
+
+  /// random bounds and differences over three 4-bit variables, the same for every context
+  std::vector<Context::result_type> random_constraints(Context &ctx, unsigned size, unsigned seed) {
+    std::vector<Context::result_type> vars;
+    for (unsigned i = 0; i < 3; ++i) {
+      vars.push_back(ctx(logic::QF_BV::new_bitvector(4)));
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<Context::result_type> ret;
+    for (unsigned i = 0; i < size; ++i) {
+      Context::result_type const x = vars[rng() % vars.size()];
+      Context::result_type const y = vars[rng() % vars.size()];
+      Context::result_type const c = ctx(bvtags::bvuint_tag(), uint64_t(rng() % 16), 4u);
+      switch (rng() % 4) {
+        case 0:
+          ret.push_back(ctx(bvtags::bvult_tag(), x, c));
+          break;
+        case 1:
+          ret.push_back(ctx(bvtags::bvugt_tag(), x, c));
+          break;
+        case 2:
+          ret.push_back(ctx(predtags::equal_tag(), x, ctx(bvtags::bvadd_tag(), y, c)));
+          break;
+        default:
+          ret.push_back(ctx(bvtags::bvult_tag(), x, y));
+          break;
+      }
+    }
+    return ret;
+  }
+
+  template <typename Factory>
+  MUSes sequential(Factory factory) {
+    Context ctx;
+    Soft_Constraints<Context> sc(ctx, factory(ctx));
+    std::vector<std::vector<unsigned> > const muses = all_mus(sc);
+    MUSes const ret(muses.begin(), muses.end());
+    BOOST_REQUIRE_EQUAL(ret.size(), muses.size());
+    return ret;
+  }
+
+  /// parallel_all_mus must find the MUSes of all_mus, each once, for any number of threads
+  template <typename Factory>
+  void check_threads(Factory factory, unsigned min_muses) {
+    MUSes const expected = sequential(factory);
+    BOOST_REQUIRE_GE(expected.size(), min_muses);
+
+    for (unsigned threads : {1u, 2u, 3u, 4u, 5u, 8u}) {
+      BOOST_TEST_CONTEXT("threads " << threads) {
+        std::vector<std::vector<unsigned> > const muses = parallel_all_mus<Context>(factory, threads);
+        BOOST_CHECK_EQUAL(muses.size(), expected.size());
+        BOOST_CHECK(MUSes(muses.begin(), muses.end()) == expected);
+      }
+    }
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(parallel_mus)
+
+BOOST_AUTO_TEST_CASE(overlapping_conflicts) {
+  // MUSes {0, 1}, {0, 2}, {2, 3, 4} and {1, 3, 4, 5}, y == x + 2 wraps around
+  check_threads(
+      [](Context &ctx) {
+        Context::result_type const x = ctx(logic::QF_BV::new_bitvector(4));
+        Context::result_type const y = ctx(logic::QF_BV::new_bitvector(4));
+        auto value = [&ctx](unsigned v) { return ctx(bvtags::bvuint_tag(), uint64_t(v), 4u); };
+        return std::vector<Context::result_type>{
+            ctx(bvtags::bvult_tag(), x, value(3)),
+            ctx(bvtags::bvugt_tag(), x, value(5)),
+            ctx(predtags::equal_tag(), x, value(7)),
+            ctx(predtags::equal_tag(), y, ctx(bvtags::bvadd_tag(), x, value(2))),
+            ctx(bvtags::bvult_tag(), y, value(4)),
+            ctx(bvtags::bvugt_tag(), y, value(1)),
+        };
+      },
+      4);
+}
+
+BOOST_AUTO_TEST_CASE(random_instances) {
+  for (unsigned seed = 0; seed < 4; ++seed) {
+    BOOST_TEST_CONTEXT("seed " << seed) {
+      check_threads([seed](Context &ctx) { return random_constraints(ctx, 10, seed); }, 2);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(more_partition_bits_than_constraints) {
+  // 8 threads partition on 3 constraints, there are only 2
+  check_threads(
+      [](Context &ctx) {
+        Context::result_type const p = ctx(logic::new_variable());
+        return std::vector<Context::result_type>{p, ctx(predtags::not_tag(), p)};
+      },
+      1);
+}
+
+BOOST_AUTO_TEST_CASE(satisfiable) {
+  std::vector<std::vector<unsigned> > const muses = parallel_all_mus<Context>(
+      [](Context &ctx) { return std::vector<Context::result_type>{ctx(logic::new_variable())}; }, 4);
+  BOOST_CHECK(muses.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
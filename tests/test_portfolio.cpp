@@ -0,0 +1,92 @@
+#define BOOST_TEST_MODULE test_portfolio
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/Portfolio_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#if defined(metaSMT_HAVE_MiniSat) || defined(metaSMT_HAVE_PicoSAT)
+#include <metaSMT/backend/SAT_Clause.hpp>
+#endif
+#ifdef metaSMT_HAVE_MiniSat
+#include <metaSMT/backend/MiniSAT.hpp>
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+#include <metaSMT/backend/PicoSAT.hpp>
+#endif
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+typedef Portfolio_Context<solver::Z3_Backend, BitBlast<solver::Z3_Backend> > Portfolio;
+
+namespace {
+  /// the losers are interrupted while they pass their assumptions or search
+  template <typename Context>
+  void check_interrupted_assumptions() {
+    Context ctx;
+    logic::QF_BV::tag::var_tag const x = logic::QF_BV::new_bitvector(8);
+    logic::QF_BV::tag::var_tag const y = logic::QF_BV::new_bitvector(8);
+    assertion(ctx, ctx(bvtags::bvult_tag(), x, y));
+
+    for (unsigned i = 0; i < 200; ++i) {
+      unsigned const vy = i % 256;
+      assumption(ctx, ctx(predtags::equal_tag(), y, ctx(bvtags::bvuint_tag(), uint64_t(vy), 8u)));
+      assumption(ctx, ctx(bvtags::bvuge_tag(), x, ctx(bvtags::bvuint_tag(), uint64_t(vy / 2), 8u)));
+      bool const sat = solve(ctx);
+      BOOST_TEST_INFO("i = " << i << " winner " << ctx.winner());
+      BOOST_REQUIRE_EQUAL(sat, vy != 0);
+      if (sat) {
+        unsigned const vx = read_value(ctx, ctx(x));
+        BOOST_REQUIRE_LT(vx, vy);
+        BOOST_REQUIRE_GE(vx, vy / 2);
+      }
+    }
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(portfolio)
+
+BOOST_AUTO_TEST_CASE(repeated_easy_solves) {
+  Portfolio ctx;
+  logic::QF_BV::tag::var_tag const x = logic::QF_BV::new_bitvector(8);
+  logic::QF_BV::tag::var_tag const y = logic::QF_BV::new_bitvector(8);
+  assertion(ctx, ctx(bvtags::bvult_tag(), x, y));
+
+  // the losers are interrupted before they searched, solve must not block
+  for (unsigned i = 0; i < 200; ++i) {
+    Portfolio::result_type const v = ctx(bvtags::bvuint_tag(), uint64_t(i % 256), 8u);
+    assumption(ctx, ctx(predtags::equal_tag(), y, v));
+    bool const sat = solve(ctx);
+    BOOST_TEST_INFO("i = " << i << " winner " << ctx.winner());
+    BOOST_REQUIRE_EQUAL(sat, i % 256 != 0);
+    BOOST_REQUIRE_LT(ctx.winner(), Portfolio::size);
+    if (sat) {
+      unsigned const vx = read_value(ctx, ctx(x));
+      BOOST_REQUIRE_LT(vx, i % 256);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(destroy_after_solve) {
+  for (unsigned i = 0; i < 50; ++i) {
+    Portfolio ctx;
+    Portfolio::result_type const p = ctx(logic::new_variable());
+    assertion(ctx, p);
+    BOOST_REQUIRE(solve(ctx));
+  }
+}
+
+#ifdef metaSMT_HAVE_MiniSat
+BOOST_AUTO_TEST_CASE(interrupted_minisat_assumptions) {
+  check_interrupted_assumptions<Portfolio_Context<solver::Z3_Backend, BitBlast<SAT_Clause<solver::MiniSAT> > > >();
+}
+#endif
+
+#ifdef metaSMT_HAVE_PicoSAT
+BOOST_AUTO_TEST_CASE(interrupted_picosat_assumptions) {
+  check_interrupted_assumptions<Portfolio_Context<solver::Z3_Backend, BitBlast<SAT_Clause<solver::PicoSAT> > > >();
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+#define BOOST_TEST_MODULE test_read_values
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/API/ReadValues.hpp>
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+
+#include <boost/mpl/list.hpp>
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef boost::mpl::list<DirectSolver_Context<solver::Z3_Backend>, DirectSolver_Context<BitBlast<solver::Z3_Backend> > >
+      Contexts;
+
+  template <typename Context>
+  typename Context::result_type value(Context &ctx, unsigned v, unsigned width) {
+    return ctx(bvtags::bvuint_tag(), uint64_t(v), width);
+  }
+
+  /// read_values must agree with read_value element by element
+  template <typename Context>
+  void check_values(Context &ctx, std::vector<typename Context::result_type> const &vars) {
+    std::vector<result_wrapper> const values = read_values(ctx, vars);
+    BOOST_REQUIRE_EQUAL(values.size(), vars.size());
+    for (unsigned i = 0; i < vars.size(); ++i) {
+      BOOST_CHECK_EQUAL(std::string(values[i]), std::string(read_value(ctx, vars[i])));
+    }
+  }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(read_values_api)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(equal_to_read_value, Context, Contexts) {
+  static_assert(features::supports<Context, read_values_cmd>::value, "no read_values_cmd");
+  Context ctx;
+  typename Context::result_type const a = ctx(logic::QF_BV::new_bitvector(8));
+  typename Context::result_type const b = ctx(logic::QF_BV::new_bitvector(16));
+  typename Context::result_type const c = ctx(logic::QF_BV::new_bitvector(16));
+  typename Context::result_type const p = ctx(logic::new_variable());
+  typename Context::result_type const q = ctx(logic::new_variable());
+  assertion(ctx, ctx(predtags::equal_tag(), ctx(bvtags::bvadd_tag(), ctx(bvtags::zero_extend_tag(), 8, a), b), c));
+  assertion(ctx, ctx(predtags::equal_tag(), p, ctx(bvtags::bvult_tag(), b, c)));
+  assertion(ctx, ctx(bvtags::bvugt_tag(), a, value(ctx, 100, 8)));
+  BOOST_REQUIRE(solve(ctx));
+
+  // q is unconstrained, the expressions are no variables
+  check_values(ctx, {a, b, c, p, q, ctx(bvtags::bvadd_tag(), b, c), ctx(predtags::not_tag(), p)});
+  check_values(ctx, {});
+  check_values(ctx, {c, c, a});
+
+  unsigned const va = read_value(ctx, a);
+  unsigned const vb = read_value(ctx, b);
+  unsigned const vc = read_value(ctx, c);
+  BOOST_CHECK_GT(va, 100u);
+  BOOST_CHECK_EQUAL((va + vb) % 65536, vc);
+  BOOST_CHECK_EQUAL(bool(read_value(ctx, p)), vb < vc);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(fresh_values_after_solve, Context, Contexts) {
+  Context ctx;
+  typename Context::result_type const x = ctx(logic::QF_BV::new_bitvector(8));
+  typename Context::result_type const y = ctx(logic::QF_BV::new_bitvector(8));
+  assertion(ctx, ctx(bvtags::bvult_tag(), x, value(ctx, 8, 8)));
+
+  // blocks each model, a cached model would repeat
+  std::set<unsigned> seen;
+  for (unsigned i = 0; i < 8; ++i) {
+    BOOST_REQUIRE(solve(ctx));
+    std::vector<result_wrapper> const values = read_values(ctx, {x, y});
+    unsigned const vx = values[0];
+    BOOST_CHECK_EQUAL(vx, static_cast<unsigned>(read_value(ctx, x)));
+    BOOST_CHECK(seen.insert(vx).second);
+    assertion(ctx, ctx(predtags::nequal_tag(), x, value(ctx, vx, 8)));
+  }
+  BOOST_CHECK(!solve(ctx));
+  BOOST_CHECK_EQUAL(seen.size(), 8u);
+
+  // assumptions change the model of the next solve only
+  Context other;
+  typename Context::result_type const z = other(logic::QF_BV::new_bitvector(8));
+  for (unsigned v : {3u, 200u, 3u}) {
+    assumption(other, other(predtags::equal_tag(), z, value(other, v, 8)));
+    BOOST_REQUIRE(solve(other));
+    unsigned const vz = read_values(other, {z}).front();
+    BOOST_CHECK_EQUAL(vz, v);
+    BOOST_CHECK_EQUAL(static_cast<unsigned>(read_value(other, z)), v);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
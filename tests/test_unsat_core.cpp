@@ -0,0 +1,130 @@
+#define BOOST_TEST_MODULE test_unsat_core
+#include <boost/test/included/unit_test.hpp>
+
+#include <metaSMT/BitBlast.hpp>
+#include <metaSMT/DirectSolver_Context.hpp>
+#include <metaSMT/Portfolio_Context.hpp>
+#include <metaSMT/API/UnsatCore.hpp>
+#include <metaSMT/backend/Z3_Backend.hpp>
+#if defined(metaSMT_HAVE_MiniSat) || defined(metaSMT_HAVE_PicoSAT)
+#include <metaSMT/backend/SAT_Clause.hpp>
+#endif
+#ifdef metaSMT_HAVE_MiniSat
+#include <metaSMT/backend/MiniSAT.hpp>
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+#include <metaSMT/backend/PicoSAT.hpp>
+#endif
+
+#include <boost/mpl/list.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using namespace metaSMT;
+namespace predtags = logic::tag;
+namespace bvtags = logic::QF_BV::tag;
+
+namespace {
+  typedef boost::mpl::list<DirectSolver_Context<solver::Z3_Backend>,
+                           DirectSolver_Context<BitBlast<solver::Z3_Backend> >,
+                           Portfolio_Context<solver::Z3_Backend, BitBlast<solver::Z3_Backend> >
+#ifdef metaSMT_HAVE_MiniSat
+                           ,
+                           DirectSolver_Context<BitBlast<SAT_Clause<solver::MiniSAT> > >
+#endif
+#ifdef metaSMT_HAVE_PicoSAT
+                           ,
+                           DirectSolver_Context<BitBlast<SAT_Clause<solver::PicoSAT> > >
+#endif
+                           >
+      Contexts;
+
+  /// assumptions over two 4-bit variables, x < 3 conflicts with x > 5 and x == 7
+  template <typename Context>
+  struct Fixture {
+    typedef typename Context::result_type result_type;
+
+    Fixture() {
+      static_assert(features::supports<Context, get_unsat_core_cmd>::value, "no unsat cores");
+      result_type const x = ctx(logic::QF_BV::new_bitvector(4));
+      result_type const y = ctx(logic::QF_BV::new_bitvector(4));
+      assumptions = {ctx(bvtags::bvult_tag(), x, value(3)), ctx(predtags::equal_tag(), y, value(5)),
+                     ctx(bvtags::bvugt_tag(), x, value(5)), ctx(bvtags::bvult_tag(), y, value(8)),
+                     ctx(predtags::equal_tag(), x, value(7))};
+    }
+
+    result_type value(unsigned v) { return ctx(bvtags::bvuint_tag(), uint64_t(v), 4u); }
+
+    /// solves under the assumptions with the given indices
+    bool solve_with(std::vector<unsigned> const &indices) {
+      for (unsigned i : indices) metaSMT::assumption(ctx, assumptions[i]);
+      return metaSMT::solve(ctx);
+    }
+
+    /**
+     * solves under the assumptions order, which must be unsatisfiable. The
+     * core must be sorted positions in order and unsatisfiable by itself.
+     **/
+    void check_core(std::vector<unsigned> const &order) {
+      BOOST_REQUIRE(!solve_with(order));
+      std::vector<unsigned> const core = get_unsat_core(ctx);
+      BOOST_CHECK(!core.empty());
+      BOOST_CHECK(std::adjacent_find(core.begin(), core.end(), std::greater_equal<unsigned>()) == core.end());
+
+      std::vector<unsigned> failed;
+      for (unsigned i : core) {
+        BOOST_REQUIRE_LT(i, order.size());
+        failed.push_back(order[i]);
+      }
+      // only x < 3 conflicts with the others
+      BOOST_CHECK(std::find(failed.begin(), failed.end(), 0u) != failed.end());
+      BOOST_CHECK(!solve_with(failed));
+    }
+
+    Context ctx;
+    std::vector<result_type> assumptions;
+  };
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(unsat_core)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(subset_of_failed_assumptions, Context, Contexts) {
+  Fixture<Context> f;
+  f.check_core({0, 1, 2, 3, 4});
+  f.check_core({3, 4, 1, 0});
+  f.check_core({2, 0});
+  f.check_core({0, 1, 3, 4});
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(empty_after_sat_and_for_unsat_assertions, Context, Contexts) {
+  Fixture<Context> f;
+  BOOST_REQUIRE(f.solve_with({0, 1, 3}));
+  BOOST_CHECK(get_unsat_core(f.ctx).empty());
+
+  assertion(f.ctx, f.assumptions[0]);
+  assertion(f.ctx, f.assumptions[2]);
+  BOOST_REQUIRE(!f.solve_with({1, 3}));
+  BOOST_CHECK(get_unsat_core(f.ctx).empty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(assumptions_beyond_the_indicator_capacity, Context, Contexts) {
+  Fixture<Context> f;
+  typename Context::result_type const z = f.ctx(logic::QF_BV::new_bitvector(12));
+  // more distinct assumptions than the Z3 backend keeps indicators for
+  for (unsigned i = 0; i < 1500; ++i) {
+    metaSMT::assumption(f.ctx, f.ctx(predtags::equal_tag(), z, f.ctx(bvtags::bvuint_tag(), uint64_t(i), 12u)));
+    BOOST_REQUIRE(solve(f.ctx));
+  }
+  for (unsigned i : {0u, 1u, 1499u}) {
+    metaSMT::assumption(f.ctx, f.ctx(predtags::equal_tag(), z, f.ctx(bvtags::bvuint_tag(), uint64_t(i), 12u)));
+    BOOST_REQUIRE(solve(f.ctx));
+    unsigned const value = read_value(f.ctx, z);
+    BOOST_CHECK_EQUAL(value, i);
+  }
+  f.check_core({0, 1, 2, 3, 4});
+}
+
+BOOST_AUTO_TEST_SUITE_END()